@@ -4,153 +4,239 @@
  *  Created on: Feb 10, 2023
  *      Author: amit
  */
+#define _POSIX_C_SOURCE 200112L /*for pthreads*/
+
+#include <pthread.h>
+
 #include "address.h"
 
-SymbolData *new_sym_dat(int addr, byte type) {
-    SymbolData *sd;
-    sd = malloc(sizeof(SymbolData)); /*allocate memory for new data symbol*/
-    /*set given paramters and initialize list*/
-    sd->addr = addr;
-    sd->type = type;
-    sd->other = new_list();
-    return sd;
+/*checks if an operand token is a register, r0 to r7. labels may start with r too*/
+#define IS_REG_TOKEN(tok) ((tok)[0] == 'r' && (tok)[1] >= '0' && (tok)[1] <= '7' && (tok)[2] == '\0')
+
+void address_symbol(SymbolTable *symbols, const char *name, byte type, int addr) {
+    unsigned int id;/*id of the label*/
+
+    if (type & SYM_EXT) {
+        /*if first token is an extern label, add it to the symbol table or overwrite the label of that name*/
+        id = st_intern(symbols, name, 0, type);
+        symbols->addrs[id] = 0;
+        symbols->types[id] = type;
+        STAT_ADD(STAT_SYMBOLS, 1);
+
+    } else if ((type & SYM_ENT)) {
+        /* if first symbol is an entry label, do the same os before except instead of
+         * ovewritting the existing label of this name, just turn on the
+         * SYM_ENT bit in it's type byte to mark it as entry label*/
+        id = st_intern(symbols, name, -1, type);
+        /*turn on correct bit according to it's type*/
+        symbols->types[id] |= type;
+
+    } else if (type & SYM_DEF) {
+        /*if is a label definition do the same as entry, it's type was discovered in the following tokens*/
+        id = st_intern(symbols, name, addr, type);
+        /*turn on correct bit according to it's type, and set the address in case the label was declared
+         * entry before it was defined*/
+        symbols->types[id] |= type;
+        symbols->addrs[id] = addr;
+        STAT_ADD(STAT_SYMBOLS, 1);
+    }
 }
 
-void free_sym_dat(SymbolData *sd) {
-    if (sd == NULL)/*make sure we got symbol data*/
-        return;
-    free_list(sd->other);/*free others list incase it was used*/
-    free(sd);/*for symbol data*/
+void count_words(byte type, char tokens[MAX_TOKENS_PER_LINE][MAX_TOKEN_LEN], int num_tokens, unsigned int *ic,
+                 unsigned int *dc) {
+    unsigned int curr_tok;/*current token we are processing*/
+
+    /*skip the label name token of a definition*/
+    curr_tok = !(type & (SYM_EXT | SYM_ENT)) && (type & SYM_DEF) ? 1 : 0;
+
+    if (type & SYM_STR) {
+        /*if the next token is a string data token increase the DC by the length of the token since in this
+         * assembly language we use ASCII and assign each character 1 word(not byte) in memory*/
+        *dc += strlen(tokens[curr_tok]) + 1;/*add 1 for '\0'*/
+
+    } else if (type & SYM_DAT) {
+        /*if the next token is data token then do the same as string but count the next tokens instead of
+         * the length of the current tokens*/
+        for (; curr_tok < num_tokens; curr_tok++) {
+            (*dc)++;
+        }
+
+    } else if (type & SYM_COD) {
+        /*if the next token is an opcode counter the number of words needed to encode
+         * it including it's operands and the double register operand sharing a word
+         * situation thingy. the opcode is counted on it's own so an opcode starting with r isn't taken for a register*/
+        (*ic)++;
+        for (curr_tok++; curr_tok < num_tokens; curr_tok++) {
+            if (IS_REG_TOKEN(tokens[curr_tok])) {
+                if (curr_tok + 1 < num_tokens && IS_REG_TOKEN(tokens[curr_tok + 1])) {/*to not count the double reg thing twice*/
+                    curr_tok++;
+                }
+            }
+            (*ic)++;
+        }
+    }
 }
 
-void address_labels(HashTable *labels, unsigned int *instruction_counter, unsigned int *data_counter,
-                    const char *in_file_path) {
-    FILE *in_file;/*input file handle*/
+void address_line(SymbolTable *symbols, byte type, char tokens[MAX_TOKENS_PER_LINE][MAX_TOKEN_LEN], int num_tokens,
+                  unsigned int *ic, unsigned int *dc) {
+    if (type & (SYM_EXT | SYM_ENT | SYM_DEF)) {/*data labels are addressed by the DC, the rest by the IC*/
+        address_symbol(symbols, tokens[0], type, type & (SYM_STR | SYM_DAT) ? *dc : *ic);
+    }
+    count_words(type, tokens, num_tokens, ic, dc);
+}
+
+void relocate_data_labels(SymbolTable *symbols, unsigned int ic) {
+    unsigned int i;
+
+    /*go over every symbol and add IC to the address of each data label in order to make sure they get
+     * addressed at the end of the code file to separate code and data. the arrays are read from start to end*/
+    for (i = 0; i < symbols->num_symbols; i++) {
+        if (symbols->types[i] & (SYM_DAT | SYM_STR)) {/*add ic to dc to separate data and instructions*/
+            symbols->addrs[i] += ic;
+        }
+    }
+}
+
+void address_labels(SymbolTable *symbols, unsigned int *instruction_counter, unsigned int *data_counter,
+                    LineStream *lines) {
     char line[LINE_SIZE];/*to hold line read from file*/
 
     byte type;/*to hold type of label*/
     char tokens[MAX_TOKENS_PER_LINE][MAX_TOKEN_LEN];/*to hold tokens the line breaks into*/
-    int num_tokens, i, j;/*counter and iterators*/
+    int num_tokens;
+    unsigned int ic, dc;/*IC, DC*/
 
-    char *label_name;/*to hold name of label*/
-    unsigned int ic, dc, curr_tok;/*IC, DC, current token we are processing*/
+    ls_rewind(lines);/*read the code from the start*/
+    ic = dc = 0;/*zero counters*/
 
-    SymbolData *label_data, *tmp;/*to hold temporary pointers*/
-    Entry *ent;/*iterator to got over labels ht*/
+    while (ls_gets(line, sizeof(line), lines)) {/*iterate over all lines in file*/
+        memset(tokens, 0, sizeof(tokens));/*zero all tokens so as not to get contaminents from previous lines*/
 
-    /*open input file in read mode*/
-    in_file = fopen(in_file_path, "r");
-    if (in_file == NULL) {
-        printf("Error opening in file!\n");
-        return;
+        /*parse the read line into tokens*/
+        parse_line(line, &type, tokens, &num_tokens);
+        address_line(symbols, type, tokens, num_tokens, &ic, &dc);
     }
 
-    ic = dc = 0;/*zero counters*/
+    /*data goes after the code*/
+    relocate_data_labels(symbols, ic);
 
-    while (fgets(line, sizeof(line), in_file)) {/*iterate over all lines in file*/
-        for (i = 0; i < MAX_TOKENS_PER_LINE; i++) {/*zero all tokens so as not to get contaminents from previous lines*/
-            for (j = 0; j < MAX_TOKEN_LEN; j++) {
-                tokens[i][j] = 0;
-            }
-        }
+    /*set IC and DC we found so they dont need to be recalculated in following passes*/
+    *instruction_counter = ic;
+    *data_counter = dc;
+}
 
-        /*parse the read line into tokens*/
+/**
+ * Thread function that parses the lines of a chunk, counting it's words and keeping it's labels
+ *
+ * @param arg the AddressChunk
+ * @return null
+ */
+void *address_chunk(void *arg) {
+    AddressChunk *chunk;
+    LabelEvent *ev;
+    char line[LINE_SIZE];
+    byte type;
+    char tokens[MAX_TOKENS_PER_LINE][MAX_TOKEN_LEN];
+    int num_tokens;
+    unsigned long len;
+
+    chunk = (AddressChunk *) arg;
+    while (ls_gets(line, sizeof(line), &chunk->view)) {
+        memset(tokens, 0, sizeof(tokens));
         parse_line(line, &type, tokens, &num_tokens);
-
-        curr_tok = 0;/*zero current token counter*/
-        if (type & SYM_EXT) {
-            /*if first token is an extern label, create new symbol data object for it
-             * and intsert it into the labels table with it's name as the key*/
-            label_data = new_sym_dat(0, type);
-            label_name = (char *) malloc(strlen(tokens[curr_tok]));
-            strcpy(label_name, tokens[curr_tok]);
-
-            /*free the previous label symbole data incase we ovewritten it*/
-            tmp = (SymbolData *) ht_put(labels, label_name, label_data);
-            free_sym_dat(tmp);
-
-        } else if ((type & SYM_ENT)) {
-            /* if first symbol is an entry label, do the same os before except instead of
-             * ovewritting the existing symbol data for this label name, just turn on the
-             * SYM_ENT bit in it's type byte to mark it as entry label*/
-            label_data = (SymbolData *) ht_get(labels, tokens[curr_tok]);
-            if (label_data == NULL) {
-                label_data = new_sym_dat(-1, type);
-                label_name = (char *) malloc(strlen(tokens[curr_tok]));
-                strcpy(label_name, tokens[curr_tok]);
-
-                /*not supposed to return anything but just incase to make double sure we dont leak memory*/
-                tmp = ht_put(labels, label_name, label_data);
-                free_sym_dat(tmp);
+        if (type & (SYM_EXT | SYM_ENT | SYM_DEF)) {/*the label goes in the table once the chunks before are counted*/
+            if (chunk->num_events == chunk->events_cap) {
+                chunk->events_cap *= 2;
+                chunk->events = mem_realloc(chunk->events, MEM_SYMBOLS, chunk->events_cap * sizeof(LabelEvent));
             }
-            /*turn on correct bit according to it's type*/
-            label_data->type |= type;
-
-        } else if (type & SYM_DEF) {
-            /*if is a label definition do the same as entry but keep a pointer to it's symbol data
-             * because it's type will be dicovered in the following tokens*/
-            label_data = (SymbolData *) ht_get(labels, tokens[curr_tok]);
-            if (label_data == NULL) {
-                label_data = new_sym_dat(ic, type);
-                label_name = (char *) malloc(strlen(tokens[curr_tok]));
-                strcpy(label_name, tokens[curr_tok]);
-
-                /*not supposed to return anything but just incase to make double sure we dont leak memory*/
-                tmp = ht_put(labels, label_name, label_data);
-                free_sym_dat(tmp);
+            len = strlen(tokens[0]) + 1;
+            while (chunk->names_len + len > chunk->names_cap) {
+                chunk->names_cap *= 2;
+                chunk->names = mem_realloc(chunk->names, MEM_SYMBOLS, chunk->names_cap);
             }
-            /*turn on correct bit according to it's type*/
-            label_data->type |= type;
-            /*increase IC*/
-            curr_tok++;
+            ev = &chunk->events[chunk->num_events++];
+            ev->name = chunk->names_len;
+            ev->addr = type & (SYM_STR | SYM_DAT) ? chunk->dc : chunk->ic;
+            ev->type = type;
+            memcpy(chunk->names + chunk->names_len, tokens[0], len);
+            chunk->names_len += len;
         }
+        count_words(type, tokens, num_tokens, &chunk->ic, &chunk->dc);
+    }
+    return NULL;
+}
 
-        if (type & SYM_STR) {
-            /*if the next token is a string data token, set it's type and address accordingly and
-             * increase the DC by the length of the token since in this assembly
-             * language we use ASCII and assign each character 1 word(not byte) in memory*/
-            label_data->addr = dc;
-            dc += strlen(tokens[curr_tok]);/*add 1 for '\0'*/
-
-        } else if (type & SYM_DAT) {
-            /*if the next token is data token then do the same as string but count the next tokens instead of
-             * the length of the current tokens*/
-            label_data->addr = dc;
-            for (; curr_tok < num_tokens; curr_tok++) {
-                dc++;
-            }
+void address_labels_parallel(SymbolTable *symbols, unsigned int *instruction_counter, unsigned int *data_counter,
+                             LineStream *lines, unsigned int jobs, SourceChunk *plan, unsigned int *num_chunks) {
+    pthread_t *threads;
+    AddressChunk *chunks, *chunk;
+    LabelEvent *ev;
+    byte *started;
+    unsigned int i, j, first, last, ic, dc;
 
-        } else if (type & SYM_COD) {
-            /*if the next token is an opcode counter the number of words needed to encode
-             * it including it's operands and the double register operand sharing a word
-             * situation thingy*/
-            for (; curr_tok < num_tokens; curr_tok++) {
-                if (tokens[curr_tok][0] == 'r') {
-                    if (curr_tok + 1 < num_tokens && tokens[curr_tok + 1][0] == 'r') {/*to not count the double reg thing twice*/
-                        curr_tok++;
-                    }
-                }
-                ic++;
-            }
+    if (jobs > lines->num_refs / ADDRESS_MIN_REFS) {
+        jobs = lines->num_refs / ADDRESS_MIN_REFS;
+    }
+    *num_chunks = 0;
+    if (jobs < 2 || lines->spill != NULL) {/*not worth the threads, or the lines can't be read from several places*/
+        address_labels(symbols, instruction_counter, data_counter, lines);
+        return;
+    }
+    threads = malloc(jobs * sizeof(pthread_t));
+    chunks = malloc(jobs * sizeof(AddressChunk));
+    started = malloc(jobs);
+    first = 0;
+    for (i = 0; i < jobs; i++) {
+        chunk = &chunks[i];
+        /*split at the first line that starts after an even share of the references*/
+        last = i + 1 < jobs ? ls_line_start(lines, (unsigned int) ((unsigned long) lines->num_refs * (i + 1) / jobs))
+                            : lines->num_refs;
+        if (last < first) {
+            last = first;
+        }
+        ls_view(lines, first, last, &chunk->view);
+        plan[i].first_ref = first;
+        plan[i].last_ref = last;
+        first = last;
+        chunk->ic = chunk->dc = 0;
+        chunk->num_events = 0;
+        chunk->events_cap = SYMTAB_MIN_SYMBOLS;
+        chunk->events = mem_alloc(MEM_SYMBOLS, chunk->events_cap * sizeof(LabelEvent));
+        chunk->names_len = 0;
+        chunk->names_cap = chunk->events_cap * 8;
+        chunk->names = mem_alloc(MEM_SYMBOLS, chunk->names_cap);
+        /*the last chunk is addressed here, no point in a thread for it*/
+        started[i] = i + 1 < jobs && pthread_create(&threads[i], NULL, address_chunk, chunk) == 0;
+        if (!started[i]) {/*couldn't get a thread, address the chunk here instead*/
+            address_chunk(chunk);
         }
-
     }
-
-    /*go over the entire labels table we just created and add IC to the address of each data label
-     * in the table in oderder to make sure the get addressed at the end of the code file to separate
-     * code and data*/
-    for (i = 0; i < labels->size; i++) {
-        ent = labels->entries[i];
-        while (ent != NULL) {
-            label_data = (SymbolData *) ent->value;
-            if (label_data->type & (SYM_DAT | SYM_STR)) {/*add ic to dc to separate data and instructions*/
-                label_data->addr += ic;
-            }
-            ent = ent->next;
+    ic = dc = 0;
+    for (i = 0; i < jobs; i++) {
+        chunk = &chunks[i];
+        if (started[i]) {
+            pthread_join(threads[i], NULL);
+        }
+        /*the counters of the chunks before are where this one starts, add it's labels in the order they appear*/
+        plan[i].ic = ic;
+        plan[i].dc = dc;
+        for (j = 0; j < chunk->num_events; j++) {
+            ev = &chunk->events[j];
+            address_symbol(symbols, chunk->names + ev->name, ev->type,
+                           ev->addr + (int) ((ev->type & (SYM_STR | SYM_DAT)) ? dc : ic));
         }
+        ic += chunk->ic;
+        dc += chunk->dc;
+        mem_free(chunk->events);
+        mem_free(chunk->names);
     }
+    free(threads);
+    free(chunks);
+    free(started);
+    *num_chunks = jobs;
 
-    /*set IC and DC we found so they dont need to be recalculated in following passes*/
+    /*data goes after the code*/
+    relocate_data_labels(symbols, ic);
     *instruction_counter = ic;
     *data_counter = dc;
 }
@@ -13,46 +13,118 @@
 
 #include "util.h"
 #include "list.h"
-#include "hashtable.h"
+#include "symtab.h"
 #include "parse.h"
+#include "stream.h"
+#include "stats.h"
+
+#define ADDRESS_MIN_REFS 8192 /*lines and macro calls a thread addresses at least, fewer make fewer threads*/
+
+/**
+ * SourceChunk struct
+ *
+ * Holds a range of the expanded source the first pass was split into and where the words of the range start
+ */
+typedef struct {
+    unsigned int first_ref, last_ref; /*the references of the range, last_ref is the one after it*/
+    unsigned int ic, dc; /*the IC and DC at the start of the range, counted from zero*/
+} SourceChunk;
 
 /**
- * Symbol Data struct
+ * LabelEvent struct
  *
- * meant to hold data about a label, likes it's ERA type, name, and so on..
+ * Holds a label a line defines, declares entry or declares external, for adding it to the symbol table later
  */
 typedef struct {
-	int addr; /*the address of the label in the binary encoding*/
-	byte type;/*the type of the label, can be any of the SYM_ macro values defined in util.h including bitfields*/
-	List* other; /*to store various other data that can be associated with the label like amount of references for external labels*/
-} SymbolData;
+    unsigned long name; /*offset of the name in the names of the chunk*/
+    int addr; /*the IC or DC of the line counted from the start of the chunk*/
+    byte type; /*the type of the line as given by parse_line*/
+} LabelEvent;
 
 /**
- * Creates new symbol data object
+ * AddressChunk struct
  *
- * @param addr address of binary encoding of the label
- * @param type the SYM_ type value
- * @return pointer to new symbol data object
+ * Holds a range of the expanded source addressed on it's own, the words it takes and the labels in it in order
  */
-SymbolData* new_sym_dat(int addr, byte type);
+typedef struct {
+    LineStream view; /*reads the range*/
+    unsigned int ic, dc; /*words of code and data in the range*/
+    LabelEvent *events;
+    unsigned int num_events, events_cap;
+    char *names; /*the label names one after the other with their null terminators*/
+    unsigned long names_len, names_cap;
+} AddressChunk;
+
+/**
+ * Adds the label of a line that defines one, declares it entry or declares it external to the symbol table
+ *
+ * @param symbols the symbol table to fill
+ * @param name the name of the label
+ * @param type the type of the line as given by parse_line
+ * @param addr the address of the label if the line defines it, the DC for data and the IC for code
+ */
+void address_symbol(SymbolTable *symbols, const char *name, byte type, int addr);
 
 /**
- * Frees symbol data objects
+ * Advances IC and DC by the number of words a single parsed line takes
  *
- * @param sd pointer to symbol data object to free
+ * @param type the type of the line as given by parse_line
+ * @param tokens the tokens of the line as given by parse_line
+ * @param num_tokens the number of tokens in the tokens parameter
+ * @param ic reference to the IC counter
+ * @param dc reference to the DC counter
  */
-void free_sym_dat(SymbolData* sd);
+void count_words(byte type, char tokens[MAX_TOKENS_PER_LINE][MAX_TOKEN_LEN], int num_tokens, unsigned int *ic,
+                 unsigned int *dc);
+
+/**
+ * Adds the labels a single parsed line defines to the symbol table and advances IC and DC by the number of
+ * words the line takes
+ *
+ * @param symbols the symbol table to fill
+ * @param type the type of the line as given by parse_line
+ * @param tokens the tokens of the line as given by parse_line
+ * @param num_tokens the number of tokens in the tokens parameter
+ * @param ic reference to the IC counter, the address of code labels
+ * @param dc reference to the DC counter, the address of data labels before they are relocated
+ */
+void address_line(SymbolTable *symbols, byte type, char tokens[MAX_TOKENS_PER_LINE][MAX_TOKEN_LEN], int num_tokens, unsigned int *ic, unsigned int *dc);
+
+/**
+ * Moves all data labels to after the code by adding the final IC to their address
+ *
+ * @param symbols the symbol table
+ * @param ic the final IC counter
+ */
+void relocate_data_labels(SymbolTable *symbols, unsigned int ic);
 
 /**
  * Calculates the addresses for each label in the binary encoding of the provided assembly code file
  * based on it's place in the code and it's type (wheather it's data label or code label). Uses DC
  * IC counters to keep data and code separate
  *
- * @param labels a table in which to fill the labels and their data from the assembly code
+ * @param symbols a table in which to fill the labels and their data from the assembly code
  * @param instruction_counter an IC reference to set the instruction count and data count found during the process of label addressing for efficiency in other methods
  * @param data_counter same instruction_counter but for DC
- * @param in_file_path path to assembly code file *!after expanding macros!*
+ * @param lines the assembly code *!after expanding macros!* as a line stream, read from the start
+ */
+void address_labels(SymbolTable *symbols, unsigned int* instruction_counter, unsigned int* data_counter, LineStream *lines);
+
+/**
+ * Calculates the addresses of the labels like address_labels, with the source split into chunks that are parsed
+ * on several threads. every chunk counts it's words and the addresses of it's labels from zero, the chunks are
+ * then given the IC and DC of the chunks before them and their labels are added to the symbol table in order,
+ * so the table ends up exactly as address_labels leaves it
+ *
+ * @param symbols a table in which to fill the labels
+ * @param instruction_counter reference to set the final IC in
+ * @param data_counter reference to set the final DC in
+ * @param lines the assembly code after expanding macros as a line stream
+ * @param jobs the number of threads to use at most, a stream that spills to a file is addressed on this thread
+ * @param chunks an array of jobs chunks to put the ranges the source was split into in, for the second pass
+ * @param num_chunks reference to set the number of chunks in, 0 if the source wasn't split
  */
-void address_labels(HashTable *labels, unsigned int* instruction_counter, unsigned int* data_counter,const char* in_file_path);
+void address_labels_parallel(SymbolTable *symbols, unsigned int *instruction_counter, unsigned int *data_counter,
+                             LineStream *lines, unsigned int jobs, SourceChunk *chunks, unsigned int *num_chunks);
 
 #endif /* ADDRESS_H */
@@ -0,0 +1,114 @@
+/*
+ * arena.c
+ *
+ *  Created on: Oct 19, 2026
+ */
+#include "arena.h"
+
+/**
+ * Counts everything an arena handed out as released
+ *
+ * @param arena the arena
+ */
+void release_arena_counts(Arena *arena) {
+    int i;
+    for (i = 0; i < NUM_MEM_SUBSYSTEMS; i++) {
+        mem_count_release(i, arena->allocs[i], arena->bytes[i]);
+        arena->allocs[i] = arena->bytes[i] = 0;
+    }
+}
+
+/**
+ * Allocates a new empty block
+ *
+ * @param size bytes available in the block
+ * @return pointer to the new block
+ */
+ArenaBlock *new_arena_block(unsigned long size) {
+    ArenaBlock *block;
+    block = mem_alloc(MEM_ARENA, sizeof(ArenaBlock) + size);/*data already holds one ArenaAlign so there is some slack*/
+    block->next = NULL;
+    block->size = size;
+    block->used = 0;
+    return block;
+}
+
+Arena *new_arena(unsigned long block_size) {
+    Arena *arena;
+    arena = mem_alloc(MEM_ARENA, sizeof(Arena));/*allocate memory for the arena*/
+    arena->block_size = block_size;
+    memset(arena->allocs, 0, sizeof(arena->allocs));
+    memset(arena->bytes, 0, sizeof(arena->bytes));
+    arena->first = arena->curr = new_arena_block(block_size);
+    return arena;
+}
+
+void free_arena(Arena *arena) {
+    ArenaBlock *block, *tmp;
+
+    if (arena == NULL)/*make sure we got an arena*/
+        return;
+#ifdef ARENA_DEBUG
+    arena_reset(arena);/*poison first so dangling pointers read garbage even if the memory isn't reused*/
+#endif
+    release_arena_counts(arena);
+    block = arena->first;
+    while (block != NULL) {
+        tmp = block;
+        block = block->next;
+        mem_free(tmp);
+    }
+    mem_free(arena);
+}
+
+void *arena_alloc(Arena *arena, unsigned long size, int sub) {
+    ArenaBlock *block, *tmp;
+    void *p;
+
+    if (arena == NULL) {
+        return mem_alloc(sub, size);
+    }
+    size = (size + ARENA_ALIGN - 1) / ARENA_ALIGN * ARENA_ALIGN;/*keep the next allocation aligned*/
+    if (size == 0) {
+        size = ARENA_ALIGN;
+    }
+
+    block = arena->curr;
+    while (block->used + size > block->size) {/*move on to a block the allocation fits in*/
+        if (block->next == NULL || block->next->size < size) {/*insert a new block if the next kept one is too small*/
+            tmp = new_arena_block(size > arena->block_size ? size : arena->block_size);
+            tmp->next = block->next;
+            block->next = tmp;
+        }
+        block = block->next;
+    }
+    arena->curr = block;
+
+    p = (char *) block->data + block->used;
+    block->used += size;
+    arena->allocs[sub]++;
+    arena->bytes[sub] += size;
+    mem_count_alloc(sub, size);
+    return p;
+}
+
+void arena_free(Arena *arena, void *p) {
+    if (arena == NULL) {/*only malloc'd memory is freed one allocation at a time*/
+        mem_free(p);
+    }
+}
+
+void arena_reset(Arena *arena) {
+    ArenaBlock *block;
+    for (block = arena->first; block != NULL; block = block->next) {/*only up to the current block, the rest are empty*/
+#ifdef ARENA_DEBUG
+        memset(block->data, ARENA_POISON, block->used);
+#endif
+        block->used = 0;
+        if (block == arena->curr) {
+            break;
+        }
+    }
+    arena->curr = arena->first;
+    release_arena_counts(arena);
+}
@@ -0,0 +1,102 @@
+/*
+ * arena.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  bump allocator for memory that lives as long as the assembly of one file. allocating is moving a pointer
+ *  forward and all the memory is released at once by resetting the arena, the blocks are kept for the next file.
+ *  build with ARENA_DEBUG defined to poison released memory so use after reset shows up right away
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mem.h"
+
+#define ARENA_BLOCK_SIZE 65536 /*default size of the blocks an arena allocates from*/
+#define ARENA_POISON 0xA5 /*byte released memory is filled with in debug builds*/
+
+/**
+ * ArenaAlign union
+ *
+ * Used to align allocations to the strictest alignment of the basic types
+ */
+typedef union {
+    long l;
+    double d;
+    void *p;
+} ArenaAlign;
+
+#define ARENA_ALIGN sizeof(ArenaAlign)
+
+/**
+ * ArenaBlock struct
+ *
+ * Used to store one chunk of memory the arena hands out allocations from
+ */
+typedef struct ArenaBlock {
+    struct ArenaBlock *next; /*next block in the arena*/
+    unsigned long size; /*bytes available in data*/
+    unsigned long used; /*bytes handed out from data*/
+    ArenaAlign data[1]; /*start of the memory, the block is allocated with size bytes here*/
+} ArenaBlock;
+
+/**
+ * Arena struct
+ *
+ * Used to store the blocks of the arena and the block allocations are currently made from
+ */
+typedef struct {
+    ArenaBlock *first; /*first block, the arena always has at least one*/
+    ArenaBlock *curr; /*block allocations are made from, blocks after it are empty*/
+    unsigned long block_size; /*size of new blocks, bigger allocations get a block of their own size*/
+    unsigned long allocs[NUM_MEM_SUBSYSTEMS]; /*allocations handed out since the last reset, by subsystem*/
+    unsigned long bytes[NUM_MEM_SUBSYSTEMS]; /*bytes handed out since the last reset, by subsystem*/
+} Arena;
+
+/**
+ * Creates new empty arena
+ *
+ * @param block_size the size of the blocks to allocate from
+ * @return pointer to new arena
+ */
+Arena *new_arena(unsigned long block_size);
+
+/**
+ * Frees an arena and all the memory allocated from it
+ *
+ * @param arena the arena to free
+ */
+void free_arena(Arena *arena);
+
+/**
+ * Allocates memory from an arena. the memory is aligned for any type
+ *
+ * @param arena the arena to allocate from, if null the memory is allocated with mem_alloc
+ * @param size number of bytes to allocate
+ * @param sub the MEM_ value of the subsystem allocating
+ * @return pointer to the allocated memory
+ */
+void *arena_alloc(Arena *arena, unsigned long size, int sub);
+
+/**
+ * Frees memory given by arena_alloc. memory allocated from an arena is only released by resetting the
+ * arena so this only frees memory that was allocated with a null arena
+ *
+ * @param arena the arena the memory was allocated from
+ * @param p pointer to the memory
+ */
+void arena_free(Arena *arena, void *p);
+
+/**
+ * Releases all the memory allocated from an arena, keeping the blocks to allocate from again
+ *
+ * @param arena the arena to reset
+ */
+void arena_reset(Arena *arena);
+
+#endif /* ARENA_H */
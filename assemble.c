@@ -4,33 +4,27 @@
  *  Created on: Mar 2, 2023
  *      Author: amit
  */
+#define _POSIX_C_SOURCE 200112L /*for pthreads*/
+
+#include <pthread.h>
+
 #include "assemble.h"
 
-void int_to_bin(long num, int bits, char *bin) {
-    int k, i, neg;/*flag and iterators*/
-    k = 0;/*start counting bits from 0*/
-    neg = num < 0;/*set flag to 1 if num is negative*/
-    if (neg) { /*make sure we work on positive numbers in this step*/
-        num *= -1;
-    }
-    while (num > 0 &&
-           k < bits) {/*keep diving by 2 and adding the remainder to encod integer into bits until integer reaches 0*/
-        bin[k] = num % 2;/*place bits into provided bin array*/
-        num /= 2;
-        k++;/*count bits*/
-    }
-    if (neg) {/*if number was originally negative, preform two's complement convertion on the allotted bits*/
-        for (i = 0; i < bits; i++) {
-            bin[i] = !bin[i];/*flip bits*/
-        }
-        /*add 1*/
-        bin[0] += 1;
-        for (i = 0; i < bits - 1 && bin[i] > 1; i++) {
-            bin[i] = 0;
-            bin[i + 1] += 1;
-        }
-    }
-}
+/**
+ * EncodeJob struct
+ *
+ * Holds a chunk of the source one thread encodes and the range of the image it's words go in
+ */
+typedef struct {
+    LineStream view; /*reads the chunk*/
+    SymbolTable symbols; /*a view of the symbol table with the extern uses of the chunk*/
+    EncodeCache *cache; /*a cache of the thread, or the shared one for the chunk encoded by the caller*/
+    word *image; /*the code followed by the data of the whole file*/
+    unsigned long code_pos, code_end; /*where the code of the chunk starts and ends in the image*/
+    unsigned long data_pos, data_end; /*the same for the data*/
+    byte ok; /*cleared if an instruction couldn't be encoded or the chunk took other words than counted*/
+    byte quiet; /*set to leave the errors of the chunk unprinted, the file is encoded again on one thread then*/
+} EncodeJob;
 
 int get_addr_type(char *operand) {/*operand is token from parse function*/
     if (operand[0] == 'i') return 0; /*immediate tokens start with i*/
@@ -39,58 +33,19 @@ int get_addr_type(char *operand) {/*operand is token from parse function*/
     return -1; /*default*/
 }
 
-/**
- * Zero the array
- *
- * @param word
- */
-void clear_word(char word[ASM_WORD_SIZE]) {
-    int i;
-    for (i = 0; i < ASM_WORD_SIZE; i++) {/*self-explanatory*/
-        word[i] = 0;
-    }
-}
-
-/**
- * Converts array of 1 and 0 bytes into their character representation and writes
- * those characters to file stream
- *
- * @param word an array of signed bytes that are 1 or 0 in their values
- * @param obj_file a file to write their character representation into
- */
-void print_word(char word[ASM_WORD_SIZE], FILE *obj_file) {
-    int i;
-    for (i = ASM_WORD_SIZE - 1; i >= 0; i--) {
-        fputc(word[i] ? ONE_CHAR : ZERO_CHAR, obj_file);
-    }
-}
-
-/**
- * Shortcut for using print_word
- *
- * @param n integer to convert into bits character representation
- * @param obj_file fiel to write characters into
- */
-void print_int_as_word(long n, FILE *obj_file) {
-    char data_word[ASM_WORD_SIZE];
-    clear_word(data_word); /*zero word bytes*/
-    int_to_bin(n, ASM_WORD_SIZE, data_word);/*fill with integer binary rep bits*/
-    print_word(data_word, obj_file);/*send bits to file*/
-}
-
-void instruction_to_bin(long ic, HashTable *labels, char *opcode, char *operands[3], int num_operands,
-                        char bin[4][ASM_WORD_SIZE], int *num_words) {
-    int bin_opcode, bin_operands[3], k, offset, word_offset; /*0 - opcode, 1 - num args, bin_opcode - opcode number, offset - offset in the operand array
- * word_offset - offset in the bin matrix*/
+int encode_instruction(int opcode, char *operands[3], int num_operands, Encoding *enc, byte quiet) {
+    int bin_operands[3], k, offset, word_offset; /*offset - offset in the operand array, word_offset - offset in the bin array*/
     /*tmp shorthand for readability*/
     char *operand;
-    SymbolData *label_data;
-    byte operands_type[3]; /*save important type info*/
+    word *bin;
+    const OpcodeDesc *desc;/*what the opcode accepts and it's first word template*/
 
-    bin_opcode = get_opcode(opcode);
+    desc = &isa[opcode];
+    bin = enc->bin;
+    bin[0] = bin[1] = bin[2] = bin[3] = 0;
+    enc->num_words = enc->num_relocs = 0;
 
-    for (k = 0;
-         k < num_operands; k++) { /*convert operands to integer form so we can send them to int_to_bin for encoding*/
+    for (k = 0; k < num_operands; k++) { /*convert operands to integer form so we can shift them into their fields*/
         operand = operands[k];/*for ease of use and readability*/
         /*handle each operand type accordingly*/
         if (operand[0] == 'r') {
@@ -100,254 +55,741 @@ void instruction_to_bin(long ic, HashTable *labels, char *opcode, char *operands
             bin_operands[k] = str_to_int(trim(operand + 1));
 
         } else if (operand[0] == 'l') {
-            label_data = (SymbolData *) ht_get(labels, trim(operand + 1));/*get label data*/
-
-            if (label_data == NULL) {
-                printf("error: no such label \"%s\"\n", operand + 1);
-                return;
-            }
-
-            if (label_data->type &
-                SYM_EXT) { /*if we found a external label reference in the code, write the address of it down*/
-                l_push(label_data->other, (void *) ic);
-            }
-
-            bin_operands[k] = label_data->addr +
-                              BASE_ADDRESS;/*set label address to be it's original address plus the address offset defined in the assignment*/
-            operands_type[k] = label_data->type;
+            bin_operands[k] = 0;/*label address is a hole, it is patched in by apply_relocs*/
 
         } else {
-            printf("error: unrecognized operand type \"%c\"\n", *operand);
-            return;
+            if (!quiet) printf("error: unrecognized operand type \"%c\"\n", *operand);
+            return 0;
         }
     }
 
-    *num_words = 1; /*send number of words to 1 initiazly because that is the minimum*/
-    int_to_bin(bin_opcode, 4, bin[0] + 6); /*convert opcode into bits*/
+    enc->num_words = 1; /*send number of words to 1 initiazly because that is the minimum*/
+    bin[0] = desc->first_word;/*opcode and any fixed addressing mode bits come from the descriptor table*/
 
     offset = 0;/*assume no offset needed*/
-    word_offset = 1;/*always have at least 1 offset in the bin matrix because of the opcode word*/
+    word_offset = 1;/*always have at least 1 offset in the bin array because of the opcode word*/
 
     if (num_operands == 3) { /*if 3 params then first one is always jump label*/
-        int_to_bin(2, 2, bin[0] + 2);/*ERA bits of jump label in opcode word*/
-        int_to_bin(2, 2, bin[1]);/*ERA bits of jump label word*/
-        int_to_bin(bin_operands[0], ASM_WORD_SIZE - 2, bin[1] + 2);/*bits of label address in label word*/
+        bin[1] |= FIELD(2, ERA_BITS, ERA_SHIFT);/*ERA bits of jump label word*/
+        bin[1] |= FIELD(bin_operands[0], VALUE_BITS, VALUE_SHIFT);/*label address in label word*/
         offset = 1;/*set operand offset to 1 because first operand is jump label*/
         word_offset = 2;/*set word offset to 2 because now we have 2 words occupied, 1 for the opcode and 1 for the jump label*/
-        /*update the number of words we are using and set the addressing mode of both jump paramters in the param bits of the opcode word*/
-        int_to_bin(get_addr_type(operands[offset + 1]), 2, bin[0] + ASM_WORD_SIZE - 4);
-        int_to_bin(get_addr_type(operands[offset]), 2, bin[0] + ASM_WORD_SIZE - 2);
-        *num_words = 4;
+        /*update the number of words we are using and set the addressing mode of the jump and of both jump paramters in the opcode word*/
+        bin[0] |= FIELD(MODE_JMP, MODE_BITS, DST_MODE_SHIFT);
+        bin[0] |= FIELD(get_addr_type(operands[offset + 1]), MODE_BITS, PARAM2_MODE_SHIFT);
+        bin[0] |= FIELD(get_addr_type(operands[offset]), MODE_BITS, PARAM1_MODE_SHIFT);
+        enc->num_words = 4;
     }
 
     if (num_operands > 1) {
 
         /*instruction byte operand addressing bits*/
-        if (num_operands ==
-            2) {/*if we have exactly 2 operands then is not jump instruction and encode operands normally*/
-            int_to_bin(get_addr_type(operands[0]), 2, bin[0] + 4);
-            int_to_bin(get_addr_type(operands[1]), 2, bin[0] + 2);
-            *num_words = 3;
+        if (desc->optype == OPTYPE_BIN) {/*if is not jump instruction then encode operands addressing modes normally*/
+            bin[0] |= FIELD(get_addr_type(operands[0]), MODE_BITS, SRC_MODE_SHIFT);
+            bin[0] |= FIELD(get_addr_type(operands[1]), MODE_BITS, DST_MODE_SHIFT);
+            enc->num_words = 3;
         }
 
         /*check for the 2 register operands situation and all the other addressing modes combos and encode
          * each word accordingly*/
         if (operands[offset][0] == 'r' && operands[offset + 1][0] == 'r') {/*for example: r2,r3*/
-            int_to_bin(bin_operands[offset + 1], 5, bin[word_offset] + 2);
-            int_to_bin(bin_operands[offset], 5, bin[word_offset] + 8);
-            *num_words -= 1;/*we need one less word then we assumed so reduce word count*/
+            bin[word_offset] |= FIELD(bin_operands[offset + 1], REG_BITS, DST_REG_SHIFT);
+            bin[word_offset] |= FIELD(bin_operands[offset], REG_BITS, SRC_REG_SHIFT);
+            enc->num_words -= 1;/*we need one less word then we assumed so reduce word count*/
 
         } else if (operands[offset][0] == 'r' && operands[offset + 1][0] != 'r') {/*for example: r3,LOOP or r3,#4*/
-            int_to_bin(bin_operands[offset], 5, bin[word_offset] + 8);
-            int_to_bin(bin_operands[offset + 1], ASM_WORD_SIZE - 2, bin[word_offset + 1] + 2);
+            bin[word_offset] |= FIELD(bin_operands[offset], REG_BITS, SRC_REG_SHIFT);
+            bin[word_offset + 1] |= FIELD(bin_operands[offset + 1], VALUE_BITS, VALUE_SHIFT);
 
         } else if (operands[offset][0] != 'r' && operands[offset + 1][0] == 'r') {/*for example: LOOP,r3 or #4,r3*/
-            int_to_bin(bin_operands[offset], ASM_WORD_SIZE - 2, bin[word_offset] + 2);
-            int_to_bin(bin_operands[offset + 1], 5, bin[word_offset + 1] + 2);
+            bin[word_offset] |= FIELD(bin_operands[offset], VALUE_BITS, VALUE_SHIFT);
+            bin[word_offset + 1] |= FIELD(bin_operands[offset + 1], REG_BITS, DST_REG_SHIFT);
 
         } else {/*for example: LOOP,#4 or LOOP,MAIN, or #4,MAIN or #4,#5*/
-            int_to_bin(bin_operands[offset], ASM_WORD_SIZE - 2, bin[word_offset] + 2);
-            int_to_bin(bin_operands[offset + 1], ASM_WORD_SIZE - 2, bin[word_offset + 1] + 2);
+            bin[word_offset] |= FIELD(bin_operands[offset], VALUE_BITS, VALUE_SHIFT);
+            bin[word_offset + 1] |= FIELD(bin_operands[offset + 1], VALUE_BITS, VALUE_SHIFT);
         }
 
         if (operands[offset][0] == 'l') {/*ERA bits for labels*/
-            int_to_bin(2, 2, bin[word_offset]);
+            bin[word_offset] |= FIELD(2, ERA_BITS, ERA_SHIFT);
         }
         if (operands[offset + 1][0] == 'l') {/*ERA bits for labels*/
-            int_to_bin(2, 2, bin[word_offset + 1]);
+            bin[word_offset + 1] |= FIELD(2, ERA_BITS, ERA_SHIFT);
         }
 
     } else if (num_operands == 1) {
-        *num_words = 2; /*only need two word for opcodes with 1 operand*/
+        enc->num_words = 2; /*only need two word for opcodes with 1 operand*/
+        bin[0] |= FIELD(get_addr_type(operands[0]), MODE_BITS, DST_MODE_SHIFT);
         if (operands[0][0] == 'l') {/*ERA bits for labels*/
-            int_to_bin(2, 2, bin[1]);
+            bin[1] |= FIELD(2, ERA_BITS, ERA_SHIFT);
         }
-        int_to_bin(bin_operands[0], ASM_WORD_SIZE - 2, bin[1] + 2);
+        bin[1] |= FIELD(bin_operands[0], VALUE_BITS, VALUE_SHIFT);
+    }
 
-        if (bin_opcode !=
-            12) { /*only prn instruction can accept all addressing modes, otherwise we have addressing mode 2*/
-            /*maybe put get_addr_type(operands[0]) instead of 2*/
-            int_to_bin(2, 2, bin[0] + 2);
+    /*mark the holes of the label operands, a label always has a word of it's own*/
+    for (k = 0; k < num_operands; k++) {
+        if (operands[k][0] == 'l') {
+            enc->relocs[enc->num_relocs].operand = k;
+            enc->relocs[enc->num_relocs].value_word = k < offset || num_operands == 1 ? 1 : word_offset + k - offset;
+            enc->num_relocs++;
         }
     }
+    return 1;
+}
 
-    /*set ERA bits of external and entry words*/
-    for (k = 0; k < num_operands; k++) {
-        if (operands_type[k] & SYM_EXT) {
-            int_to_bin(1, 2, bin[word_offset + k]);
-        } else if (operands_type[k] & SYM_ENT) {
-            int_to_bin(2, 2, bin[word_offset + k]);
+int apply_relocs(long ic, SymbolTable *symbols, char *operands[3], const Encoding *enc, word bin[4], byte quiet) {
+    int k, id;
+    const Reloc *reloc;
+
+    for (k = 0; k < enc->num_relocs; k++) {
+        reloc = &enc->relocs[k];
+        id = st_find(symbols, trim(operands[reloc->operand] + 1));/*get label id*/
+
+        if (id == SYMTAB_NO_SYMBOL) {
+            if (!quiet) printf("error: no such label \"%s\"\n", operands[reloc->operand] + 1);
+            return 0;
+        }
+
+        if (symbols->types[id] & SYM_EXT) {
+            /*if we found a external label reference in the code, write down the address of the word that uses it.
+             * the address is only known when linking so the word is just marked external*/
+            st_add_use(symbols, id, ic + reloc->value_word);
+            bin[reloc->value_word] = FIELD(1, ERA_BITS, ERA_SHIFT);
+        } else {
+            /*set label address to be it's original address plus the address offset defined in the assignment,
+             * the word is already marked relocatable*/
+            bin[reloc->value_word] |= FIELD(symbols->addrs[id] + BASE_ADDRESS, VALUE_BITS, VALUE_SHIFT);
         }
     }
+    return 1;
 }
 
-void assemble_code(HashTable *labels, int ic, int dc, const char *in_file_path, const char *obj_file_path,
-                   const char *ent_file_path, const char *ext_file_path) {
-    FILE *in_file, *obj_file, *ent_file, *ext_file; /*file handles*/
-    /*iterators and tmp storage*/
-    char *operands[3], *opcode, line[LINE_SIZE], tokens[MAX_TOKENS_PER_LINE][MAX_TOKEN_LEN], bin_instructions[4][ASM_WORD_SIZE];
-    int num_operands, num_words, num_tokens, i;
-    long curr_ic, j;
-    byte type;
-    SymbolData *label_data;
-    List *data;
-    Node *curr;
-    Entry *ent;
-    /*open input file in read mode*/
-    in_file = fopen(in_file_path, "r");
-    if (in_file == NULL) {
-        printf("Error opening in file!\n");
+void instruction_to_bin(long ic, SymbolTable *symbols, EncodeCache *cache, char *opcode, char *operands[3],
+                        int num_operands, word bin[4], int *num_words, byte quiet) {
+    int bin_opcode, keyed;
+    char key[CACHE_KEY_SIZE];
+    Encoding enc, *cached;
+
+    *num_words = 0;/*in case we return on error*/
+    bin_opcode = get_opcode(opcode);
+    if (bin_opcode == -1) {
+        if (!quiet) printf("error: unrecognized opcode \"%s\"\n", opcode);
         return;
     }
-    /*open .obj file in append mode*/
-    obj_file = open_file_append(obj_file_path);
-    ent_file = ext_file = NULL;/*assume no entry and extern labels therefore no need to open files*/
-    data = new_list(); /*"data image"*/
-    curr_ic = BASE_ADDRESS;/*IC for current pass*/
 
-    /*print ic dc at title of obj file*/
-    fprintf(obj_file, "%d %d\n", ic, dc);
+    /*look for an encoding of the same instruction, only the label holes differ between copies*/
+    cached = NULL;
+    keyed = cache != NULL && make_cache_key(bin_opcode, operands, num_operands, key);
+    if (keyed) {
+        cached = cache_get(cache, key);
+    }
+    if (cached == NULL) {
+        if (!encode_instruction(bin_opcode, operands, num_operands, &enc, quiet)) {
+            return;
+        }
+        if (keyed) {
+            cache_put(cache, key, &enc);
+        }
+        cached = &enc;
+    }
+
+    memcpy(bin, cached->bin, sizeof(cached->bin));
+    if (!apply_relocs(ic, symbols, operands, cached, bin, quiet)) {/*patch in the label addresses*/
+        return;
+    }
+    *num_words = cached->num_words;
+}
+
+/**
+ * Writes one line of the object file, the address column and the word column
+ *
+ * @param addr the address of the word
+ * @param w the word
+ * @param obj_file the object file
+ */
+void print_obj_line(long addr, word w, FILE *obj_file) {
+    print_int_as_word(addr, obj_file);/*address column*/
+    fputc(' ', obj_file);/*separate columns with space*/
+    print_word(w, obj_file);/*encoding column*/
+    fputc('\n', obj_file);
+    STAT_ADD(STAT_WORDS, 1);
+}
 
-    while (fgets(line, sizeof(line), in_file)) {/*iterate over all lines in input file*/
-        for (i = 0; i < 4; i++) { /*zero tokens tmp storage so as no to get contamination from prev lines*/
-            for (j = 0; j < MAX_TOKEN_LEN; j++) {
-                tokens[i][j] = 0;
+/**
+ * Adds a word to the data image
+ *
+ * @param data the data image
+ * @param spill a file to write the word to instead of the data image, null to push it to the data image
+ * @param image an array to put the word in instead, at index *pos which is advanced. null to use data or spill
+ * @param pos reference to the index of the next word in image
+ * @param value the word
+ */
+void push_data_word(List *data, FILE *spill, word *image, unsigned long *pos, long value) {
+    word w;
+    if (image != NULL) {
+        image[(*pos)++] = FIELD(value, ASM_WORD_SIZE, 0);
+    } else if (spill != NULL) {/*written in order, so the file reads back first word first*/
+        w = FIELD(value, ASM_WORD_SIZE, 0);
+        fwrite(&w, sizeof(word), 1, spill);
+    } else {
+        l_push(data, (void *) value);
+    }
+}
+
+/**
+ * Pushes the words of a .string or .data line to the data image, does nothing for other lines
+ *
+ * @param data the data image
+ * @param spill a file to write the words to instead of the data image, null to push them to the data image
+ * @param image an array to put the words in instead, at index *pos which is advanced. null to use data or spill
+ * @param pos reference to the index of the next word in image
+ * @param type the type of the line as given by parse_line
+ * @param tokens the tokens of the line as given by parse_line
+ * @param num_tokens the number of tokens in the tokens parameter
+ */
+void image_data(List *data, FILE *spill, word *image, unsigned long *pos, byte type, char tokens[MAX_TOKENS_PER_LINE][MAX_TOKEN_LEN], int num_tokens) {
+    int i, first;
+    long j;
+
+    first = type & SYM_DEF ? 1 : 0;/*skip the label name token if there is one*/
+    if (type & SYM_STR) {/*handle .string data definitions*/
+        for (i = 0; i < strlen(tokens[first]); i++) {
+            j = tokens[first][i];
+            /* push a word to the data image for every character in the token.
+             * we convert integer to (void*) since pointers are by default the size of a word on the machine
+             * and integers are not more than on word on the machine therefore any integer should fit in the
+             * space needed for an address, therefore in this case the list node data pointer is not uses as
+             * a pointer at all but rather as a word sized integer*/
+            push_data_word(data, spill, image, pos, j);
+        }
+        push_data_word(data, spill, image, pos, 0);
+
+    } else if (type & SYM_DAT) {/*handle .data data definitions*/
+        for (i = first; i < num_tokens; i++) {
+            j = str_to_int(tokens[i]);
+            /* push a word to the data image for every number in the data array
+            * same as we did in .string*/
+            push_data_word(data, spill, image, pos, j);
+        }
+    }
+}
+
+/**
+ * Points to the opcode and operand tokens of an instruction line
+ *
+ * @param type the type of the line as given by parse_line
+ * @param tokens the tokens of the line as given by parse_line
+ * @param num_tokens the number of tokens in the tokens parameter
+ * @param opcode a reference to put the opcode token in
+ * @param operands an array to put the 3 operand tokens in, unused ones are empty strings
+ * @return the number of operands
+ */
+int split_instruction(byte type, char tokens[MAX_TOKENS_PER_LINE][MAX_TOKEN_LEN], int num_tokens, char **opcode,
+                      char *operands[3]) {
+    int first;
+    first = type & SYM_DEF ? 1 : 0;/*skip 1 if is label definition since those are handled in addressing step*/
+    *opcode = tokens[first];
+    operands[0] = tokens[first + 1];
+    operands[1] = tokens[first + 2];
+    operands[2] = tokens[first + 3];
+    return num_tokens - first - 1;
+}
+
+/**
+ * Writes the data image after the code in the object file and frees it
+ *
+ * @param data the data image, words are pushed like a stack so the first one is at the tail
+ * @param spill the file the data image was written to instead, null if it's in the data parameter
+ * @param curr_ic the address of the first data word
+ * @param obj_file the object file
+ */
+void print_data_image(List *data, FILE *spill, long curr_ic, FILE *obj_file) {
+    Node *curr;
+    word w;
+
+    if (spill != NULL) {
+        fseek(spill, 0, SEEK_SET);
+        while (fread(&w, sizeof(word), 1, spill) == 1) {
+            print_obj_line(curr_ic++, w, obj_file);
+        }
+    }
+    curr = data->tail;
+    while (curr != NULL) {
+        /*get data number from list using the addresss-integer trick we did when pushing*/
+        print_obj_line(curr_ic++, FIELD((long) curr->data, ASM_WORD_SIZE, 0), obj_file);
+        curr = curr->prev;/*keep iterating*/
+    }
+    free_list(data);/*clean up list, since data pointers are used as integers and dont point anywhere, it's sufficient to just free the list data*/
+}
+
+/**
+ * Writes the .ent and .ext files from the symbol table, each file is created only if it has lines to write
+ *
+ * @param symbols the symbol table after assembly, with the extern uses recorded
+ * @param ent_file_path the path to write the .ent file to
+ * @param ext_file_path the path to write the .ext file to
+ */
+void print_symbol_files(SymbolTable *symbols, const char *ent_file_path, const char *ext_file_path) {
+    FILE *ent_file, *ext_file;
+    unsigned int i;
+
+    ent_file = ext_file = NULL;/*assume no entry and extern labels therefore no need to open files*/
+
+    /*we simply collect all the labels marked as entry and write them with
+     * thier address to the .ent file, in the order they first appeared*/
+    for (i = 0; i < symbols->num_symbols; i++) {
+        if (symbols->types[i] & SYM_ENT) {/*write entries*/
+            if (ent_file == NULL) {/*create file only if we have entry labels*/
+                ent_file = open_file_append(ent_file_path);
             }
+            fprintf(ent_file, "%s ", st_name(symbols, i));
+            print_int_as_word(symbols->addrs[i] + BASE_ADDRESS, ent_file);
+            fputc('\n', ent_file);
         }
+    }
+    /*and the uses of extern labels in the .ext file, in the order they were recorded*/
+    for (i = 0; i < symbols->num_uses; i++) {
+        if (ext_file == NULL) { /*create file only if we have extern labels*/
+            ext_file = open_file_append(ext_file_path);
+        }
+        fprintf(ext_file, "%s ", st_name(symbols, symbols->use_syms[i]));
+        print_int_as_word(symbols->use_addrs[i], ext_file);
+        fputc('\n', ext_file);
+    }
 
-        parse_line(line, &type, tokens, &num_tokens);/*convert line to tokens*/
+    /*close the files if we used them*/
+    if (ent_file) {
+        STAT_ADD(STAT_BYTES, ftell(ent_file));
+        fclose(ent_file);
+    }
+    if (ext_file) {
+        STAT_ADD(STAT_BYTES, ftell(ext_file));
+        fclose(ext_file);
+    }
+}
+
+OutputBuffers *new_output_buffers() {
+    OutputBuffers *out;
+    out = mem_alloc(MEM_ASSEMBLE, sizeof(OutputBuffers));
+    out->obj_buf = mem_alloc(MEM_ASSEMBLE, OBJ_BUF_SIZE);
+    out->jobs = 1;
+    out->chunks = mem_alloc(MEM_ASSEMBLE, sizeof(SourceChunk));
+    out->num_chunks = 0;
+    out->code_cap = out->fixups_cap = 64;
+    out->code = mem_alloc(MEM_ASSEMBLE, out->code_cap * sizeof(word));
+    out->fixups = mem_alloc(MEM_ASSEMBLE, out->fixups_cap * sizeof(Fixup));
+    return out;
+}
+
+void free_output_buffers(OutputBuffers *out) {
+    if (out == NULL) {
+        return;
+    }
+    mem_free(out->obj_buf);
+    mem_free(out->chunks);
+    mem_free(out->code);
+    mem_free(out->fixups);
+    mem_free(out);
+}
+
+void set_output_jobs(OutputBuffers *out, unsigned int jobs) {
+    out->jobs = jobs > 0 ? jobs : 1;
+    out->chunks = mem_realloc(out->chunks, MEM_ASSEMBLE, out->jobs * sizeof(SourceChunk));
+    out->num_chunks = 0;
+}
+
+/**
+ * Opens the .obj file to write through the output buffer
+ *
+ * @param path the path of the .obj file
+ * @param out the output buffers
+ * @return the file handle, null if it couldn't be opened
+ */
+FILE *open_obj_file(const char *path, OutputBuffers *out) {
+    FILE *obj_file;
+    obj_file = open_file_append(path);
+    if (obj_file != NULL) {/*one big buffer instead of the default, it's only written when it fills up*/
+        setvbuf(obj_file, out->obj_buf, _IOFBF, OBJ_BUF_SIZE);
+    }
+    return obj_file;
+}
+
+/**
+ * Adds a word to the code image of the output buffers, growing it if it's full
+ *
+ * @param out the output buffers
+ * @param len reference to the number of words in the image
+ * @param w the word
+ */
+void push_image_word(OutputBuffers *out, unsigned long *len, word w) {
+    if (*len == out->code_cap) {
+        out->code_cap *= 2;
+        out->code = mem_realloc(out->code, MEM_ASSEMBLE, out->code_cap * sizeof(word));
+    }
+    out->code[(*len)++] = w;
+}
+
+/**
+ * Writes the .obj file from several threads, the code image of the output buffers followed by the data image
+ *
+ * @param out the output buffers with the code image
+ * @param code_len the number of words in the code image
+ * @param data the data image, words are pushed like a stack so the first one is at the tail. it's freed
+ * @param ic the IC counter for the header
+ * @param dc the DC counter for the header
+ * @param obj_file_path the path to write the .obj file to
+ */
+void emit_images(OutputBuffers *out, unsigned long code_len, List *data, int ic, int dc, const char *obj_file_path) {
+    Node *curr;
+    unsigned long len;
+    long bytes;
 
-        if (type & SYM_STR) {/*handle .string data definitions*/
-            for (i = 0; i < strlen(tokens[1]); i++) {
-                j = tokens[1][i];
-                /* push a word to the data image for every character in the token.
-                 * we convert integer to (void*) since pointers are by default the size of a word on the machine
-                 * and integers are not more than on word on the machine therefore any integer should fit in the
-                 * space needed for an address, therefore in this case the list node data pointer is not uses as
-                 * a pointer at all but rather as a word sized integer*/
-                l_push(data, (void *) j);
+    len = code_len;
+    for (curr = data->tail; curr != NULL; curr = curr->prev) {/*the data goes right after the code*/
+        push_image_word(out, &len, FIELD((long) curr->data, ASM_WORD_SIZE, 0));
+    }
+    free_list(data);
+    bytes = emit_object(obj_file_path, ic, dc, out->code, len, out->jobs);
+    STAT_ADD(STAT_WORDS, len);
+    if (bytes > 0) {
+        STAT_ADD(STAT_BYTES, bytes);
+    }
+}
+
+/**
+ * Thread function that encodes the lines of a chunk into it's ranges of the image
+ *
+ * @param arg the EncodeJob
+ * @return null
+ */
+void *encode_chunk(void *arg) {
+    EncodeJob *job;
+    char *operands[3], *opcode, line[LINE_SIZE], tokens[MAX_TOKENS_PER_LINE][MAX_TOKEN_LEN];
+    word bin_instructions[4];
+    int num_operands, num_words, num_tokens;
+    unsigned int line_ic, line_dc;/*the words the first pass counted for the line*/
+    byte type;
+    double start;
+
+    job = (EncodeJob *) arg;
+    start = trace_now();
+    job->ok = 1;
+    while (job->ok && ls_gets(line, sizeof(line), &job->view)) {
+        memset(tokens, 0, sizeof(tokens));
+        parse_line(line, &type, tokens, &num_tokens);
+
+        if (type & (SYM_STR | SYM_DAT)) {
+            line_ic = line_dc = 0;
+            count_words(type, tokens, num_tokens, &line_ic, &line_dc);
+            if (job->data_pos + line_dc > job->data_end) {/*more data than the chunk has room for*/
+                job->ok = 0;
+            } else {
+                image_data(NULL, NULL, job->image, &job->data_pos, type, tokens, num_tokens);
             }
-            l_push(data, 0);
-
-        } else if (type & SYM_DAT) {/*handle .data data definitions*/
-            for (i = 1; i < num_tokens; i++) {
-                j = str_to_int(tokens[i]);
-                /* push a word to the data image for every number in the data array
-                * same as we did in .string*/
-                l_push(data, (void *) j);
+
+        } else if (type & SYM_COD) {
+            num_operands = split_instruction(type, tokens, num_tokens, &opcode, operands);
+            instruction_to_bin(BASE_ADDRESS + job->code_pos, &job->symbols, job->cache, opcode, operands, num_operands,
+                               bin_instructions, &num_words, job->quiet);
+            if (num_words == 0 || job->code_pos + num_words > job->code_end) {/*the words after it would move*/
+                job->ok = 0;
+            } else {
+                memcpy(job->image + job->code_pos, bin_instructions, num_words * sizeof(word));
+                job->code_pos += num_words;
             }
+        }
+    }
+    if (job->code_pos != job->code_end || job->data_pos != job->data_end) {
+        job->ok = 0;
+    }
+    trace_span("encode", NULL, start);
+    return NULL;
+}
+
+/**
+ * Encodes the chunks the first pass split the source into on threads, every chunk into it's place in the code
+ * image of the output buffers followed by the data image. the extern uses of the chunks are added to the symbol
+ * table in address order
+ *
+ * @param symbols the symbol table generated in addressing step
+ * @param cache the cache of encodings of this thread, may be null
+ * @param out the output buffers with the chunks
+ * @param ic the IC counter from the addressing step
+ * @param dc the DC counter from the addressing step
+ * @param lines the source code as a line stream
+ * @return 1 if the image was filled, 0 if a chunk had an error and the file has to be encoded on one thread
+ */
+int encode_parallel(SymbolTable *symbols, EncodeCache *cache, OutputBuffers *out, int ic, int dc,
+                    LineStream *lines) {
+    pthread_t *threads;
+    EncodeJob *jobs, *job;
+    SourceChunk *chunk;
+    byte *started, ok;
+    unsigned int i, n;
+
+    n = out->num_chunks;
+    if (out->code_cap < (unsigned long) (ic + dc)) {
+        out->code_cap = ic + dc;
+        out->code = mem_realloc(out->code, MEM_ASSEMBLE, out->code_cap * sizeof(word));
+    }
+    threads = malloc(n * sizeof(pthread_t));
+    jobs = malloc(n * sizeof(EncodeJob));
+    started = malloc(n);
+    for (i = 0; i < n; i++) {
+        job = &jobs[i];
+        chunk = &out->chunks[i];
+        ls_view(lines, chunk->first_ref, chunk->last_ref, &job->view);
+        st_view(symbols, &job->symbols);
+        job->image = out->code;
+        /*the chunk after this one starts where this one ends*/
+        job->code_pos = chunk->ic;
+        job->code_end = i + 1 < n ? out->chunks[i + 1].ic : (unsigned long) ic;
+        job->data_pos = ic + chunk->dc;
+        job->data_end = ic + (i + 1 < n ? out->chunks[i + 1].dc : (unsigned long) dc);
+        job->quiet = 1;/*the errors are printed in order when the file is encoded again on this thread*/
+        /*the last chunk is encoded here with the shared cache, no point in a thread for it*/
+        job->cache = i + 1 < n && cache != NULL ? new_encode_cache(CACHE_MAX_ENTRIES) : cache;
+        started[i] = i + 1 < n && pthread_create(&threads[i], NULL, encode_chunk, job) == 0;
+        if (!started[i]) {/*couldn't get a thread, encode the chunk here instead*/
+            encode_chunk(job);
+        }
+    }
+    ok = 1;
+    for (i = 0; i < n; i++) {
+        job = &jobs[i];
+        if (started[i]) {
+            pthread_join(threads[i], NULL);
+        }
+        if (!job->ok) {
+            ok = 0;
+        }
+        if (job->cache != cache) {/*count the lookups of the thread's cache with the shared one*/
+            cache->hits += job->cache->hits;
+            cache->misses += job->cache->misses;
+            free_encode_cache(job->cache);
+        }
+    }
+    for (i = 0; i < n; i++) {/*the chunks are in address order, so are their uses*/
+        st_merge_uses(ok ? symbols : NULL, &jobs[i].symbols);
+    }
+    free(threads);
+    free(jobs);
+    free(started);
+    return ok;
+}
+
+void assemble_code(SymbolTable *symbols, EncodeCache *cache, Arena *arena, OutputBuffers *out, int ic, int dc, LineStream *lines, FILE *data_spill,
+                   const char *obj_file_path, const char *ent_file_path, const char *ext_file_path, byte *is_valid) {
+    FILE *obj_file; /*file handle*/
+    /*iterators and tmp storage*/
+    char *operands[3], *opcode, line[LINE_SIZE], tokens[MAX_TOKENS_PER_LINE][MAX_TOKEN_LEN];
+    word bin_instructions[4];
+    int num_operands, num_words, num_tokens, i;
+    long curr_ic;
+    unsigned long code_len;
+    byte type, encoded;
+    List *data;
+    OutputBuffers *own;/*buffers allocated for this file only*/
+    double start;
+    start = trace_now();
+    own = NULL;
+    if (out == NULL) {
+        out = own = new_output_buffers();
+    }
+    ls_rewind(lines);/*read the code from the start*/
+    obj_file = NULL;
+    if (out->jobs <= 1 || data_spill != NULL) {/*written as we go, otherwise the image is kept and written at the end*/
+        /*open .obj file in append mode*/
+        obj_file = open_obj_file(obj_file_path, out);
+        /*print ic dc at title of obj file*/
+        fprintf(obj_file, "%d %d\n", ic, dc);
+    }
+    data = new_list(arena); /*"data image"*/
+    curr_ic = BASE_ADDRESS;/*IC for current pass*/
+    code_len = 0;
+    encoded = 0;
+    if (obj_file == NULL && out->num_chunks > 1) {/*encode the chunks of the first pass on threads*/
+        encoded = encode_parallel(symbols, cache, out, ic, dc, lines);
+        if (encoded) {/*the image holds the code and the data, the data list stays empty*/
+            code_len = ic + dc;
+        }
+    }
+
+    while (!encoded && ls_gets(line, sizeof(line), lines)) {/*iterate over all lines in input code*/
+        memset(tokens, 0, sizeof(tokens));/*zero tokens tmp storage so as no to get contamination from prev lines*/
+
+        parse_line(line, &type, tokens, &num_tokens);/*convert line to tokens*/
+
+        if (type & (SYM_STR | SYM_DAT)) {/*handle data definitions*/
+            image_data(data, data_spill, NULL, NULL, type, tokens, num_tokens);
 
         } else if (type & SYM_COD) { /*handle instruction lines*/
-            for (i = 0; i < 4; i++) { /*zero bin matrix tmp storage so as no to get contamination from prev lines*/
-                for (j = 0; j < ASM_WORD_SIZE; j++) {
-                    bin_instructions[i][j] = 0;
-                }
+            num_operands = split_instruction(type, tokens, num_tokens, &opcode, operands);
+            /*convert opcode and operands we found to binary into the bin array*/
+            instruction_to_bin(curr_ic, symbols, cache, opcode, operands, num_operands, bin_instructions, &num_words,
+                               0);
+            if (num_words == 0) {/*the words after it would be off, keep going only to report the other errors*/
+                *is_valid = 0;
             }
 
-            if (type & SYM_DEF) {/*set opcode and operands to skip 1 if is label definition since those are handled in addressing step*/
-                opcode = tokens[1];
-                operands[0] = tokens[2];
-                operands[1] = tokens[3];
-                operands[2] = tokens[4];
-                num_operands = num_tokens - 2;
-            } else { /*otherwise set them in order we expect*/
-                opcode = tokens[0];
-                operands[0] = tokens[1];
-                operands[1] = tokens[2];
-                operands[2] = tokens[3];
-                num_operands = num_tokens - 1;
-            }
-            /*convert opcode and operands we found to binary into the bin matrix*/
-            instruction_to_bin(curr_ic, labels, opcode, operands, num_operands, bin_instructions, &num_words);
-
-            for (i = 0; i < num_words; i++) {/*append print the bin matrix we just got to the obj file*/
-                /*print addresss of word*/
-                /*fprintf(obj_file, "%04d ",curr_ic++);*/
-                print_int_as_word(curr_ic++, obj_file);/*instruction address column*/
-                fputc(' ', obj_file);/*separate columns with space*/
-                /*print content of word*/
-                print_word(bin_instructions[i], obj_file);/*instruction encoding column*/
-                fputc('\n', obj_file);
+            for (i = 0; i < num_words; i++) {/*append print the bin array we just got to the obj file*/
+                if (obj_file != NULL) {
+                    print_obj_line(curr_ic, bin_instructions[i], obj_file);
+                } else {
+                    push_image_word(out, &code_len, bin_instructions[i]);
+                }
+                curr_ic++;
             }
         }
     }
-    /*close input file after we finished reading lines*/
-    fclose(in_file);
+    trace_span("encode", NULL, start);
+    start = trace_now();
+    if (!*is_valid) {/*no files for a file with errors, the .obj file written so far goes away*/
+        if (obj_file != NULL) {
+            fclose(obj_file);
+            remove(obj_file_path);
+        }
+    } else if (obj_file != NULL) {
+        /*after we finished writing all the instructions to the object file
+         * it's time to write all the data to the object file*/
+        print_data_image(data, data_spill, curr_ic, obj_file);
+        STAT_ADD(STAT_BYTES, ftell(obj_file));
+        fclose(obj_file);/*close .obj file*/
+    } else {
+        emit_images(out, code_len, data, ic, dc, obj_file_path);
+    }
+    free_output_buffers(own);
 
-    /*after we finished writing all the instructions to the object file
-     * it's time to write all the data to the object file*/
+    if (*is_valid) {
+        print_symbol_files(symbols, ent_file_path, ext_file_path);
+    }
+    trace_span("flush", NULL, start);
+}
 
-    curr = data->tail;
-    while (curr != NULL) {
-        j = (long) curr->data; /*get data number from list using the addresss-integer trick we did previously*/
-        /*fprintf(obj_file, "%04d ",curr_ic++);*/
-        print_int_as_word(curr_ic++, obj_file); /*print address column*/
-        fputc(' ', obj_file);
-        print_int_as_word(j, obj_file); /*print data encoding column*/
-        fputc('\n', obj_file);
-        curr = curr->prev;/*keep iterating*/
+void assemble_one_pass(SymbolTable *symbols, EncodeCache *cache, Arena *arena, OutputBuffers *out, LineStream *lines, const char *obj_file_path,
+                       const char *ent_file_path, const char *ext_file_path, byte *is_valid) {
+    FILE *obj_file; /*file handle*/
+    /*iterators and tmp storage*/
+    char *operands[3], *opcode, line[LINE_SIZE], tokens[MAX_TOKENS_PER_LINE][MAX_TOKEN_LEN], key[CACHE_KEY_SIZE];
+    int num_operands, num_tokens, op, keyed, k;
+    unsigned int ic, dc;
+    unsigned long code_len, code_cap, num_fixups, fixups_cap, i;
+    byte type;
+    List *data;
+    word *code;/*code image, the code is only written after all the labels are known*/
+    Fixup *fixups, *fixup;/*instructions waiting for their label addresses*/
+    Encoding enc, *cached;
+    OutputBuffers *own;/*buffers allocated for this file only*/
+    double start;
+
+    start = trace_now();
+    own = NULL;
+    if (out == NULL) {
+        out = own = new_output_buffers();
     }
+    ls_rewind(lines);/*read the code from the start*/
+    data = new_list(arena); /*"data image"*/
+    /*start from the images the previous files grew*/
+    code_cap = out->code_cap;
+    code = out->code;
+    fixups_cap = out->fixups_cap;
+    fixups = out->fixups;
+    code_len = num_fixups = 0;
+    ic = dc = 0;
+
+    while (ls_gets(line, sizeof(line), lines)) {/*iterate over all lines in input code, only once*/
+        memset(tokens, 0, sizeof(tokens));/*zero tokens tmp storage so as no to get contamination from prev lines*/
 
-    free_list(data);/*clean up list, since data pointers are used as integers and dont point anywhere, it's sufficient to just free the list data*/
-    fclose(obj_file);/*close .obj file*/
-
-    /*next we simply collect all the labels marked as entry and write them with
-     * thier address to the .ent file and the labels marked extern in the .ext file*/
-
-    for (i = 0; i < labels->size; i++) {
-        ent = labels->entries[i];
-        while (ent != NULL) {
-            label_data = (SymbolData *) ent->value;
-            if (label_data->type & SYM_ENT) {/*write entries*/
-                if (ent_file == NULL) {/*create file only if we have entry labels*/
-                    ent_file = open_file_append(ent_file_path);
+        parse_line(line, &type, tokens, &num_tokens);/*convert line to tokens*/
+        address_line(symbols, type, tokens, num_tokens, &ic, &dc);/*define the line's labels as the first pass does*/
+
+        if (type & (SYM_STR | SYM_DAT)) {/*handle data definitions*/
+            image_data(data, NULL, NULL, NULL, type, tokens, num_tokens);
+
+        } else if (type & SYM_COD) { /*handle instruction lines*/
+            num_operands = split_instruction(type, tokens, num_tokens, &opcode, operands);
+            op = get_opcode(opcode);
+            if (op == -1) {
+                printf("error: unrecognized opcode \"%s\"\n", opcode);
+                *is_valid = 0;
+                continue;
+            }
+            /*encode right away, the label holes are left for later*/
+            cached = NULL;
+            keyed = cache != NULL && make_cache_key(op, operands, num_operands, key);
+            if (keyed) {
+                cached = cache_get(cache, key);
+            }
+            if (cached == NULL) {
+                if (!encode_instruction(op, operands, num_operands, &enc, 0)) {
+                    *is_valid = 0;
+                    continue;
+                }
+                if (keyed) {
+                    cache_put(cache, key, &enc);
                 }
-                fprintf(ent_file, "%s ", ent->key);
-                print_int_as_word(label_data->addr, ent_file);
-                fputc('\n', ent_file);
+                cached = &enc;
+            }
 
+            if (code_len + 4 > code_cap) {/*grow the code image*/
+                code_cap *= 2;
+                code = mem_realloc(code, MEM_ASSEMBLE, code_cap * sizeof(word));
             }
-            if (label_data->type & SYM_EXT) {
-                curr = label_data->other->head;
-                while (curr != NULL) {/*write extern uses*/
-                    if (ext_file == NULL) { /*create file only if we have extern labels*/
-                        ext_file = open_file_append(ext_file_path);
-                    }
-                    fprintf(ext_file, "%s ", ent->key);
-                    print_int_as_word((long) curr->data, ext_file);
-                    fputc('\n', ext_file);
-                    curr = curr->next;
+            if (cached->num_relocs > 0) {/*remember where the holes are along with the label names*/
+                if (num_fixups == fixups_cap) {
+                    fixups_cap *= 2;
+                    fixups = mem_realloc(fixups, MEM_ASSEMBLE, fixups_cap * sizeof(Fixup));
+                }
+                fixup = &fixups[num_fixups++];
+                fixup->pos = code_len;
+                memcpy(&fixup->enc, cached, sizeof(Encoding));
+                for (k = 0; k < num_operands; k++) {
+                    strcpy(fixup->operands[k], operands[k]);
                 }
             }
-            ent = ent->next;
+            memcpy(code + code_len, cached->bin, cached->num_words * sizeof(word));
+            code_len += cached->num_words;
         }
     }
 
-    /*close the files if we used them*/
-    if (ent_file) {
-        fclose(ent_file);
+    /*all symbols are defined now, data goes after the code and the holes can be patched*/
+    relocate_data_labels(symbols, ic);
+    for (i = 0; i < num_fixups; i++) {/*every missing label is reported, like the second pass does*/
+        fixup = &fixups[i];
+        for (k = 0; k < 3; k++) {
+            operands[k] = fixup->operands[k];
+        }
+        if (!apply_relocs(BASE_ADDRESS + fixup->pos, symbols, operands, &fixup->enc, code + fixup->pos, 0)) {
+            *is_valid = 0;
+        }
     }
-    if (ext_file) {
-        fclose(ext_file);
+
+    trace_span("encode", NULL, start);
+    start = trace_now();
+
+    /*keep the images for the next file*/
+    out->code = code;
+    out->code_cap = code_cap;
+    out->fixups = fixups;
+    out->fixups_cap = fixups_cap;
+
+    /*write the code image and the data image after it, no files for a file with errors*/
+    if (*is_valid && out->jobs <= 1) {
+        obj_file = open_obj_file(obj_file_path, out);
+        fprintf(obj_file, "%d %d\n", ic, dc);/*print ic dc at title of obj file*/
+        for (i = 0; i < code_len; i++) {
+            print_obj_line(BASE_ADDRESS + i, code[i], obj_file);
+        }
+        print_data_image(data, NULL, BASE_ADDRESS + code_len, obj_file);
+        STAT_ADD(STAT_BYTES, ftell(obj_file));
+        fclose(obj_file);
+    } else if (*is_valid) {/*the image is written from several threads*/
+        emit_images(out, code_len, data, ic, dc, obj_file_path);
+    }
+
+    if (*is_valid) {
+        print_symbol_files(symbols, ent_file_path, ext_file_path);
     }
+    trace_span("flush", NULL, start);
+    free_output_buffers(own);
 }
@@ -13,23 +13,18 @@
 
 #include "util.h"
 #include "hashtable.h"
+#include "symtab.h"
 #include "list.h"
 #include "parse.h"
 #include "address.h"
-
-/**
- * Converts a long integer to bit characters and puts n of those bits in the
- * first n indexes of the provided character array. does a 2's complement
- * binary conversion on the bits if the number is negative *!based on n!*
- * meaning it will overwrite n bits of the character array.
- * 0 and 1 bit characters in the bits string are represented by the characters
- * set in macros ZERO_CHAR and ONE_CHAR respectively
- *
- * @param num the number to convert to binary
- * @param bits the n bits to write
- * @param bin the array of characters to write the bits into
- */
-void int_to_bin(long num, int bits, char* bin);
+#include "isa.h"
+#include "cache.h"
+#include "stream.h"
+#include "object.h"
+#include "emit.h"
+#include "stats.h"
+#include "mem.h"
+#include "trace.h"
 
 /**
  * Get the addressing mode of an operand in it's string representation (e.g from the source code)
@@ -39,32 +34,139 @@ void int_to_bin(long num, int bits, char* bin);
  */
 int get_addr_type(char* operand);
 
+/**
+ * Fixup struct
+ *
+ * An instruction of the single pass assembly that is waiting for it's label addresses
+ */
+typedef struct {
+    unsigned long pos; /*index of the instruction's first word in the code image*/
+    Encoding enc; /*the relocation records of the instruction*/
+    char operands[3][MAX_TOKEN_LEN]; /*copies of the operand tokens the relocation records refer to*/
+} Fixup;
+
+#define OBJ_BUF_SIZE 65536 /*size of the stdio buffer the .ob file is written through*/
+
+/**
+ * OutputBuffers struct
+ *
+ * Holds the buffers the assembly of a file writes it's output through, kept from one file to the next so
+ * they only grow while the first files are assembled
+ */
+typedef struct {
+    char *obj_buf; /*stdio buffer of the .ob file, OBJ_BUF_SIZE bytes*/
+    unsigned int jobs; /*threads that write the .ob file, 1 to write it through obj_buf as it's encoded*/
+    SourceChunk *chunks; /*the ranges the first pass split the source into, room for jobs of them*/
+    unsigned int num_chunks; /*0 when the first pass wasn't split, the second pass is then done on one thread*/
+    word *code; /*code image of the single pass assembly, and of the two pass one when it's written by threads*/
+    unsigned long code_cap;
+    Fixup *fixups; /*instructions of the single pass assembly waiting for their label addresses*/
+    unsigned long fixups_cap;
+} OutputBuffers;
+
+/**
+ * Creates the output buffers
+ *
+ * @return the new buffers
+ */
+OutputBuffers *new_output_buffers();
+
+/**
+ * Frees the output buffers
+ *
+ * @param out the buffers to free
+ */
+void free_output_buffers(OutputBuffers *out);
+
+/**
+ * Sets the number of threads the assembly of a file may use
+ *
+ * @param out the output buffers
+ * @param jobs the number of threads, at least 1
+ */
+void set_output_jobs(OutputBuffers *out, unsigned int jobs);
+
+/**
+ * Encodes an instruction from it's string representation without looking at any label, label operands are
+ * left as holes described by the relocation records of the encoding
+ *
+ * @param opcode the opcode integer rep
+ * @param operands the string representation of the operands
+ * @param num_operands the number of operands in the operands parameter
+ * @param enc the encoding to fill
+ * @param quiet 1 to leave the error unprinted, 0 to print it
+ * @return 1 on success, 0 if an operand couldn't be encoded
+ */
+int encode_instruction(int opcode, char *operands[3], int num_operands, Encoding *enc, byte quiet);
+
+/**
+ * Patches the label holes of an encoding with the label addresses, and records the uses of external labels.
+ * the word of an external label gets ERA bits 01 and address 0, the linker fills in the address
+ *
+ * @param ic the IC of the instruction's first word
+ * @param symbols the symbol table generated in addressing step
+ * @param operands the string representation of the operands the encoding was made from
+ * @param enc the encoding with the relocation records
+ * @param bin a copy of the encoding words to patch
+ * @param quiet 1 to leave the error unprinted, 0 to print it
+ * @return 1 on success, 0 if a label wasn't found
+ */
+int apply_relocs(long ic, SymbolTable *symbols, char *operands[3], const Encoding *enc, word bin[4], byte quiet);
+
 /**
  * Converts an instruction from it's string representation into it's final binary encoding
  *
  * @param ic the IC counter from the current pass
- * @param labels the labels hashtable generated in addressing step
+ * @param symbols the symbol table generated in addressing step
+ * @param cache a cache of encodings to reuse, may be null
  * @param opcode the string representation of the opcode
  * @param operands the string representation of the operands
  * @param num_operands the number of operands in the operands parameter
- * @param bin a clear (set to 0) matrix of 4xASM_WORD_SIZE characters where the final representation of the instruction will be put
- * @param num_words the number of words in the bin matrix the instruction uses in it's final binary encoding
+ * @param bin an array of 4 words where the final representation of the instruction will be put
+ * @param num_words the number of words in the bin array the instruction uses in it's final binary encoding, 0 on error
+ * @param quiet 1 to leave the errors unprinted, for a thread whose chunk is encoded again if it fails. 0 to print them
  */
-void instruction_to_bin(long ic, HashTable *labels, char *opcode, char *operands[3], int num_operands, char bin[4][ASM_WORD_SIZE], int *num_words);
+void instruction_to_bin(long ic, SymbolTable *symbols, EncodeCache *cache, char *opcode, char *operands[3], int num_operands, word bin[4], int *num_words, byte quiet);
 
 /**
- * Generates the and .obj, .ent, and .ext files based on a provided *!macro expanded!* .am source code file
+ * Generates the and .obj, .ent, and .ext files based on the provided *!macro expanded!* source code
  * as specified in the assignment description. files will be written the their respective file paths
- * and will overwrite the file at that path currently.
+ * and will overwrite the file at that path currently. when the first pass split the source between threads
+ * the chunks are encoded on threads too, each into it's place in the image of the .obj file. an instruction that
+ * can't be encoded, like one using a label that isn't defined, is an error of the whole file and no file is written
  *
- * @param labels the labels hashtable generated in addressing step
+ * @param symbols the symbol table generated in addressing step
+ * @param cache a cache of encodings to reuse, may be null
+ * @param arena the arena to allocate the data image from, null to use malloc
+ * @param out buffers to write the output through, null to allocate them for this file only
  * @param ic the IC counter from the addressing step
  * @param dc the DC counter from the addressing step
- * @param in_file_path the path to the source code .am file
+ * @param lines the source code as a line stream, read from the start
+ * @param data_spill an empty temporary file to write the data image to until it's appended after the code,
+ * null to keep the data image in memory
+ * @param obj_file_path the path to write the .obj file to
+ * @param ent_file_path the path to write the .ent file to
+ * @param ext_file_path the path to write the .ext file to
+ * @param is_valid a byte reference to put the is_valid flag in, cleared if an instruction couldn't be encoded
+ */
+void assemble_code(SymbolTable *symbols, EncodeCache *cache, Arena *arena, OutputBuffers *out, int ic, int dc, LineStream *lines, FILE *data_spill, const char* obj_file_path, const char* ent_file_path, const char* ext_file_path, byte *is_valid);
+
+/**
+ * Generates the .obj, .ent, and .ext files like address_labels followed by assemble_code do, but reads the
+ * *!macro expanded!* source code only once. each instruction is encoded as soon as it is read and
+ * the label addresses are patched in once all the labels are defined, then the files are written. like
+ * assemble_code no file is written if an instruction couldn't be encoded
+ *
+ * @param symbols an empty symbol table to fill
+ * @param cache a cache of encodings to reuse, may be null
+ * @param arena the arena to allocate the data image from, null to use malloc
+ * @param out buffers to write the output through, null to allocate them for this file only
+ * @param lines the source code as a line stream, read from the start
  * @param obj_file_path the path to write the .obj file to
  * @param ent_file_path the path to write the .ent file to
  * @param ext_file_path the path to write the .ext file to
+ * @param is_valid a byte reference to put the is_valid flag in, cleared if an instruction couldn't be encoded
  */
-void assemble_code(HashTable *labels, int ic, int dc, const char* in_file_path, const char* obj_file_path, const char* ent_file_path, const char* ext_file_path);
+void assemble_one_pass(SymbolTable *symbols, EncodeCache *cache, Arena *arena, OutputBuffers *out, LineStream *lines, const char* obj_file_path, const char* ent_file_path, const char* ext_file_path, byte *is_valid);
 
 #endif /* ASSEMBLE_H_ */
@@ -0,0 +1,118 @@
+/*
+ * bench.c
+ *
+ *  Created on: Oct 19, 2026
+ */
+#define _DEFAULT_SOURCE /*wait4 isn't posix*/
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#include "bench.h"
+
+int count_input(const char *path, unsigned long *lines, unsigned long *bytes) {
+    FILE *file;
+    char buf[BUFSIZ];
+    size_t n, i;
+
+    *lines = *bytes = 0;
+    file = fopen(path, "rb");
+    if (file == NULL) {
+        fprintf(stderr, "Error opening source file %s\n", path);
+        return 0;
+    }
+    while ((n = fread(buf, 1, sizeof(buf), file)) > 0) {
+        *bytes += n;
+        for (i = 0; i < n; i++) {
+            if (buf[i] == '\n') {
+                (*lines)++;
+            }
+        }
+    }
+    fclose(file);
+    return 1;
+}
+
+int run_measured(char *const argv[], const char *out_path, double *secs, long *max_rss_kb) {
+    struct timeval start, end;
+    struct rusage usage;
+    pid_t pid;
+    int status, out_fd;
+
+    gettimeofday(&start, NULL);
+    pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        return -1;
+    }
+    if (pid == 0) {/*the child sends the output where it's asked to and becomes the program*/
+        out_fd = open(out_path != NULL ? out_path : "/dev/null", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (out_fd >= 0) {
+            dup2(out_fd, STDOUT_FILENO);
+            close(out_fd);
+        }
+        execv(argv[0], argv);
+        perror(argv[0]);
+        _exit(127);
+    }
+    if (wait4(pid, &status, 0, &usage) < 0) {/*the usage of this child alone, not of all children so far*/
+        perror("wait4");
+        return -1;
+    }
+    gettimeofday(&end, NULL);
+    *secs = (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) / 1e6;
+    *max_rss_kb = usage.ru_maxrss;
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+int bench_input(const char *assembler, char **options, int num_options, const char *name, int repeat, BenchResult *res) {
+    char *argv[BENCH_MAX_ARGS + 3];
+    char as_file_path[MAX_FILE_PATH];
+    double secs;
+    long rss;
+    int i;
+
+    res->secs = 0;
+    res->max_rss_kb = 0;
+    res->status = -1;
+    sprintf(as_file_path, "%s.as", name);
+    if (!count_input(as_file_path, &res->lines, &res->bytes)) {
+        return 0;
+    }
+    argv[0] = (char *) assembler;
+    for (i = 0; i < num_options; i++) {
+        argv[i + 1] = options[i];
+    }
+    argv[num_options + 1] = (char *) name;
+    argv[num_options + 2] = NULL;
+
+    for (i = 0; i < repeat; i++) {
+        res->status = run_measured(argv, NULL, &secs, &rss);
+        if (res->status != 0) {
+            return 0;
+        }
+        if (i == 0 || secs < res->secs) {/*the fastest run has the least noise*/
+            res->secs = secs;
+            res->max_rss_kb = rss;
+        }
+    }
+    return 1;
+}
+
+void print_bench_header(FILE *out) {
+    fprintf(out, "%-20s %10s %10s %10s %12s %8s %10s\n", "input", "lines", "MB", "secs", "lines/s", "MB/s", "peak KB");
+}
+
+void print_bench_result(FILE *out, const char *name, const BenchResult *res) {
+    double mb;
+    mb = res->bytes / 1e6;
+    if (res->status != 0) {
+        fprintf(out, "%-20s %10lu %10.2f failed with status %d\n", name, res->lines, mb, res->status);
+        return;
+    }
+    fprintf(out, "%-20s %10lu %10.2f %10.3f %12.0f %8.2f %10ld\n", name, res->lines, mb, res->secs,
+            res->secs > 0 ? res->lines / res->secs : 0, res->secs > 0 ? mb / res->secs : 0, res->max_rss_kb);
+}
@@ -0,0 +1,84 @@
+/*
+ * bench.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  end to end measurement of the assembler. every input is assembled by a child process so the peak memory
+ *  of each run can be read from it's own resource usage
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "util.h"
+
+#define BENCH_MAX_ARGS 32 /*most options passed on to the assembler*/
+
+/**
+ * BenchResult struct
+ *
+ * Holds the measurements of assembling one input
+ */
+typedef struct {
+    unsigned long lines; /*lines in the .as file*/
+    unsigned long bytes; /*size of the .as file*/
+    double secs; /*wall time of the fastest run*/
+    long max_rss_kb; /*peak resident memory of the fastest run in kilobytes*/
+    int status; /*exit status of the assembler, -1 if it couldn't be run*/
+} BenchResult;
+
+/**
+ * Counts the lines and bytes of a file
+ *
+ * @param path path to the file
+ * @param lines a reference to put the number of lines in
+ * @param bytes a reference to put the number of bytes in
+ * @return 1 on success, 0 if the file couldn't be opened
+ */
+int count_input(const char *path, unsigned long *lines, unsigned long *bytes);
+
+/**
+ * Runs a program in a child process and measures it
+ *
+ * @param argv the program and it's arguments, ending with null
+ * @param out_path path of a file to write the program's output to, null to throw it away
+ * @param secs a reference to put the wall time in
+ * @param max_rss_kb a reference to put the peak resident memory in
+ * @return the exit status of the program, -1 if it couldn't be run or was killed
+ */
+int run_measured(char *const argv[], const char *out_path, double *secs, long *max_rss_kb);
+
+/**
+ * Assembles an input a number of times and keeps the fastest run
+ *
+ * @param assembler path to the assembler
+ * @param options options to pass to the assembler before the input
+ * @param num_options the number of options in the options parameter
+ * @param name the input name, without extension like the assembler takes it
+ * @param repeat the number of runs
+ * @param res the result to fill
+ * @return 1 if every run succeeded, 0 otherwise
+ */
+int bench_input(const char *assembler, char **options, int num_options, const char *name, int repeat, BenchResult *res);
+
+/**
+ * Writes the header of the results table
+ *
+ * @param out the file to write to
+ */
+void print_bench_header(FILE *out);
+
+/**
+ * Writes the results of an input as a table row
+ *
+ * @param out the file to write to
+ * @param name the input name
+ * @param res the results
+ */
+void print_bench_result(FILE *out, const char *name, const BenchResult *res);
+
+#endif /* BENCH_H */
@@ -0,0 +1,61 @@
+/*
+ ============================================================================
+ Name        : benchmark.c
+ Version     : 0.0.1
+ Description : assembles inputs and reports lines/s, MB/s and peak memory for each
+ ============================================================================
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+
+int main(int argc, char *argv[]) {/*main function*/
+    BenchResult res;
+    char *options[BENCH_MAX_ARGS];
+    const char *assembler;
+    int i, repeat, num_options, inputs, failed;
+
+    assembler = "./assembler";
+    repeat = 1;
+    num_options = 0;
+    for (i = 1; i < argc; i++) {/*look for options first so they apply to every input no matter where they are*/
+        if (argv[i][0] != '-') {
+            continue;
+        }
+        if (strncmp(argv[i], "--assembler=", 12) == 0) {
+            assembler = argv[i] + 12;
+        } else if (strncmp(argv[i], "--repeat=", 9) == 0) {
+            repeat = atoi(argv[i] + 9);
+        } else if (strncmp(argv[i], "--with=", 7) == 0 && num_options < BENCH_MAX_ARGS) {/*an assembler option*/
+            options[num_options++] = argv[i] + 7;
+        } else {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if (repeat < 1) {
+        repeat = 1;
+    }
+
+    print_bench_header(stdout);
+    inputs = failed = 0;
+    for (i = 1; i < argc; i++) {/*every other argument is an input, without extension like the assembler takes it*/
+        if (argv[i][0] == '-') {
+            continue;
+        }
+        if (!bench_input(assembler, options, num_options, argv[i], repeat, &res)) {
+            failed = 1;
+        }
+        print_bench_result(stdout, argv[i], &res);
+        fflush(stdout);
+        inputs++;
+    }
+    if (inputs == 0) {
+        fprintf(stderr, "usage: %s [--assembler=path] [--repeat=n] [--with=option]... input...\n", argv[0]);
+        return 1;
+    }
+    return failed;
+}
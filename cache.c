@@ -0,0 +1,87 @@
+/*
+ * cache.c
+ *
+ *  Created on: Oct 19, 2026
+ */
+#include "cache.h"
+
+EncodeCache *new_encode_cache(unsigned int max_entries) {
+    EncodeCache *cache;
+    cache = mem_alloc(MEM_CACHE, sizeof(EncodeCache));/*allocate memory for the cache*/
+    cache->table = new_hashtable(CACHE_TABLE_SIZE, NULL);/*kept across files so not in the per-file arena*/
+    cache->max_entries = max_entries;
+    cache->entries = 0;
+    cache->hits = cache->misses = 0;
+    return cache;
+}
+
+void free_encode_cache(EncodeCache *cache) {
+    unsigned int i;
+    Entry *ent;
+
+    if (cache == NULL)/*make sure we got a cache*/
+        return;
+    /*the hashtable doesn't free it's values so free the encodings first*/
+    for (i = 0; i < cache->table->size; i++) {
+        ent = cache->table->entries[i];
+        while (ent != NULL) {
+            mem_free(ent->value);
+            ent = ent->next;
+        }
+    }
+    free_hashtable(cache->table);
+    mem_free(cache);
+}
+
+int make_cache_key(int opcode, char *operands[3], int num_operands, char *key) {
+    int i, k;
+    unsigned long len;
+
+    k = 0;
+    key[k++] = 'a' + opcode;/*one character is enough for 16 opcodes*/
+    for (i = 0; i < num_operands; i++) {
+        key[k++] = ',';
+        if (operands[i][0] == 'l') {/*labels are holes, so every label encodes the same*/
+            key[k++] = 'l';
+        } else {/*immediates and registers are part of the encoding so they are part of the key*/
+            len = strlen(operands[i]);
+            if (k + len + 2 > CACHE_KEY_SIZE) {/*leave room for another separator and the terminator*/
+                return 0;
+            }
+            memcpy(key + k, operands[i], len);
+            k += len;
+        }
+    }
+    key[k] = '\0';
+    return 1;
+}
+
+Encoding *cache_get(EncodeCache *cache, char *key) {
+    Encoding *enc;
+    enc = (Encoding *) ht_get(cache->table, key);
+    if (enc != NULL) {/*count so we can tell if the cache pays off*/
+        cache->hits++;
+    } else {
+        cache->misses++;
+    }
+    return enc;
+}
+
+void cache_put(EncodeCache *cache, char *key, const Encoding *enc) {
+    Encoding *copy;
+    if (cache->entries >= cache->max_entries) {/*keep memory bounded, whatever is already cached keeps hitting*/
+        return;
+    }
+    copy = mem_alloc(MEM_CACHE, sizeof(Encoding));
+    memcpy(copy, enc, sizeof(Encoding));
+    /*keys are only put after a miss so there is no previous value to free*/
+    ht_put(cache->table, key, copy);
+    cache->entries++;
+}
+
+void print_cache_stats(EncodeCache *cache, FILE *file) {
+    unsigned long lookups;
+    lookups = cache->hits + cache->misses;
+    fprintf(file, "encode cache: %lu hits, %lu misses, %u entries, %.1f%% hit rate\n", cache->hits, cache->misses,
+            cache->entries, lookups ? 100.0 * cache->hits / lookups : 0.0);
+}
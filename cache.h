@@ -0,0 +1,114 @@
+/*
+ * cache.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  memoization of instruction encodings. an instruction encoding is kept without it's label
+ *  addresses, those are left as holes described by relocation
+ *  records, so one cached encoding fits every copy of the instruction no matter where it lands
+ */
+
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "util.h"
+#include "hashtable.h"
+#include "mem.h"
+
+#define CACHE_KEY_SIZE (4 * MAX_TOKEN_LEN) /*opcode plus up to 3 operands and separators*/
+#define CACHE_TABLE_SIZE 1024 /*size of the hashtable entries array*/
+#define CACHE_MAX_ENTRIES 65536 /*bound on the number of distinct instructions cached in one run*/
+
+/**
+ * Reloc struct
+ *
+ * Marks a hole in an encoding that depends on a label operand
+ */
+typedef struct {
+    byte operand; /*index of the label operand in the operands array*/
+    byte value_word; /*index of the word the label address is OR-ed into*/
+} Reloc;
+
+/**
+ * Encoding struct
+ *
+ * Holds an instruction encoding with holes for it's label operands
+ */
+typedef struct {
+    word bin[4]; /*the encoded words with label addresses left zeroed*/
+    byte num_words; /*number of words the instruction uses*/
+    byte num_relocs; /*number of items in relocs*/
+    Reloc relocs[3]; /*holes to patch, in operand order*/
+} Encoding;
+
+/**
+ * EncodeCache struct
+ *
+ * Maps normalized instructions to their encodings and counts how well it pays off
+ */
+typedef struct {
+    HashTable *table; /*key string to Encoding pointer*/
+    unsigned int max_entries; /*stop inserting once we hold this many encodings*/
+    unsigned int entries; /*number of encodings held*/
+    unsigned long hits; /*lookups that found an encoding*/
+    unsigned long misses; /*lookups that didn't*/
+} EncodeCache;
+
+/**
+ * Creates new empty encoding cache
+ *
+ * @param max_entries the maximum number of encodings to hold, bounds the memory the cache uses
+ * @return pointer to new encoding cache
+ */
+EncodeCache *new_encode_cache(unsigned int max_entries);
+
+/**
+ * Frees an encoding cache along with all the encodings in it
+ *
+ * @param cache the cache to free
+ */
+void free_encode_cache(EncodeCache *cache);
+
+/**
+ * Builds the cache key of an instruction. The key is the opcode followed by the operand tokens,
+ * except label operands which are reduced to their type character since they are holes in the encoding
+ *
+ * @param opcode the opcode integer rep
+ * @param operands the operand tokens as given by parse_line
+ * @param num_operands the number of operands in the operands parameter
+ * @param key a buffer of CACHE_KEY_SIZE characters to write the key into
+ * @return 1 if a key was built, 0 if the instruction is too long to be cached
+ */
+int make_cache_key(int opcode, char *operands[3], int num_operands, char *key);
+
+/**
+ * Finds the encoding cached for a key and counts the hit or miss
+ *
+ * @param cache the cache
+ * @param key a key made by make_cache_key
+ * @return the cached encoding, null if there isn't one
+ */
+Encoding *cache_get(EncodeCache *cache, char *key);
+
+/**
+ * Inserts a copy of an encoding into the cache, does nothing if the cache is full
+ *
+ * @param cache the cache
+ * @param key a key made by make_cache_key
+ * @param enc the encoding to copy into the cache
+ */
+void cache_put(EncodeCache *cache, char *key, const Encoding *enc);
+
+/**
+ * Prints the hit and miss counters of the cache
+ *
+ * @param cache the cache
+ * @param file the file to print into
+ */
+void print_cache_stats(EncodeCache *cache, FILE *file);
+
+#endif /* CACHE_H */
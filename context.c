@@ -0,0 +1,181 @@
+/*
+ * context.c
+ *
+ *  Created on: Oct 19, 2026
+ */
+#define _POSIX_C_SOURCE 200112L /*for ftruncate and fileno*/
+
+#include <unistd.h>
+
+#include "context.h"
+
+AsmContext *new_asm_context() {
+    AsmContext *ctx;
+    ctx = mem_alloc(MEM_OTHER, sizeof(AsmContext));
+    ctx->arena = new_arena(ARENA_BLOCK_SIZE);
+    ctx->symbols = new_symbol_table();
+    /*the table outlives resets of the arena, only it's entries and keys come from it*/
+    ctx->macros = new_clearable_hashtable(CTX_MACROS_SIZE, ctx->arena);
+    ctx->cache = new_encode_cache(CACHE_MAX_ENTRIES);
+    ctx->lines = new_line_stream();
+    ctx->data_spill = NULL;
+    ctx->out = new_output_buffers();
+    ctx->stats = new_stats();
+    ctx->one_pass = ctx->lazy_macros = ctx->stream = ctx->pipeline = ctx->mem_stats_per_file = ctx->sym = 0;
+    return ctx;
+}
+
+void free_asm_context(AsmContext *ctx) {
+    free_symbol_table(ctx->symbols);
+    free_hashtable(ctx->macros);
+    free_arena(ctx->arena);
+    free_encode_cache(ctx->cache);
+    free_line_stream(ctx->lines);
+    if (ctx->data_spill != NULL) {
+        fclose(ctx->data_spill);
+    }
+    free_output_buffers(ctx->out);
+    free_stats(ctx->stats);
+    mem_free(ctx);
+}
+
+void asm_context_reset(AsmContext *ctx) {
+    st_clear(ctx->symbols);
+    ctx->out->num_chunks = 0;/*the chunks are of the file's source*/
+    ht_clear(ctx->macros);/*before the arena, it's entries are in it*/
+    ls_clear(ctx->lines);
+    if (ctx->data_spill != NULL) {/*empty the temporary file instead of creating another*/
+        fflush(ctx->data_spill);
+        if (ftruncate(fileno(ctx->data_spill), 0) != 0) {
+            fclose(ctx->data_spill);
+            ctx->data_spill = NULL;
+        } else {
+            rewind(ctx->data_spill);
+        }
+    }
+    /*free the symbol data and everything else the file used at once for the next file assembly*/
+    arena_reset(ctx->arena);
+}
+
+void assemble_file(AsmContext *ctx, const char *name) {
+    LineStream *lines;/*macro expanded source of the file*/
+    FileStats *fs;
+    StatClock clk;
+    double file_start, phase_start;/*trace clock at the start of the file and of a phase*/
+    MemCounter mem_since[NUM_MEM_SUBSYSTEMS];/*allocation counts at the start of the file*/
+    unsigned int ic, dc;/*counters*/
+    long sym_bytes;
+    int expanded;/*1 if the macros were expanded, 0 if the file couldn't be read*/
+    byte is_valid;/*check if line is valid*/
+    byte pipelined;/*set when the pipeline did the first pass along with the macros*/
+    byte assembled;/*set when the file got to the encoding*/
+    char as_file_path[MAX_FILE_PATH],/*buffers for file paths*/
+            am_file_path[MAX_FILE_PATH],
+            obj_file_path[MAX_FILE_PATH],
+            ent_file_path[MAX_FILE_PATH],
+            ext_file_path[MAX_FILE_PATH],
+            sym_file_path[MAX_FILE_PATH];
+
+    ic = dc = 0;/*reset counters*/
+    is_valid = 1;/*assume file is valid*/
+    fs = stats_begin_file(ctx->stats, name);
+    mem_mark(mem_since);
+    stat_clock(&clk);
+    file_start = trace_now();
+
+    printf("assembling %s\n", name);/*notify user we started assembling the file*/
+    /*generate file paths*/
+    sprintf(as_file_path, "%s.as", name);
+    sprintf(am_file_path, "%s.am", name);
+    sprintf(obj_file_path, "%s.ob", name);
+    sprintf(ent_file_path, "%s.ent", name);
+    sprintf(ext_file_path, "%s.ext", name);
+    sprintf(sym_file_path, "%s.sym", name);
+    /*preprocessing step, expand macros into a line stream. the passes read the stream so the
+     * expanded file is only written for the user, unless asked not to. when streaming the expanded source
+     * goes straight to the .am file, or a temporary file if it's not wanted, and every pass reads it back*/
+    lines = ctx->stream ? new_spill_stream(ctx->lazy_macros ? NULL : am_file_path) : ctx->lines;
+    phase_start = trace_now();
+    expanded = pipelined = 0;
+    if (lines != NULL && ctx->pipeline) {/*validate and address the lines on other threads as they are expanded*/
+        expanded = pipeline_first_pass(as_file_path, lines, ctx->macros, ctx->symbols, &ic, &dc, &is_valid);
+        pipelined = expanded >= 0;/*or it couldn't start it's threads, do it all here instead*/
+    }
+    if (lines != NULL && !pipelined) {
+        expanded = expand_macros(as_file_path, lines, ctx->macros);
+        trace_span("macros", NULL, phase_start);
+    }
+    if (lines == NULL) {
+        is_valid = 0;
+    } else if (!expanded) {
+        is_valid = 0;
+        if (ctx->stream && !ctx->lazy_macros) {/*no .am file when the macros fail, like without streaming*/
+            remove(am_file_path);
+        }
+    } else {
+        if (!ctx->lazy_macros) {
+            phase_start = trace_now();
+            ls_write_file(lines, am_file_path);
+            trace_span("flush", NULL, phase_start);
+        }
+        stat_lap(fs, PHASE_MACROS, &clk);
+        if (!pipelined) {
+            /*send expanded macro source to the validation function*/
+            phase_start = trace_now();
+            validate_code(lines, &is_valid);
+            trace_span("validate", NULL, phase_start);
+            stat_lap(fs, PHASE_VALIDATE, &clk);
+        }
+    }
+    assembled = is_valid;
+    if (!is_valid) {/*if file has errors, contiune to next file*/
+        printf("got error(s) in file %s. files not created\n", as_file_path);
+
+    } else if (ctx->one_pass && !ctx->stream && !pipelined) {/*one pass assembly keeps the code in memory, streaming and
+                                                              * the pipeline assemble in two*/
+        /*read the macro expanded source once, encoding as we go and patching labels at the end*/
+        assemble_one_pass(ctx->symbols, ctx->cache, ctx->arena, ctx->out, lines, obj_file_path, ent_file_path, ext_file_path,
+                          &is_valid);
+        stat_lap(fs, PHASE_ASSEMBLE, &clk);
+
+    } else {
+        if (!pipelined) {
+            /*first pass, generate the symbol table and IC and DC from the macro expanded source, split between
+             * threads when there are more than one*/
+            phase_start = trace_now();
+            address_labels_parallel(ctx->symbols, &ic, &dc, lines, ctx->out->jobs, ctx->out->chunks,
+                                    &ctx->out->num_chunks);
+            trace_span("address", NULL, phase_start);
+            stat_lap(fs, PHASE_ADDRESS, &clk);
+        }
+        /*second pass, generate binary files from the symbol table and the macro expanded source. when streaming the
+         * code words go straight to the .ob file and the data words wait in a temporary file until the end*/
+        if (ctx->stream && ctx->data_spill == NULL) {
+            ctx->data_spill = tmpfile();
+        }
+        assemble_code(ctx->symbols, ctx->cache, ctx->arena, ctx->out, ic, dc, lines, ctx->stream ? ctx->data_spill : NULL,
+                      obj_file_path, ent_file_path, ext_file_path, &is_valid);
+        stat_lap(fs, PHASE_ASSEMBLE, &clk);
+    }
+    if (!is_valid && assembled) {/*the instructions had errors only the encoding could find, like missing labels*/
+        printf("got error(s) in file %s. files not created\n", as_file_path);
+    }
+    if (is_valid && ctx->sym) {/*the symbols with their uses, for tools that look them up without parsing*/
+        phase_start = trace_now();
+        sym_bytes = write_sym_file(ctx->symbols, sym_file_path);
+        if (sym_bytes > 0) {
+            STAT_ADD(STAT_BYTES, sym_bytes);
+        }
+        trace_span("sym", NULL, phase_start);
+    }
+    if (lines != ctx->lines) {
+        free_line_stream(lines);
+    }
+    stats_end_file(fs);
+    trace_span(name, name, file_start);
+
+    if (ctx->mem_stats_per_file) {/*before the reset, so the memory the file still holds shows as live*/
+        print_mem_stats(stderr, name, mem_since);
+    }
+    asm_context_reset(ctx);
+}
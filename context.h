@@ -0,0 +1,83 @@
+/*
+ * context.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  everything the assembly of a file needs that isn't the file itself, created once and reused for every file.
+ *  after a file the context is reset in time proportional to what the file used, the tables only clear the
+ *  slots and buckets that got entries, the arena only rewinds the blocks that were handed out and the buffers keep the
+ *  size they grew to, so files after the first don't pay for allocating them again
+ */
+
+#ifndef CONTEXT_H
+#define CONTEXT_H
+
+#include <stdio.h>
+#include <string.h>
+
+#include "util.h"
+#include "hashtable.h"
+#include "symtab.h"
+#include "arena.h"
+#include "cache.h"
+#include "stream.h"
+#include "macro.h"
+#include "address.h"
+#include "validate.h"
+#include "assemble.h"
+#include "pipeline.h"
+#include "symfile.h"
+#include "stats.h"
+#include "mem.h"
+#include "trace.h"
+
+#define CTX_MACROS_SIZE 100 /*buckets of the macro table*/
+
+/**
+ * AsmContext struct
+ *
+ * Holds the tables, buffers and options the files are assembled with
+ */
+typedef struct {
+    Arena *arena; /*memory that lives as long as the assembly of one file*/
+    SymbolTable *symbols; /*labels of the file being assembled*/
+    HashTable *macros; /*ids of the macros of the file being assembled*/
+    EncodeCache *cache; /*encodings don't depend on labels so the cache is kept across files*/
+    LineStream *lines; /*macro expanded source of the file when it's kept in memory*/
+    FILE *data_spill; /*the data image of the file in streaming mode, created with the first file that needs it*/
+    OutputBuffers *out; /*buffers the output files are written through*/
+    Stats *stats; /*times and counters of every file*/
+    byte one_pass, lazy_macros, stream, pipeline, mem_stats_per_file, sym; /*options*/
+} AsmContext;
+
+/**
+ * Creates a context with every option off
+ *
+ * @return the new context
+ */
+AsmContext *new_asm_context();
+
+/**
+ * Frees a context and everything in it
+ *
+ * @param ctx the context to free
+ */
+void free_asm_context(AsmContext *ctx);
+
+/**
+ * Empties the tables, buffers and arena of a context for the next file
+ *
+ * @param ctx the context to reset
+ */
+void asm_context_reset(AsmContext *ctx);
+
+/**
+ * Assembles a file, writing the .am, .ob, .ent and .ext files next to it, then resets the context
+ *
+ * @param ctx the context to assemble with
+ * @param name the path of the file without the .as extension, must live until the stats are printed and the
+ * trace is written
+ */
+void assemble_file(AsmContext *ctx, const char *name);
+
+#endif /* CONTEXT_H */
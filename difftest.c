@@ -0,0 +1,152 @@
+/*
+ ============================================================================
+ Name        : difftest.c
+ Version     : 0.0.1
+ Description : assembles inputs and random mutations of them in a reference mode and a new mode and reports
+               where the outputs or messages differ, with the throughput of both modes
+ ============================================================================
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "harness.h"
+
+/**
+ * Gets the name of an input without it's directories
+ *
+ * @param path the input path
+ * @return the part after the last slash
+ */
+const char *base_name(const char *path) {
+    const char *slash;
+    slash = strrchr(path, '/');
+    return slash != NULL ? slash + 1 : path;
+}
+
+/**
+ * Writes the times of an input as a table row
+ *
+ * @param out the file to write to
+ * @param name the input name
+ * @param lines number of source lines
+ * @param ref_secs wall time of the reference mode
+ * @param cur_secs wall time of the new mode
+ * @param result the result of diff_source
+ */
+void print_diff_row(FILE *out, const char *name, unsigned long lines, double ref_secs, double cur_secs, int result) {
+    fprintf(out, "%-24s %10lu %10.3f %10.3f %8.2fx %s\n", name, lines, ref_secs, cur_secs,
+            cur_secs > 0 ? ref_secs / cur_secs : 0, result == 1 ? "ok" : result == 0 ? "DIFF" : "error");
+}
+
+int main(int argc, char *argv[]) {/*main function*/
+    DiffMode ref, cur;
+    char as_path[MAX_FILE_PATH], name[MAX_FILE_PATH], mutant_path[2 * MAX_FILE_PATH], path[2 * MAX_FILE_PATH];
+    const char *assembler, *ref_assembler, *cur_assembler, *work;
+    unsigned long state, lines;
+    double ref_secs, cur_secs;
+    int i, k, mutants, result, inputs, diverged, errors, tested;
+
+    assembler = "./assembler";
+    ref_assembler = cur_assembler = NULL;
+    work = "difftest_work";
+    mutants = 0;
+    state = 1;
+    ref.num_options = cur.num_options = 0;
+    for (i = 1; i < argc; i++) {/*look for options first so they apply to every input no matter where they are*/
+        if (argv[i][0] != '-') {
+            continue;
+        }
+        if (strncmp(argv[i], "--assembler=", 12) == 0) {/*the same assembler in both modes*/
+            assembler = argv[i] + 12;
+        } else if (strncmp(argv[i], "--ref-assembler=", 16) == 0) {
+            ref_assembler = argv[i] + 16;
+        } else if (strncmp(argv[i], "--new-assembler=", 16) == 0) {
+            cur_assembler = argv[i] + 16;
+        } else if (strncmp(argv[i], "--ref-with=", 11) == 0 && ref.num_options < BENCH_MAX_ARGS) {
+            ref.options[ref.num_options++] = argv[i] + 11;
+        } else if (strncmp(argv[i], "--new-with=", 11) == 0 && cur.num_options < BENCH_MAX_ARGS) {
+            cur.options[cur.num_options++] = argv[i] + 11;
+        } else if (strncmp(argv[i], "--work=", 7) == 0) {
+            work = argv[i] + 7;
+        } else if (strncmp(argv[i], "--mutate=", 9) == 0) {/*mutants per input*/
+            mutants = atoi(argv[i] + 9);
+        } else if (strncmp(argv[i], "--seed=", 7) == 0) {
+            state = strtoul(argv[i] + 7, NULL, 10);
+        } else {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if (state == 0) {/*xorshift never leaves 0*/
+        state = 1;
+    }
+    if (cur.num_options == 0 && cur_assembler == NULL) {/*nothing to compare against, test the one pass assembler*/
+        cur.options[cur.num_options++] = "--one-pass";
+    }
+    init_diff_mode(&ref, ref_assembler != NULL ? ref_assembler : assembler, work, "ref");
+    init_diff_mode(&cur, cur_assembler != NULL ? cur_assembler : assembler, work, "new");
+    sprintf(path, "%s/mutants", work);
+    if (!make_dirs(ref.dir) || !make_dirs(cur.dir) || !make_dirs(path)) {
+        fprintf(stderr, "Error creating work directory %s\n", work);
+        return 1;
+    }
+
+    fprintf(stdout, "%-24s %10s %10s %10s %9s %s\n", "input", "lines", "ref secs", "new secs", "speedup", "result");
+    inputs = diverged = errors = tested = 0;
+    for (i = 1; i < argc; i++) {/*every other argument is an input, without extension like the assembler takes it*/
+        if (argv[i][0] == '-') {
+            continue;
+        }
+        inputs++;
+        sprintf(as_path, "%s.as", argv[i]);
+        strcpy(name, base_name(argv[i]));
+        lines = ref.lines;
+        ref_secs = ref.secs;
+        cur_secs = cur.secs;
+        result = diff_source(&ref, &cur, as_path, name, stderr);
+        print_diff_row(stdout, name, ref.lines - lines, ref.secs - ref_secs, cur.secs - cur_secs, result);
+        tested++;
+        if (result == 0) {
+            diverged++;
+        } else if (result < 0) {
+            errors++;
+            continue;
+        }
+
+        for (k = 0; k < mutants; k++) {/*mutants are reported only when they diverge, there can be many*/
+            sprintf(name, "%s_m%d", base_name(argv[i]), k);
+            sprintf(mutant_path, "%s/mutants/%s.as", work, name);
+            if (!mutate_source(as_path, mutant_path, &state)) {
+                errors++;
+                break;
+            }
+            result = diff_source(&ref, &cur, mutant_path, name, stderr);
+            tested++;
+            if (result == 0) {
+                diverged++;
+                sprintf(path, "%s/diverge_%d.as", work, diverged);
+                copy_file(mutant_path, path);
+                fprintf(stderr, "%s: mutant saved as %s\n", name, path);
+            } else if (result < 0) {/*the assembler crashed in both modes, worth keeping too*/
+                errors++;
+                sprintf(path, "%s/error_%d.as", work, errors);
+                copy_file(mutant_path, path);
+                fprintf(stderr, "%s: assembler failed in both modes, mutant saved as %s\n", name, path);
+            }
+        }
+        fflush(stdout);
+    }
+    if (inputs == 0) {
+        fprintf(stderr, "usage: %s [--assembler=path] [--ref-assembler=path] [--new-assembler=path] [--ref-with=option]... "
+                        "[--new-with=option]... [--work=dir] [--mutate=n] [--seed=n] input...\n", argv[0]);
+        return 1;
+    }
+
+    fprintf(stdout, "\n%d sources tested, %d diverged, %d errors\n", tested, diverged, errors);
+    fprintf(stdout, "%-10s %12s %10s %12s\n", "mode", "lines", "secs", "lines/s");
+    fprintf(stdout, "%-10s %12lu %10.3f %12.0f\n", "ref", ref.lines, ref.secs, ref.secs > 0 ? ref.lines / ref.secs : 0);
+    fprintf(stdout, "%-10s %12lu %10.3f %12.0f\n", "new", cur.lines, cur.secs, cur.secs > 0 ? cur.lines / cur.secs : 0);
+    return diverged > 0 || errors > 0;
+}
@@ -0,0 +1,344 @@
+/*
+ * disasm.c
+ *
+ *  Created on: Oct 19, 2026
+ */
+#include "disasm.h"
+
+#define ERA_EXTERNAL 1 /*ERA bits of a word that holds the address of an external label*/
+#define ERA_RELOCATABLE 2 /*ERA bits of a word that holds an address in the image*/
+#define MODE_OK(mask, mode) (((mask) >> (mode)) & 1) /*checks if an addressing mode is in a legal modes mask*/
+
+/*the decoded form of every first word, indexed by the bits above the ERA bits*/
+DecodeEntry decode_table[DECODE_TABLE_SIZE];
+
+/**
+ * Sets where a pair of operands that can share a word live, the operands of a binary opcode or the
+ * parameters of a jump with parameters. two registers share one word, anything else gets a word each
+ *
+ * @param e the entry to set
+ * @param first the index of the first operand of the pair
+ * @param first_word the index of the word of the first operand
+ */
+void set_operand_pair(DecodeEntry *e, int first, int first_word) {
+    byte both_regs;
+    both_regs = e->modes[first] == MODE_REG && e->modes[first + 1] == MODE_REG;
+    e->word[first] = first_word;
+    e->word[first + 1] = both_regs ? first_word : first_word + 1;
+    e->shift[first] = e->modes[first] == MODE_REG ? SRC_REG_SHIFT : VALUE_SHIFT;
+    e->shift[first + 1] = e->modes[first + 1] == MODE_REG ? DST_REG_SHIFT : VALUE_SHIFT;
+    e->num_words = e->word[first + 1] + 1;
+}
+
+void init_decode_table() {
+    unsigned int i;
+    int src, dst, param1, param2;
+    const OpcodeDesc *desc;
+    DecodeEntry *e;
+    word w;
+
+    for (i = 0; i < DECODE_TABLE_SIZE; i++) {
+        e = &decode_table[i];
+        memset(e, 0, sizeof(DecodeEntry));
+        w = i << ERA_BITS;
+        e->opcode = BITS_AT(w, OPCODE_BITS, OPCODE_SHIFT);
+        src = BITS_AT(w, MODE_BITS, SRC_MODE_SHIFT);
+        dst = BITS_AT(w, MODE_BITS, DST_MODE_SHIFT);
+        param1 = BITS_AT(w, MODE_BITS, PARAM1_MODE_SHIFT);
+        param2 = BITS_AT(w, MODE_BITS, PARAM2_MODE_SHIFT);
+        desc = &isa[e->opcode];
+        e->num_words = 1;
+
+        switch (desc->optype) {
+            case OPTYPE_INS:
+                e->valid = !src && !dst && !param1 && !param2;
+                break;
+            case OPTYPE_BIN:
+                e->valid = MODE_OK(desc->src_modes, src) && MODE_OK(desc->dst_modes, dst) && !param1 && !param2;
+                e->num_operands = 2;
+                e->modes[0] = src;
+                e->modes[1] = dst;
+                set_operand_pair(e, 0, 1);
+                break;
+            case OPTYPE_JMP:
+                if (dst == MODE_JMP) {/*the label word is followed by the parameters*/
+                    e->valid = !src && MODE_OK(desc->param_modes, param1) && MODE_OK(desc->param_modes, param2);
+                    e->params = 1;
+                    e->num_operands = 3;
+                    e->modes[0] = MODE_DIR;
+                    e->modes[1] = param1;
+                    e->modes[2] = param2;
+                    e->word[0] = 1;
+                    e->shift[0] = VALUE_SHIFT;
+                    set_operand_pair(e, 1, 2);
+                    break;
+                }
+                /*a jump without parameters is encoded like a unary opcode*/
+                /*fall through*/
+            case OPTYPE_UNI:
+                e->valid = !src && !param1 && !param2 && MODE_OK(desc->dst_modes, dst);
+                e->num_operands = 1;
+                e->modes[0] = dst;
+                e->word[0] = 1;
+                e->shift[0] = dst == MODE_REG ? DST_REG_SHIFT : VALUE_SHIFT;
+                e->num_words = 2;
+                break;
+        }
+    }
+}
+
+const DecodeEntry *decode_word(word w) {
+    const DecodeEntry *e;
+    if (BITS_AT(w, ERA_BITS, ERA_SHIFT) != 0) {/*first words are always absolute*/
+        return NULL;
+    }
+    e = &decode_table[BITS_AT(w, DECODE_BITS, ERA_BITS)];
+    return e->valid ? e : NULL;
+}
+
+/**
+ * Writes the label of an address to a buffer, the label from the .ent file if there is one, else a made up one
+ *
+ * @param buf the buffer to write to, at least MAX_TOKEN_LEN characters
+ * @param names the .ent label of every address in the image, indexed from BASE_ADDRESS
+ * @param addr the address
+ */
+void label_of(char *buf, const char **names, unsigned int addr) {
+    if (names[addr - BASE_ADDRESS] != NULL) {
+        strcpy(buf, names[addr - BASE_ADDRESS]);
+    } else {
+        sprintf(buf, "L%u", addr);
+    }
+}
+
+/**
+ * Writes the source code of an operand to a buffer
+ *
+ * @param buf the buffer to write to, at least MAX_TOKEN_LEN characters
+ * @param e the decode table entry of the instruction
+ * @param k the index of the operand
+ * @param w the word the operand is in
+ * @param ext the external label the word uses, null if it doesn't use one
+ * @param names the .ent label of every address in the image, indexed from BASE_ADDRESS
+ * @param n the number of words in the image
+ * @return 1 on success, 0 if the operand refers to something that isn't in the files
+ */
+int operand_to_str(char *buf, const DecodeEntry *e, int k, word w, const char *ext, const char **names, unsigned int n) {
+    unsigned int addr;
+    switch (e->modes[k]) {
+        case MODE_IMM:
+            sprintf(buf, "#%ld", SIGN_EXTEND(BITS_AT(w, VALUE_BITS, e->shift[k]), VALUE_BITS));
+            return 1;
+        case MODE_REG:
+            sprintf(buf, "r%u", (unsigned int) BITS_AT(w, REG_BITS, e->shift[k]));
+            return 1;
+    }
+    /*an address, of an external label or of a word in the image*/
+    if (BITS_AT(w, ERA_BITS, ERA_SHIFT) == ERA_EXTERNAL) {
+        if (ext == NULL) {
+            strcpy(buf, "?");
+            return 0;
+        }
+        strcpy(buf, ext);
+        return 1;
+    }
+    addr = BITS_AT(w, VALUE_BITS, e->shift[k]);
+    if (BITS_AT(w, ERA_BITS, ERA_SHIFT) != ERA_RELOCATABLE || addr < BASE_ADDRESS || addr - BASE_ADDRESS >= n) {
+        sprintf(buf, "?%u", addr);
+        return 0;
+    }
+    label_of(buf, names, addr);
+    return 1;
+}
+
+/**
+ * Writes the start of a line, the address and first word in listing mode and the label if the address has one
+ *
+ * @param out the file to write to
+ * @param listing if to write the address and first word
+ * @param addr the address of the line
+ * @param w the first word of the line
+ * @param label the label, null if the line has none
+ */
+void print_line_start(FILE *out, byte listing, unsigned int addr, word w, const char *label) {
+    int len;
+    if (listing) {
+        fprintf(out, "%04u ", addr);
+        print_word(w, out);
+        fputs("  ", out);
+    }
+    if (label != NULL) {
+        len = strlen(label) + 1;
+        fprintf(out, "%s:%*s", label, len < 8 ? 8 - len : 1, "");/*line the opcodes up*/
+    } else {
+        fputs("        ", out);
+    }
+}
+
+int disassemble(const char *name, FILE *out, byte listing) {
+    char path[MAX_FILE_PATH];
+    char label[MAX_TOKEN_LEN], operands[3][MAX_TOKEN_LEN];
+    ObjectFile obj;
+    ObjectSymbol *ents, *exts;
+    unsigned int num_ents, num_exts, n, i, j, addr, count;
+    const char **names, **ext_at;/*label of each address from the .ent file, external label of each word from the .ext file*/
+    byte *starts, *used;/*if an instruction starts at an address, if an address is used by an operand*/
+    const DecodeEntry *e;
+    HashTable *declared;/*externals that already got an .extern line*/
+    word w;
+    int k, ok;
+
+    sprintf(path, "%s.ob", name);
+    if (!read_object(path, &obj)) {
+        return 0;
+    }
+    sprintf(path, "%s.ent", name);
+    if (!read_symbols(path, &ents, &num_ents)) {
+        free_object(&obj);
+        return 0;
+    }
+    sprintf(path, "%s.ext", name);
+    if (!read_symbols(path, &exts, &num_exts)) {
+        free(ents);
+        free_object(&obj);
+        return 0;
+    }
+
+    ok = 1;
+    n = obj.ic + obj.dc;
+    names = calloc(n + 1, sizeof(char *));
+    ext_at = calloc(n + 1, sizeof(char *));
+    starts = calloc(n + 1, 1);
+    used = calloc(n + 1, 1);
+    for (i = 0; i < num_ents; i++) {
+        if (ents[i].addr < BASE_ADDRESS || ents[i].addr - BASE_ADDRESS >= n) {
+            fprintf(stderr, "%s.ent: %s is at %u, outside of the object file\n", name, ents[i].name, ents[i].addr);
+            ok = 0;
+            continue;
+        }
+        names[ents[i].addr - BASE_ADDRESS] = ents[i].name;
+    }
+    for (i = 0; i < num_exts; i++) {
+        if (exts[i].addr < BASE_ADDRESS || exts[i].addr - BASE_ADDRESS >= obj.ic) {
+            fprintf(stderr, "%s.ext: %s is used at %u, outside of the code\n", name, exts[i].name, exts[i].addr);
+            ok = 0;
+            continue;
+        }
+        ext_at[exts[i].addr - BASE_ADDRESS] = exts[i].name;
+    }
+
+    /*first go over the code to find where instructions start and which addresses operands use,
+     * the addresses that aren't in the .ent file get made up labels*/
+    i = 0;
+    while (i < obj.ic) {
+        starts[i] = 1;
+        e = decode_word(obj.words[i]);
+        if (e == NULL || i + e->num_words > obj.ic) {/*reported when the code is written*/
+            i++;
+            continue;
+        }
+        for (k = 0; k < e->num_operands; k++) {
+            w = obj.words[i + e->word[k]];
+            if (e->modes[k] == MODE_DIR && BITS_AT(w, ERA_BITS, ERA_SHIFT) == ERA_RELOCATABLE) {
+                addr = BITS_AT(w, VALUE_BITS, VALUE_SHIFT);
+                if (addr >= BASE_ADDRESS && addr - BASE_ADDRESS < n) {
+                    used[addr - BASE_ADDRESS] = 1;
+                }
+            }
+        }
+        i += e->num_words;
+    }
+    for (i = 0; i < obj.ic; i++) {/*a label can only be put on the first word of an instruction*/
+        if ((used[i] || names[i] != NULL) && !starts[i]) {
+            fprintf(out, "; address %u is used as a label but it's inside an instruction\n", i + BASE_ADDRESS);
+            ok = 0;
+        }
+    }
+
+    /*the declarations*/
+    fprintf(out, "; disassembled from %s.ob, %u code words and %u data words\n", name, obj.ic, obj.dc);
+    for (i = 0; i < num_ents; i++) {
+        fprintf(out, ".entry %s\n", ents[i].name);
+    }
+    declared = new_hashtable(num_exts + 1, NULL);
+    for (i = 0; i < num_exts; i++) {/*the .ext file has a line for every use, declare each label once*/
+        if (ht_get(declared, exts[i].name) == NULL) {
+            ht_put(declared, exts[i].name, exts[i].name);
+            fprintf(out, ".extern %s\n", exts[i].name);
+        }
+    }
+    free_hashtable(declared);
+
+    /*the code, an instruction per line*/
+    i = 0;
+    while (i < obj.ic) {
+        addr = i + BASE_ADDRESS;
+        if (names[i] != NULL || used[i]) {
+            label_of(label, names, addr);
+        }
+        print_line_start(out, listing, addr, obj.words[i], names[i] != NULL || used[i] ? label : NULL);
+        e = decode_word(obj.words[i]);
+        if (e == NULL || i + e->num_words > obj.ic) {
+            fprintf(out, "; word %u isn't the start of an instruction\n", addr);
+            ok = 0;
+            i++;
+            continue;
+        }
+        for (k = 0; k < e->num_operands; k++) {
+            if (!operand_to_str(operands[k], e, k, obj.words[i + e->word[k]], ext_at[i + e->word[k]], names, n)) {
+                ok = 0;
+            }
+        }
+        fputs(isa[e->opcode].name, out);
+        if (e->params) {
+            fprintf(out, " %s(%s,%s)", operands[0], operands[1], operands[2]);
+        } else if (e->num_operands == 2) {
+            fprintf(out, " %s, %s", operands[0], operands[1]);
+        } else if (e->num_operands == 1) {
+            fprintf(out, " %s", operands[0]);
+        }
+        fputc('\n', out);
+        i += e->num_words;
+    }
+
+    /*the data, a new .data line at every label and every DATA_PER_LINE words*/
+    count = 0;
+    for (i = obj.ic; i < n; i++) {
+        addr = i + BASE_ADDRESS;
+        if (count == DATA_PER_LINE || (count > 0 && (names[i] != NULL || used[i]))) {
+            fputc('\n', out);
+            count = 0;
+        }
+        if (count == 0) {
+            if (names[i] != NULL || used[i]) {
+                label_of(label, names, addr);
+            }
+            print_line_start(out, listing, addr, obj.words[i], names[i] != NULL || used[i] ? label : NULL);
+            fputs(".data ", out);
+        } else {
+            fputc(',', out);
+        }
+        fprintf(out, "%ld", SIGN_EXTEND(obj.words[i], ASM_WORD_SIZE));
+        count++;
+    }
+    if (count > 0) {
+        fputc('\n', out);
+    }
+
+    for (j = 0; j < num_exts; j++) {/*every use of an external label must be on an operand word*/
+        if (exts[j].addr >= BASE_ADDRESS && exts[j].addr - BASE_ADDRESS < obj.ic &&
+            BITS_AT(obj.words[exts[j].addr - BASE_ADDRESS], ERA_BITS, ERA_SHIFT) != ERA_EXTERNAL) {
+            fprintf(stderr, "%s.ext: %s is used at %u but the word there isn't external\n", name, exts[j].name, exts[j].addr);
+            ok = 0;
+        }
+    }
+
+    free(names);
+    free(ext_at);
+    free(starts);
+    free(used);
+    free(ents);
+    free(exts);
+    free_object(&obj);
+    return ok;
+}
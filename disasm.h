@@ -0,0 +1,67 @@
+/*
+ * disasm.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  table driven disassembly of .ob files. the bits above the ERA bits of a first word, the addressing modes and
+ *  the opcode, index a table that says everything about the instruction, so decoding an instruction is a table
+ *  lookup and a shift and mask per operand. the output is source code the assembler assembles back into the
+ *  same object file, with the labels of the .ent and .ext files and made up labels for other addresses
+ */
+
+#ifndef DISASM_H
+#define DISASM_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "util.h"
+#include "isa.h"
+#include "object.h"
+#include "hashtable.h"
+
+#define DECODE_BITS (ASM_WORD_SIZE - ERA_BITS) /*bits of the first word that index the decode table*/
+#define DECODE_TABLE_SIZE (1 << DECODE_BITS)
+#define DATA_PER_LINE 8 /*data words written on one .data line, keeps lines short enough to assemble*/
+
+/**
+ * DecodeEntry struct
+ *
+ * Holds the decoded form of a first word, the operands are in source code order
+ */
+typedef struct {
+    byte valid; /*if the opcode takes operands with these addressing modes*/
+    byte opcode; /*the opcode integer rep*/
+    byte num_words; /*number of words the instruction takes*/
+    byte num_operands; /*number of operands, a jump with parameters has the label and both parameters*/
+    byte params; /*if it's a jump with parameters*/
+    byte modes[3]; /*addressing mode of each operand*/
+    byte word[3]; /*index of the word each operand is in*/
+    byte shift[3]; /*where the value of each operand is in it's word*/
+} DecodeEntry;
+
+/**
+ * Fills the decode table, must be called before disassembling
+ */
+void init_decode_table();
+
+/**
+ * Finds the decoded form of a first word
+ *
+ * @param w the first word of an instruction
+ * @return the decode table entry, null if the word isn't a valid first word
+ */
+const DecodeEntry *decode_word(word w);
+
+/**
+ * Disassembles the .ob file of an assembled source along with it's .ent and .ext files if they exist
+ *
+ * @param name the name the source was assembled as, without extension
+ * @param out the file to write the source code to
+ * @param listing if to write the address and first word in front of every line, the output can't be assembled then
+ * @return 1 if the whole object file was disassembled, 0 if it couldn't be read or had words that aren't instructions
+ */
+int disassemble(const char *name, FILE *out, byte listing);
+
+#endif /* DISASM_H */
@@ -0,0 +1,43 @@
+/*
+ ============================================================================
+ Name        : disassembler.c
+ Version     : 0.0.1
+ Description : turns .ob files made by the assembler back into source code
+ ============================================================================
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "disasm.h"
+
+int main(int argc, char *argv[]) {/*main function*/
+    int i, failed;
+    byte listing;/*options*/
+
+    listing = 0;
+    for (i = 1; i < argc; i++) {/*look for options first so they apply to every file no matter where they are*/
+        if (argv[i][0] != '-') {
+            continue;
+        }
+        if (strcmp(argv[i], "--listing") == 0) {
+            listing = 1;
+        } else {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    init_decode_table();
+    failed = 0;
+    for (i = 1; i < argc; i++) {/*disassemble every file in the command arguments, named like the assembler names them*/
+        if (argv[i][0] == '-') {/*skip options*/
+            continue;
+        }
+        if (!disassemble(argv[i], stdout, listing)) {
+            failed = 1;
+        }
+    }
+    return failed;
+}
@@ -0,0 +1,160 @@
+/*
+ * emit.c
+ *
+ *  Created on: Oct 19, 2026
+ */
+#define _POSIX_C_SOURCE 200809L /*for pthreads, pwrite and ftruncate*/
+
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "emit.h"
+
+/**
+ * EmitJob struct
+ *
+ * Holds the range of words one thread writes
+ */
+typedef struct {
+    int fd; /*the .ob file*/
+    const word *words;
+    unsigned long first; /*index of the first word of the range*/
+    unsigned long last; /*index after the last word of the range*/
+    long offset; /*offset of the record of the first word in the file*/
+    byte ok; /*cleared if a write failed*/
+} EmitJob;
+
+/**
+ * Formats a word the way print_word writes it
+ *
+ * @param w the word
+ * @param str ASM_WORD_SIZE characters to put the word in
+ */
+void format_word(word w, char *str) {
+    int i;
+    for (i = 0; i < ASM_WORD_SIZE; i++) {/*most significant bit goes first*/
+        str[ASM_WORD_SIZE - 1 - i] = (w >> i) & 1 ? ONE_CHAR : ZERO_CHAR;
+    }
+}
+
+void format_obj_record(long addr, word w, char *rec) {
+    format_word(FIELD(addr, ASM_WORD_SIZE, 0), rec);/*address column*/
+    rec[ASM_WORD_SIZE] = ' ';/*separate columns with space*/
+    format_word(w, rec + ASM_WORD_SIZE + 1);/*encoding column*/
+    rec[OBJ_RECORD_SIZE - 1] = '\n';
+}
+
+/**
+ * Writes a whole buffer at an offset, pwrite may write less than it was asked to
+ *
+ * @param fd the file
+ * @param buf the bytes to write
+ * @param len the number of bytes
+ * @param offset the offset in the file
+ * @return 1 on success, 0 if a write failed
+ */
+int pwrite_all(int fd, const char *buf, unsigned long len, long offset) {
+    long n;
+    while (len > 0) {
+        n = pwrite(fd, buf, len, offset);
+        if (n <= 0) {
+            return 0;
+        }
+        buf += n;
+        len -= n;
+        offset += n;
+    }
+    return 1;
+}
+
+/**
+ * Thread function that formats and writes the words of a job, a chunk at a time
+ *
+ * @param arg the EmitJob
+ * @return null
+ */
+void *emit_worker(void *arg) {
+    EmitJob *job;
+    char *chunk;
+    unsigned long i, n;
+    long offset;
+
+    job = (EmitJob *) arg;
+    chunk = malloc(EMIT_CHUNK_RECORDS * OBJ_RECORD_SIZE);
+    job->ok = chunk != NULL;
+    offset = job->offset;
+    for (i = job->first; job->ok && i < job->last; i += n) {
+        for (n = 0; n < EMIT_CHUNK_RECORDS && i + n < job->last; n++) {
+            format_obj_record(BASE_ADDRESS + i + n, job->words[i + n], chunk + n * OBJ_RECORD_SIZE);
+        }
+        job->ok = pwrite_all(job->fd, chunk, n * OBJ_RECORD_SIZE, offset);
+        offset += n * OBJ_RECORD_SIZE;
+    }
+    free(chunk);
+    return NULL;
+}
+
+long emit_object(const char *path, unsigned int ic, unsigned int dc, const word *words, unsigned long num_words,
+                 unsigned int jobs) {
+    pthread_t *threads;
+    EmitJob *emit_jobs;
+    byte *started, ok;
+    char header[32];
+    unsigned long per_job;
+    long header_len, size;
+    unsigned int i;
+    int fd;
+
+    fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (fd < 0) {
+        printf("Error opening file: %s\n", path);
+        return -1;
+    }
+    header_len = sprintf(header, "%u %u\n", ic, dc);
+    size = header_len + (long) num_words * OBJ_RECORD_SIZE;
+    /*size the file up front, the threads then only write in place*/
+    ok = ftruncate(fd, size) == 0 && pwrite_all(fd, header, header_len, 0);
+
+    if (jobs > num_words / EMIT_MIN_WORDS) {
+        jobs = num_words / EMIT_MIN_WORDS;
+    }
+    if (jobs < 1) {
+        jobs = 1;
+    }
+    per_job = (num_words + jobs - 1) / jobs;
+    threads = malloc(jobs * sizeof(pthread_t));
+    emit_jobs = malloc(jobs * sizeof(EmitJob));
+    started = malloc(jobs);
+    if (ok) {
+        for (i = 0; i < jobs; i++) {
+            emit_jobs[i].fd = fd;
+            emit_jobs[i].words = words;
+            emit_jobs[i].first = i * per_job < num_words ? i * per_job : num_words;
+            emit_jobs[i].last = emit_jobs[i].first + per_job < num_words ? emit_jobs[i].first + per_job : num_words;
+            emit_jobs[i].offset = header_len + (long) emit_jobs[i].first * OBJ_RECORD_SIZE;
+            /*the last range is written here, no point in a thread for it*/
+            started[i] = i + 1 < jobs && pthread_create(&threads[i], NULL, emit_worker, &emit_jobs[i]) == 0;
+            if (!started[i]) {/*couldn't get a thread, write the job's words here instead*/
+                emit_worker(&emit_jobs[i]);
+            }
+        }
+        for (i = 0; i < jobs; i++) {
+            if (started[i]) {
+                pthread_join(threads[i], NULL);
+            }
+            if (!emit_jobs[i].ok) {
+                ok = 0;
+            }
+        }
+    }
+    free(threads);
+    free(emit_jobs);
+    free(started);
+    close(fd);
+    if (!ok) {
+        printf("Error writing file: %s\n", path);
+        return -1;
+    }
+    return size;
+}
@@ -0,0 +1,49 @@
+/*
+ * emit.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  writing of a whole .ob file from several threads. after the header every line of the file is a record of
+ *  the same length, the address word, a space, the word and a newline, so the size of the file and the offset
+ *  of every word are known before anything is written. the file is sized up front and every thread formats a
+ *  range of the words and writes it in place with pwrite, without sharing a FILE
+ */
+
+#ifndef EMIT_H
+#define EMIT_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "util.h"
+#include "isa.h"
+
+#define OBJ_RECORD_SIZE (2 * ASM_WORD_SIZE + 2) /*bytes of a line of the .ob file after the header*/
+#define EMIT_CHUNK_RECORDS 4096 /*records a thread formats before writing them*/
+#define EMIT_MIN_WORDS 16384 /*words a thread gets at least, fewer words are written by fewer threads*/
+
+/**
+ * Formats a line of the .ob file, the same characters print_obj_line writes
+ *
+ * @param addr the address of the word
+ * @param w the word
+ * @param rec OBJ_RECORD_SIZE characters to put the line in, with no null terminator
+ */
+void format_obj_record(long addr, word w, char *rec);
+
+/**
+ * Writes an object file from several threads, every thread writes a range of the words in place
+ *
+ * @param path the path to write the .ob file to
+ * @param ic the IC counter for the header
+ * @param dc the DC counter for the header
+ * @param words the code words followed by the data words, the first one is at BASE_ADDRESS
+ * @param num_words the number of words
+ * @param jobs the most threads to write with
+ * @return the number of bytes written, -1 if the file couldn't be written
+ */
+long emit_object(const char *path, unsigned int ic, unsigned int dc, const word *words, unsigned long num_words,
+                 unsigned int jobs);
+
+#endif /* EMIT_H */
@@ -0,0 +1,89 @@
+/*
+ ============================================================================
+ Name        : emulator.c
+ Version     : 0.0.1
+ Description : runs .ob files made by the assembler on an emulation of the 14 bit machine
+ ============================================================================
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <limits.h>
+
+#include "object.h"
+#include "machine.h"
+
+int main(int argc, char *argv[]) {/*main function*/
+    ObjectFile obj;
+    Machine *m;
+    unsigned long limit, steps, total_steps;/*instruction counts*/
+    clock_t start;
+    double secs, total_secs;
+    int i, status, failed;
+    byte ips;/*options*/
+    char ob_file_path[MAX_FILE_PATH];
+
+    limit = ULONG_MAX;
+    ips = 0;
+    for (i = 1; i < argc; i++) {/*look for options first so they apply to every file no matter where they are*/
+        if (argv[i][0] != '-') {
+            continue;
+        }
+        if (strncmp(argv[i], "--limit=", 8) == 0) {
+            limit = strtoul(argv[i] + 8, NULL, 10);
+        } else if (strcmp(argv[i], "--ips") == 0) {
+            ips = 1;
+        } else {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    failed = 0;
+    total_steps = 0;
+    total_secs = 0;
+    for (i = 1; i < argc; i++) {/*run every program in the command arguments, named like the assembler names them*/
+        if (argv[i][0] == '-') {/*skip options*/
+            continue;
+        }
+        sprintf(ob_file_path, "%s.ob", argv[i]);
+        if (!read_object(ob_file_path, &obj)) {
+            failed = 1;
+            continue;
+        }
+        m = new_machine(&obj, argv[i]);
+        free_object(&obj);/*the machine has it's own copy of the image*/
+        if (m == NULL) {
+            failed = 1;
+            continue;
+        }
+
+        start = clock();
+        status = run_machine(m, limit, &steps);
+        secs = (double) (clock() - start) / CLOCKS_PER_SEC;
+        fflush(m->out);/*so program output comes before our reports*/
+
+        if (status == RUN_ERROR) {
+            fprintf(stderr, "%s: error at address %u: %s\n", argv[i], m->pc->addr, m->error);
+            failed = 1;
+        } else if (status == RUN_LIMIT) {
+            fprintf(stderr, "%s: stopped at address %u after %lu instructions\n", argv[i], m->pc->addr, steps);
+            failed = 1;
+        }
+        if (ips) {
+            fprintf(stderr, "%s: %lu instructions in %.3f s, %.0f instructions/s\n", argv[i], steps, secs,
+                    secs > 0 ? steps / secs : 0.0);
+        }
+        total_steps += steps;
+        total_secs += secs;
+        free_machine(m);
+    }
+    if (ips) {/*overall rate of the whole suite*/
+        fprintf(stderr, "total: %lu instructions in %.3f s, %.0f instructions/s\n", total_steps, total_secs,
+                total_secs > 0 ? total_steps / total_secs : 0.0);
+    }
+
+    return failed;
+}
@@ -0,0 +1,87 @@
+/*
+ ============================================================================
+ Name        : generator.c
+ Version     : 0.0.1
+ Description : writes generated assembly sources to measure the assembler on
+ ============================================================================
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "workload.h"
+
+int main(int argc, char *argv[]) {/*main function*/
+    GenConfig cfg;
+    int i, files, failed;
+    char *value;
+    char as_file_path[MAX_FILE_PATH];
+
+    default_gen_config(&cfg);
+    for (i = 1; i < argc; i++) {/*the workload goes first so the other options change it no matter where they are*/
+        if (strncmp(argv[i], "--preset=", 9) == 0 && !apply_preset(&cfg, argv[i] + 9)) {
+            fprintf(stderr, "unknown preset %s, expected mixed, labels, macros or externs\n", argv[i] + 9);
+            return 1;
+        }
+    }
+    for (i = 1; i < argc; i++) {
+        if (argv[i][0] != '-' || strncmp(argv[i], "--preset=", 9) == 0) {
+            continue;
+        }
+        value = strchr(argv[i], '=');
+        if (value == NULL) {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 1;
+        }
+        value++;
+        if (strncmp(argv[i], "--lines=", 8) == 0) {
+            cfg.lines = strtoul(value, NULL, 10);
+        } else if (strncmp(argv[i], "--labels=", 9) == 0) {
+            cfg.labels = strtoul(value, NULL, 10);
+        } else if (strncmp(argv[i], "--macros=", 9) == 0) {
+            cfg.macros = strtoul(value, NULL, 10);
+        } else if (strncmp(argv[i], "--macro-lines=", 14) == 0) {
+            cfg.macro_lines = strtoul(value, NULL, 10);
+        } else if (strncmp(argv[i], "--externs=", 10) == 0) {
+            cfg.externs = strtoul(value, NULL, 10);
+        } else if (strncmp(argv[i], "--entries=", 10) == 0) {
+            cfg.entries = strtoul(value, NULL, 10);
+        } else if (strncmp(argv[i], "--data=", 7) == 0) {
+            cfg.data_pct = strtoul(value, NULL, 10);
+        } else if (strncmp(argv[i], "--strings=", 10) == 0) {
+            cfg.string_pct = strtoul(value, NULL, 10);
+        } else if (strncmp(argv[i], "--extern-use=", 13) == 0) {
+            cfg.extern_pct = strtoul(value, NULL, 10);
+        } else if (strncmp(argv[i], "--seed=", 7) == 0) {
+            cfg.seed = strtoul(value, NULL, 10);
+        } else {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if (cfg.data_pct + cfg.string_pct > 100 || cfg.extern_pct > 100) {
+        fprintf(stderr, "percentages must add up to at most 100\n");
+        return 1;
+    }
+
+    files = failed = 0;
+    for (i = 1; i < argc; i++) {/*write a source for every file name, named like the assembler takes them*/
+        if (argv[i][0] == '-') {/*skip options*/
+            continue;
+        }
+        sprintf(as_file_path, "%s.as", argv[i]);
+        if (!generate_source(as_file_path, &cfg)) {
+            failed = 1;
+        }
+        cfg.seed++;/*each file gets different code*/
+        files++;
+    }
+    if (files == 0) {
+        fprintf(stderr, "usage: %s [--preset=name] [--lines=n] [--labels=n] [--macros=n] [--macro-lines=n] "
+                        "[--externs=n] [--entries=n] [--data=pct] [--strings=pct] [--extern-use=pct] [--seed=n] file...\n",
+                argv[0]);
+        return 1;
+    }
+    return failed;
+}
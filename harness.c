@@ -0,0 +1,402 @@
+/*
+ * harness.c
+ *
+ *  Created on: Oct 19, 2026
+ */
+#define _POSIX_C_SOURCE 200112L /*for mkdir*/
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "harness.h"
+
+/*output files that have to match byte for byte, and ones that have to have the same lines in any order*/
+const char *exact_exts[] = {".am", ".ob"};
+const char *set_exts[] = {".ent", ".ext"};
+#define NUM_EXACT_EXTS 2
+#define NUM_SET_EXTS 2
+
+void init_diff_mode(DiffMode *mode, const char *assembler, const char *work, const char *name) {
+    mode->assembler = assembler;
+    sprintf(mode->dir, "%s/%s", work, name);
+    mode->secs = 0;
+    mode->lines = 0;
+}
+
+int make_dirs(const char *path) {
+    char buf[MAX_FILE_PATH];
+    struct stat st;
+    unsigned long i;
+
+    strncpy(buf, path, MAX_FILE_PATH - 1);
+    buf[MAX_FILE_PATH - 1] = '\0';
+    for (i = 1; buf[i] != '\0'; i++) {/*every directory on the way, existing ones fail harmlessly*/
+        if (buf[i] == '/') {
+            buf[i] = '\0';
+            mkdir(buf, 0755);
+            buf[i] = '/';
+        }
+    }
+    mkdir(buf, 0755);
+    return stat(buf, &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+int copy_file(const char *src, const char *dst) {
+    FILE *in, *out;
+    char buf[BUFSIZ];
+    size_t n;
+
+    in = fopen(src, "rb");
+    if (in == NULL) {
+        fprintf(stderr, "Error opening file %s\n", src);
+        return 0;
+    }
+    out = fopen(dst, "wb");
+    if (out == NULL) {
+        fprintf(stderr, "Error creating file %s\n", dst);
+        fclose(in);
+        return 0;
+    }
+    while ((n = fread(buf, 1, sizeof(buf), in)) > 0) {
+        fwrite(buf, 1, n, out);
+    }
+    fclose(in);
+    fclose(out);
+    return 1;
+}
+
+/**
+ * Draws the next random number of a mutation, the same 32 bit xorshift the generator uses
+ *
+ * @param state the random state, never 0
+ * @return a random number below 2^32
+ */
+unsigned long mutate_rand(unsigned long *state) {
+    unsigned long x;
+    x = *state;
+    x ^= (x << 13) & 0xFFFFFFFFUL;
+    x ^= x >> 17;
+    x ^= (x << 5) & 0xFFFFFFFFUL;
+    *state = x;
+    return x;
+}
+
+/**
+ * Checks if a file exists
+ *
+ * @param path path to the file
+ * @return 1 if it exists, 0 otherwise
+ */
+int file_exists(const char *path) {
+    struct stat st;
+    return stat(path, &st) == 0;
+}
+
+/**
+ * Reads a whole file into memory
+ *
+ * @param path path to the file
+ * @param len a reference to put the length in
+ * @return the contents with a terminator after them, must be freed with free. null if the file doesn't exist
+ */
+char *read_whole(const char *path, unsigned long *len) {
+    FILE *file;
+    char *text;
+    unsigned long cap;
+    size_t n;
+
+    *len = 0;
+    file = fopen(path, "rb");
+    if (file == NULL) {
+        return NULL;
+    }
+    cap = BUFSIZ;
+    text = malloc(cap + 1);
+    while ((n = fread(text + *len, 1, cap - *len, file)) > 0) {
+        *len += n;
+        if (*len == cap) {
+            cap *= 2;
+            text = realloc(text, cap + 1);
+        }
+    }
+    text[*len] = '\0';
+    fclose(file);
+    return text;
+}
+
+/**
+ * Removes every occurrence of a directory and the slash after it from a text, so the messages of two modes
+ * that name their files by different directories can be compared
+ *
+ * @param text the text to change
+ * @param dir the directory
+ */
+void strip_dir(char *text, const char *dir) {
+    char *p;
+    unsigned long len;
+    len = strlen(dir);
+    p = text;
+    while ((p = strstr(p, dir)) != NULL) {
+        if (p[len] == '/') {
+            memmove(p, p + len + 1, strlen(p + len + 1) + 1);
+        } else {
+            p += len;
+        }
+    }
+}
+
+/**
+ * Compares strings through pointers to them, for qsort
+ */
+int cmp_lines(const void *a, const void *b) {
+    return strcmp(*(char *const *) a, *(char *const *) b);
+}
+
+/**
+ * Splits a text into it's lines in sorted order
+ *
+ * @param text the text, the line ends are replaced with terminators
+ * @param len the length of the text
+ * @param num_lines a reference to put the number of lines in
+ * @return the array of lines, must be freed with free
+ */
+char **sorted_lines(char *text, unsigned long len, unsigned long *num_lines) {
+    char **lines;
+    unsigned long i, n;
+    n = 0;
+    for (i = 0; i < len; i++) {
+        if (text[i] == '\n') {
+            n++;
+        }
+    }
+    lines = malloc((n + 1) * sizeof(char *));
+    *num_lines = 0;
+    i = 0;
+    while (i < len) {
+        lines[(*num_lines)++] = text + i;
+        while (i < len && text[i] != '\n') {
+            i++;
+        }
+        text[i++] = '\0';
+    }
+    qsort(lines, *num_lines, sizeof(char *), cmp_lines);
+    return lines;
+}
+
+/**
+ * Compares two files, either byte for byte or as sets of lines. two missing files are the same
+ *
+ * @param a path of the first file
+ * @param b path of the second file
+ * @param as_set if to compare the lines in any order
+ * @param dir_a directory to strip from the first file before comparing, null to compare as is
+ * @param dir_b directory to strip from the second file before comparing, null to compare as is
+ * @return 1 if the files are the same, 0 otherwise
+ */
+int same_files(const char *a, const char *b, byte as_set, const char *dir_a, const char *dir_b) {
+    char *text_a, *text_b, **lines_a, **lines_b;
+    unsigned long len_a, len_b, n_a, n_b, i;
+    int same;
+
+    text_a = read_whole(a, &len_a);
+    text_b = read_whole(b, &len_b);
+    if (text_a == NULL || text_b == NULL) {
+        same = text_a == text_b;
+    } else {
+        if (dir_a != NULL) {
+            strip_dir(text_a, dir_a);
+            strip_dir(text_b, dir_b);
+            len_a = strlen(text_a);
+            len_b = strlen(text_b);
+        }
+        if (!as_set) {
+            same = len_a == len_b && memcmp(text_a, text_b, len_a) == 0;
+        } else {
+            lines_a = sorted_lines(text_a, len_a, &n_a);
+            lines_b = sorted_lines(text_b, len_b, &n_b);
+            same = n_a == n_b;
+            for (i = 0; same && i < n_a; i++) {
+                same = strcmp(lines_a[i], lines_b[i]) == 0;
+            }
+            free(lines_a);
+            free(lines_b);
+        }
+    }
+    free(text_a);
+    free(text_b);
+    return same;
+}
+
+/**
+ * Assembles a source in a mode's directory, the outputs of earlier runs are removed first
+ *
+ * @param mode the mode
+ * @param as_path path to the .as file
+ * @param name the name to give the source in the mode directory
+ * @return the exit status of the assembler, -1 if it couldn't be run or crashed
+ */
+int run_mode(DiffMode *mode, const char *as_path, const char *name) {
+    char *argv[BENCH_MAX_ARGS + 3];
+    char path[2 * MAX_FILE_PATH + 8], base[2 * MAX_FILE_PATH];
+    unsigned long lines, bytes;
+    double secs;
+    long rss;
+    int i, status;
+
+    sprintf(base, "%s/%s", mode->dir, name);
+    for (i = 0; i < NUM_EXACT_EXTS; i++) {
+        sprintf(path, "%s%s", base, exact_exts[i]);
+        remove(path);
+    }
+    for (i = 0; i < NUM_SET_EXTS; i++) {
+        sprintf(path, "%s%s", base, set_exts[i]);
+        remove(path);
+    }
+    sprintf(path, "%s.as", base);
+    if (!copy_file(as_path, path) || !count_input(path, &lines, &bytes)) {
+        return -1;
+    }
+
+    argv[0] = (char *) mode->assembler;
+    for (i = 0; i < mode->num_options; i++) {
+        argv[i + 1] = mode->options[i];
+    }
+    argv[mode->num_options + 1] = base;
+    argv[mode->num_options + 2] = NULL;
+    sprintf(path, "%s.msg", base);/*the messages the assembler prints*/
+    status = run_measured(argv, path, &secs, &rss);
+    mode->secs += secs;
+    mode->lines += lines;
+    return status;
+}
+
+int diff_source(DiffMode *ref, DiffMode *cur, const char *as_path, const char *name, FILE *report) {
+    char path_ref[2 * MAX_FILE_PATH], path_cur[2 * MAX_FILE_PATH];
+    int i, status_ref, status_cur, same;
+
+    status_ref = run_mode(ref, as_path, name);
+    status_cur = run_mode(cur, as_path, name);
+    if (status_ref < 0 && status_cur < 0) {
+        return -1;
+    }
+    same = 1;
+    if (status_ref != status_cur) {
+        same = 0;
+        if (report != NULL) {
+            fprintf(report, "%s: exit status %d, reference %d\n", name, status_cur, status_ref);
+        }
+    }
+    for (i = 0; i < NUM_EXACT_EXTS + NUM_SET_EXTS; i++) {
+        sprintf(path_ref, "%s/%s%s", ref->dir, name, i < NUM_EXACT_EXTS ? exact_exts[i] : set_exts[i - NUM_EXACT_EXTS]);
+        sprintf(path_cur, "%s/%s%s", cur->dir, name, i < NUM_EXACT_EXTS ? exact_exts[i] : set_exts[i - NUM_EXACT_EXTS]);
+        if (i == 0 && (!file_exists(path_ref) || !file_exists(path_cur))) {
+            continue;/*a mode may not write the .am file at all, compare it only when both did*/
+        }
+        if (!same_files(path_ref, path_cur, i >= NUM_EXACT_EXTS, NULL, NULL)) {
+            same = 0;
+            if (report != NULL) {
+                fprintf(report, "%s: %s differs from %s\n", name, path_cur, path_ref);
+            }
+        }
+    }
+    sprintf(path_ref, "%s/%s.msg", ref->dir, name);
+    sprintf(path_cur, "%s/%s.msg", cur->dir, name);
+    if (!same_files(path_ref, path_cur, 1, ref->dir, cur->dir)) {/*a one pass mode reports in a different order*/
+        same = 0;
+        if (report != NULL) {
+            fprintf(report, "%s: messages in %s differ from %s\n", name, path_cur, path_ref);
+        }
+    }
+    return same;
+}
+
+int mutate_source(const char *seed_path, const char *out_path, unsigned long *state) {
+    char *text, **lines, *line, *tmp;
+    unsigned long len, num_lines, i, j, n, k, line_len;
+    FILE *out;
+    int kind;
+
+    text = read_whole(seed_path, &len);
+    if (text == NULL) {
+        fprintf(stderr, "Error opening seed file %s\n", seed_path);
+        return 0;
+    }
+    /*every line gets a buffer of it's own with room to grow by a character per mutation*/
+    lines = malloc(MUTATE_MAX_LINES * sizeof(char *));
+    num_lines = 0;
+    i = 0;
+    while (i < len && num_lines < MUTATE_MAX_LINES) {
+        j = i;
+        while (j < len && text[j] != '\n') {
+            j++;
+        }
+        lines[num_lines] = malloc(j - i + 8);
+        memcpy(lines[num_lines], text + i, j - i);
+        lines[num_lines][j - i] = '\0';
+        num_lines++;
+        i = j + 1;
+    }
+    free(text);
+
+    n = 1 + mutate_rand(state) % 3;
+    for (k = 0; k < n && num_lines > 0; k++) {
+        i = mutate_rand(state) % num_lines;
+        line = lines[i];
+        line_len = strlen(line);
+        kind = mutate_rand(state) % 6;
+        switch (kind) {
+            case 0:/*delete the line*/
+                free(line);
+                memmove(lines + i, lines + i + 1, (num_lines - i - 1) * sizeof(char *));
+                num_lines--;
+                break;
+            case 1:/*duplicate the line*/
+                if (num_lines == MUTATE_MAX_LINES) {
+                    break;
+                }
+                tmp = malloc(line_len + 8);
+                strcpy(tmp, line);
+                memmove(lines + i + 1, lines + i, (num_lines - i) * sizeof(char *));
+                lines[i + 1] = tmp;
+                num_lines++;
+                break;
+            case 2:/*swap with another line*/
+                j = mutate_rand(state) % num_lines;
+                lines[i] = lines[j];
+                lines[j] = line;
+                break;
+            case 3:/*replace a character*/
+                if (line_len > 0) {
+                    line[mutate_rand(state) % line_len] = MUTATE_CHARS[mutate_rand(state) % (sizeof(MUTATE_CHARS) - 1)];
+                }
+                break;
+            case 4:/*delete a character*/
+                if (line_len > 0) {
+                    j = mutate_rand(state) % line_len;
+                    memmove(line + j, line + j + 1, line_len - j);
+                }
+                break;
+            default:/*insert a character, the buffer has room for it*/
+                j = mutate_rand(state) % (line_len + 1);
+                memmove(line + j + 1, line + j, line_len - j + 1);
+                line[j] = MUTATE_CHARS[mutate_rand(state) % (sizeof(MUTATE_CHARS) - 1)];
+                tmp = realloc(line, line_len + 9);/*keep room for the next insert*/
+                lines[i] = tmp;
+        }
+    }
+
+    out = fopen(out_path, "w");
+    if (out != NULL) {
+        for (i = 0; i < num_lines; i++) {
+            fprintf(out, "%s\n", lines[i]);
+        }
+        fclose(out);
+    } else {
+        fprintf(stderr, "Error creating file %s\n", out_path);
+    }
+    for (i = 0; i < num_lines; i++) {
+        free(lines[i]);
+    }
+    free(lines);
+    return out != NULL;
+}
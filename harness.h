@@ -0,0 +1,89 @@
+/*
+ * harness.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  differential testing of assembler modes. a source is assembled by a reference mode and by a new mode, each
+ *  in it's own directory, and the outputs have to match: the .am and .ob files byte for byte, the .ent and .ext
+ *  files as sets of lines since their order follows the labels table, and the messages printed. sources can
+ *  also be mutated at random to look for inputs the modes disagree on
+ */
+
+#ifndef HARNESS_H
+#define HARNESS_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "util.h"
+#include "bench.h"
+
+#define MUTATE_MAX_LINES 4096 /*lines of a seed source kept for mutation, the rest are cut*/
+#define MUTATE_CHARS " ,#:.-+\"()r0123456789aLX\t" /*characters mutations put in, the ones the syntax is made of*/
+
+/**
+ * DiffMode struct
+ *
+ * Holds how a mode runs the assembler and the totals of it's runs
+ */
+typedef struct {
+    const char *assembler; /*path to the assembler*/
+    char *options[BENCH_MAX_ARGS]; /*options passed to the assembler*/
+    int num_options;
+    char dir[MAX_FILE_PATH]; /*directory the mode assembles in*/
+    double secs; /*wall time of all runs*/
+    unsigned long lines; /*source lines of all runs*/
+} DiffMode;
+
+/**
+ * Sets the assembler and directory of a mode and clears it's totals, the options are left as they are
+ *
+ * @param mode the mode to set
+ * @param assembler path to the assembler
+ * @param work the work directory
+ * @param name the name of the mode, the directory it assembles in under the work directory
+ */
+void init_diff_mode(DiffMode *mode, const char *assembler, const char *work, const char *name);
+
+/**
+ * Creates a directory and the directories above it
+ *
+ * @param path path of the directory
+ * @return 1 if the directory exists now, 0 otherwise
+ */
+int make_dirs(const char *path);
+
+/**
+ * Copies a file
+ *
+ * @param src path of the file to copy
+ * @param dst path to copy to, overwritten if it exists
+ * @return 1 on success, 0 if a file couldn't be opened
+ */
+int copy_file(const char *src, const char *dst);
+
+/**
+ * Assembles a source in both modes and compares what they did
+ *
+ * @param ref the reference mode
+ * @param cur the mode being tested
+ * @param as_path path to the .as file
+ * @param name the name to give the source in the mode directories
+ * @param report a file to write the differences to, null to not write them
+ * @return 1 if the modes agree, 0 if they don't, -1 if the source couldn't be assembled
+ */
+int diff_source(DiffMode *ref, DiffMode *cur, const char *as_path, const char *name, FILE *report);
+
+/**
+ * Writes a copy of a source with a few random changes: lines deleted, duplicated or swapped and characters
+ * deleted, inserted or replaced with ones the syntax is made of
+ *
+ * @param seed_path path to the source to mutate
+ * @param out_path path to write the mutant to
+ * @param state the random state, must not be 0, advanced by the call
+ * @return 1 on success, 0 if a file couldn't be opened
+ */
+int mutate_source(const char *seed_path, const char *out_path, unsigned long *state);
+
+#endif /* HARNESS_H */
@@ -7,36 +7,79 @@
 
 #include "hashtable.h"
 
-HashTable *new_hashtable(unsigned int size) {
-    HashTable *ht = malloc(sizeof(HashTable));/*allocate memory for hashtable*/
+HashTable *new_hashtable(unsigned int size, Arena *arena) {
+    HashTable *ht = arena_alloc(arena, sizeof(HashTable), MEM_HASHTABLE);/*allocate memory for hashtable*/
     ht->size = size;/*set size of entries array*/
-    ht->entries = calloc(size, sizeof(Entry *));/*allocate memory for entries array*/
+    ht->arena = arena;
+    ht->entries = arena_alloc(arena, size * sizeof(Entry *), MEM_HASHTABLE);/*allocate memory for entries array*/
+    memset(ht->entries, 0, size * sizeof(Entry *));
+    ht->used = NULL;
+    ht->num_used = 0;
     return ht;
 }
 
+HashTable *new_clearable_hashtable(unsigned int size, Arena *arena) {
+    HashTable *ht;
+    ht = new_hashtable(size, NULL);/*the table and entries array with mem_alloc so they outlive the arena*/
+    ht->arena = arena;
+    ht->used = mem_alloc(MEM_HASHTABLE, size * sizeof(unsigned int));
+    return ht;
+}
+
+/**
+ * Frees the entries and keys of a bucket, does nothing for an arena table since they go away with the arena
+ *
+ * @param ht the hashtable
+ * @param index the index of the bucket
+ */
+void free_bucket(HashTable *ht, unsigned long index) {
+    Entry *curr, *tmp;
+
+    if (ht->arena != NULL) {
+        return;
+    }
+    curr = ht->entries[index];/*for each index there may be colliding keys which are kept
+    * as a linked list, so we iterate over them too*/
+    while (curr != NULL) {
+        tmp = curr;
+        curr = curr->next;
+        /*free key and struct since key string is copy of the original kept on the heap*/
+        mem_free(tmp->key);
+        mem_free(tmp);
+    }
+}
+
+void ht_clear(HashTable *ht) {
+    unsigned int i;
+    if (ht->num_used == ht->size) {/*the list may have filled up with buckets that were emptied and used again*/
+        for (i = 0; i < ht->size; i++) {
+            free_bucket(ht, i);
+        }
+        memset(ht->entries, 0, ht->size * sizeof(Entry *));
+    } else {
+        for (i = 0; i < ht->num_used; i++) {
+            free_bucket(ht, ht->used[i]);
+            ht->entries[ht->used[i]] = NULL;
+        }
+    }
+    ht->num_used = 0;
+}
+
 void free_hashtable(HashTable *ht) {
     /*iterators*/
-    int i;
-    Entry *curr, *tmp;
+    unsigned int i;
 
-    if (ht == NULL)/*make sure we got an initialized hashtable*/
+    if (ht == NULL || (ht->arena != NULL && ht->used == NULL))/*make sure we got an initialized hashtable, arena tables go away with their arena*/
         return;
 
     /*iterate over all entries*/
     for (i = 0; i < ht->size; i++) {
-        curr = ht->entries[i];/*for each index there may be colliding keys which are kept
-        * as a linked list, so we iterate over them too*/
-        while (curr != NULL) {
-            tmp = curr;
-            curr = curr->next;
-            /*free key and struct since key string is copy of the original kept on the heap*/
-            free(tmp->key);
-            free(tmp);
-        }
+        free_bucket(ht, i);
     }
     /*free entries array and hashtable memory*/
-    free(ht->entries);
-    free(ht);
+    mem_free(ht->used);
+    mem_free(ht->entries);
+    mem_free(ht);
 }
 
 unsigned long hash(char *key, unsigned int ht_size) {
@@ -76,11 +119,14 @@ void *ht_put(HashTable *ht, char *key, void *value) {
     /*if we haven't returned then the key doesn't exist in the
      * hashtable so we create a new key value pair for it and
      * insert it into the entries array*/
-    newEntry = malloc(sizeof(Entry));
-    newEntry->key = malloc(key_len);
+    newEntry = arena_alloc(ht->arena, sizeof(Entry), MEM_HASHTABLE);
+    newEntry->key = arena_alloc(ht->arena, key_len + 1, MEM_HASHTABLE);/*leave room for the terminator*/
     memcpy(newEntry->key, key, key_len + 1);
     newEntry->value = value;
     newEntry->next = ht->entries[index];
+    if (newEntry->next == NULL && ht->used != NULL && ht->num_used < ht->size) {/*a bucket to empty on ht_clear*/
+        ht->used[ht->num_used++] = index;
+    }
     ht->entries[index] = newEntry;
 
     return NULL;
@@ -125,8 +171,8 @@ void ht_remove(HashTable *ht, char *key) {
                 prev->next = curr->next;
             }
             /*and free the memory it occupies*/
-            free(curr->key);
-            free(curr);
+            arena_free(ht->arena, curr->key);
+            arena_free(ht->arena, curr);
             /*stop iterating*/
             return;
         }
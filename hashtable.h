@@ -5,7 +5,10 @@
  *      Author: amit
  *
  *  generic hash table structure meant for storing raw bytes of data.
- *  does not handle freeing of values just keys and nodes (only frees internal structure memory)
+ *  does not handle freeing of values just keys and nodes (only frees internal structure memory).
+ *  a table can be allocated from an arena, in which case all of it's memory goes away with the arena.
+ *  a clearable table keeps track of the buckets it uses so it can be emptied and used again in time
+ *  proportional to what was put in it
  */
 
 #ifndef HASHTABLE_H
@@ -17,6 +20,8 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "arena.h"
+
 /**
  * Entry struct
  *
@@ -39,17 +44,42 @@ typedef struct Entry {
 typedef struct {
 	unsigned int size;/*total amount of entries counted by unique keys*/
     Entry** entries;/*array of entry lists*/
+    Arena* arena;/*the arena the table, entries and keys are allocated from, null for malloc*/
+    unsigned int* used;/*indexes of the buckets that got entries since the table was cleared, null if not clearable*/
+    unsigned int num_used;
 } HashTable;
 
 /**
  * Creates a new hashtable
  * @param size of the entries array
+ * @param arena the arena to allocate from, null to use malloc
  * @return new hashtable with an entries array of given size
  */
-HashTable* new_hashtable(unsigned int size);
+HashTable* new_hashtable(unsigned int size, Arena* arena);
+
+/**
+ * Creates a new hashtable that can be emptied with ht_clear and used again. the table itself is allocated
+ * with mem_alloc, only the entries and keys come from the arena, so the table outlives resets of the arena
+ * as long as it's cleared before them
+ *
+ * @param size of the entries array
+ * @param arena the arena to allocate entries and keys from, null to use malloc
+ * @return new hashtable with an entries array of given size
+ */
+HashTable* new_clearable_hashtable(unsigned int size, Arena* arena);
+
+/**
+ * Removes every key from a clearable hashtable without freeing the values, in time proportional to the
+ * number of buckets used since it was last cleared
+ *
+ * @param ht the hashtable to clear
+ */
+void ht_clear(HashTable* ht);
 
 /**
- * Frees a given hashtable without freeing the values stored in the table
+ * Frees a given hashtable without freeing the values stored in the table. does nothing
+ * for a table allocated from an arena since it's freed along with the arena, a clearable table is freed
+ * but not the entries it got from an arena
  *
  * @param ht the hashtable to free
  */
@@ -0,0 +1,42 @@
+/*
+ * isa.c
+ *
+ *  Created on: Oct 19, 2026
+ */
+#include "isa.h"
+
+/*first word template shorthand*/
+#define OP_WORD(op) FIELD(op, OPCODE_BITS, OPCODE_SHIFT)
+
+/*all opcodes get their addressing mode bits from the operands at encoding time, a jump with parameters
+ * has addressing mode 2 in the destination bits of the first word*/
+const OpcodeDesc isa[NUM_OPCODES] = {
+        {"mov",  OPTYPE_BIN, MODES_ANY,          MODES_WRITABLE, MODES_NONE, OP_WORD(0)},
+        {"cmp",  OPTYPE_BIN, MODES_ANY,          MODES_ANY,      MODES_NONE, OP_WORD(1)},
+        {"add",  OPTYPE_BIN, MODES_ANY,          MODES_WRITABLE, MODES_NONE, OP_WORD(2)},
+        {"sub",  OPTYPE_BIN, MODES_ANY,          MODES_WRITABLE, MODES_NONE, OP_WORD(3)},
+        {"not",  OPTYPE_UNI, MODES_NONE,         MODES_WRITABLE, MODES_NONE, OP_WORD(4)},
+        {"clr",  OPTYPE_UNI, MODES_NONE,         MODES_WRITABLE, MODES_NONE, OP_WORD(5)},
+        {"lea",  OPTYPE_BIN, MODE_BIT(MODE_DIR), MODES_WRITABLE, MODES_NONE, OP_WORD(6)},
+        {"inc",  OPTYPE_UNI, MODES_NONE,         MODES_WRITABLE, MODES_NONE, OP_WORD(7)},
+        {"dec",  OPTYPE_UNI, MODES_NONE,         MODES_WRITABLE, MODES_NONE, OP_WORD(8)},
+        {"jmp",  OPTYPE_JMP, MODES_NONE,         MODES_ANY,      MODES_ANY,  OP_WORD(9)},
+        {"bne",  OPTYPE_JMP, MODES_NONE,         MODES_ANY,      MODES_ANY,  OP_WORD(10)},
+        {"red",  OPTYPE_UNI, MODES_NONE,         MODES_WRITABLE, MODES_NONE, OP_WORD(11)},
+        {"prn",  OPTYPE_UNI, MODES_NONE,         MODES_ANY,      MODES_NONE, OP_WORD(12)},
+        {"jsr",  OPTYPE_JMP, MODES_NONE,         MODES_ANY,      MODES_ANY,  OP_WORD(13)},
+        {"rts",  OPTYPE_INS, MODES_NONE,         MODES_NONE,     MODES_NONE, OP_WORD(14)},
+        {"stop", OPTYPE_INS, MODES_NONE,         MODES_NONE,     MODES_NONE, OP_WORD(15)}
+};
+
+int find_opcode(const char *opcode) {
+    int op;
+    for (op = 0; op < NUM_OPCODES; op++) {
+        /*compare the first character before calling strncmp since it rules out almost all opcodes.
+         * compares only the length of the opcode name like the source code parser always did*/
+        if (opcode[0] == isa[op].name[0] && strncmp(opcode, isa[op].name, strlen(isa[op].name)) == 0) {
+            return op;
+        }
+    }
+    return -1;/*else we got an unrecognized opcode*/
+}
@@ -0,0 +1,79 @@
+/*
+ * isa.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  instruction set descriptor table, the single place that says what each opcode accepts
+ *  and how it's first word looks. used by both validation and encoding
+ */
+
+#ifndef ISA_H
+#define ISA_H
+
+#include <string.h>
+
+#include "util.h"
+
+#define NUM_OPCODES 16
+
+#define MODE_IMM 0 /*immediate addressing mode, #5*/
+#define MODE_DIR 1 /*direct addressing mode, a label*/
+#define MODE_JMP 2 /*jump with parameters addressing mode, LABEL(a,b)*/
+#define MODE_REG 3 /*direct register addressing mode, r3*/
+
+#define MODE_BIT(mode) (1 << (mode)) /*bit of an addressing mode in a legal modes mask*/
+#define MODES_NONE 0
+#define MODES_ANY (MODE_BIT(MODE_IMM) | MODE_BIT(MODE_DIR) | MODE_BIT(MODE_REG))
+#define MODES_WRITABLE (MODE_BIT(MODE_DIR) | MODE_BIT(MODE_REG)) /*operands that can be written to*/
+
+#define ERA_BITS 2 /*width of the ERA field at the bottom of every word*/
+#define MODE_BITS 2 /*width of an addressing mode field in the first word*/
+#define OPCODE_BITS 4 /*width of the opcode field in the first word*/
+#define REG_BITS 5 /*width of a register field in a register operand word*/
+#define VALUE_BITS (ASM_WORD_SIZE - ERA_BITS) /*width of an immediate or address operand word value*/
+
+#define ERA_SHIFT 0 /*ERA bits, the same position in every word*/
+#define DST_MODE_SHIFT 2 /*destination operand addressing mode in the first word*/
+#define SRC_MODE_SHIFT 4 /*source operand addressing mode in the first word*/
+#define OPCODE_SHIFT 6 /*opcode in the first word*/
+#define PARAM2_MODE_SHIFT 10 /*2nd jump parameter addressing mode in the first word*/
+#define PARAM1_MODE_SHIFT 12 /*1st jump parameter addressing mode in the first word*/
+#define VALUE_SHIFT 2 /*immediate or address value in an operand word*/
+#define DST_REG_SHIFT 2 /*destination register number in a register operand word*/
+#define SRC_REG_SHIFT 8 /*source register number in a register operand word*/
+
+/*places the low bits of value at the given shift of a word, negative values end up in two's complement*/
+#define FIELD(value, bits, shift) ((word) ((((unsigned long) (long) (value)) & ((1UL << (bits)) - 1)) << (shift)))
+
+/*reads a field of a word*/
+#define BITS_AT(w, bits, shift) (((w) >> (shift)) & ((1 << (bits)) - 1))
+
+/*sign extends the low bits of a value*/
+#define SIGN_EXTEND(value, bits) ((((long) (value) & ((1L << (bits)) - 1)) ^ (1L << ((bits) - 1))) - (1L << ((bits) - 1)))
+
+/**
+ * Opcode descriptor struct
+ *
+ * Holds everything about an opcode that validation and encoding need to agree on
+ */
+typedef struct {
+    const char *name; /*opcode string rep in the source code*/
+    byte optype; /*one of the OPTYPE_ values defined in util.h*/
+    byte src_modes; /*mask of MODE_BIT values legal as source operand*/
+    byte dst_modes; /*mask of MODE_BIT values legal as destination operand (the only operand of unary and jump opcodes)*/
+    byte param_modes; /*mask of MODE_BIT values legal as jump parameters*/
+    word first_word; /*first word template, the operands addressing mode bits are OR-ed into it*/
+} OpcodeDesc;
+
+/*the descriptor table, indexed by opcode integer rep*/
+extern const OpcodeDesc isa[NUM_OPCODES];
+
+/**
+ * Finds the descriptor of an opcode string rep
+ *
+ * @param opcode opcode string rep
+ * @return the opcode integer rep, the index of it's descriptor in the isa table. returns -1 if undefined opcode string is provided
+ */
+int find_opcode(const char *opcode);
+
+#endif /* ISA_H */
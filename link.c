@@ -0,0 +1,303 @@
+/*
+ * link.c
+ *
+ *  Created on: Oct 19, 2026
+ */
+#define _POSIX_C_SOURCE 200112L /*for pthreads*/
+
+#include <pthread.h>
+
+#include "link.h"
+
+#define ERA_OF(w) (((w) >> ERA_SHIFT) & ((1 << ERA_BITS) - 1))
+#define VALUE_OF(w) (((w) >> VALUE_SHIFT) & ((1 << VALUE_BITS) - 1))
+
+/**
+ * ReadJob struct
+ *
+ * Holds the inputs one thread reads, every step-th input from first on
+ */
+typedef struct {
+    LinkInput *inputs;
+    unsigned int num_inputs;
+    unsigned int first;
+    unsigned int step;
+} ReadJob;
+
+/**
+ * Compares symbols by address for qsort
+ *
+ * @param a the first ObjectSymbol
+ * @param b the second ObjectSymbol
+ * @return negative, zero or positive like strcmp
+ */
+int compare_addrs(const void *a, const void *b) {
+    unsigned int x, y;
+    x = ((const ObjectSymbol *) a)->addr;
+    y = ((const ObjectSymbol *) b)->addr;
+    return x < y ? -1 : x > y;
+}
+
+/**
+ * Fills the exports and external uses of an input from a .sym file, the entries as the .ent file has them and the
+ * uses in address order as the .ext file has them
+ *
+ * @param path path to the .sym file
+ * @param in the input
+ * @return 1 if the file was read, 0 otherwise
+ */
+int read_sym_symbols(const char *path, LinkInput *in) {
+    SymFile sf;
+    const SymFileSymbol *sym;
+    ObjectSymbol *os;
+    unsigned int i, j;
+
+    if (!open_sym_file(path, &sf)) {
+        return 0;
+    }
+    for (i = 0; i < sf.header->num_symbols; i++) {/*count first so every array is allocated once*/
+        sym = &sf.symbols[i];
+        if (sym->type & SYM_ENT) {
+            in->num_ents++;
+        }
+        if (sym->type & SYM_EXT) {
+            in->num_exts += sym->num_uses;
+        }
+    }
+    in->ents = malloc((in->num_ents > 0 ? in->num_ents : 1) * sizeof(ObjectSymbol));
+    in->exts = malloc((in->num_exts > 0 ? in->num_exts : 1) * sizeof(ObjectSymbol));
+    in->num_ents = in->num_exts = 0;
+    for (i = 0; i < sf.header->num_symbols; i++) {
+        sym = &sf.symbols[i];
+        if (sym->type & SYM_ENT) {
+            os = &in->ents[in->num_ents++];
+            strncpy(os->name, sym_file_name(&sf, i), MAX_TOKEN_LEN - 1);
+            os->name[MAX_TOKEN_LEN - 1] = '\0';
+            os->addr = sym->addr;
+        }
+        for (j = 0; (sym->type & SYM_EXT) && j < sym->num_uses; j++) {
+            os = &in->exts[in->num_exts++];
+            strncpy(os->name, sym_file_name(&sf, i), MAX_TOKEN_LEN - 1);
+            os->name[MAX_TOKEN_LEN - 1] = '\0';
+            os->addr = sf.uses[sym->first_use + j];
+        }
+    }
+    qsort(in->exts, in->num_exts, sizeof(ObjectSymbol), compare_addrs);
+    close_sym_file(&sf);
+    return 1;
+}
+
+void read_link_input(LinkInput *in) {
+    char path[MAX_FILE_PATH];
+
+    in->ents = in->exts = NULL;
+    in->num_ents = in->num_exts = 0;
+    in->code_base = in->data_base = 0;
+
+    sprintf(path, "%s.ob", in->name);
+    in->ok = read_object(path, &in->obj);
+    if (in->ok && in->use_sym) {
+        sprintf(path, "%s.sym", in->name);
+        in->ok = read_sym_symbols(path, in);
+        return;
+    }
+    if (in->ok) {
+        sprintf(path, "%s.ent", in->name);
+        in->ok = read_symbols(path, &in->ents, &in->num_ents);
+    }
+    if (in->ok) {
+        sprintf(path, "%s.ext", in->name);
+        in->ok = read_symbols(path, &in->exts, &in->num_exts);
+    }
+}
+
+/**
+ * Thread function that reads the inputs of a job
+ *
+ * @param arg the ReadJob
+ * @return null
+ */
+void *read_worker(void *arg) {
+    ReadJob *job;
+    unsigned int i;
+    job = (ReadJob *) arg;
+    for (i = job->first; i < job->num_inputs; i += job->step) {/*inputs are independent so there is nothing to share*/
+        read_link_input(&job->inputs[i]);
+    }
+    return NULL;
+}
+
+void read_link_inputs(LinkInput *inputs, unsigned int num_inputs, unsigned int jobs) {
+    pthread_t *threads;
+    ReadJob *read_jobs;
+    byte *started;
+    unsigned int i;
+
+    if (jobs > num_inputs) {
+        jobs = num_inputs;
+    }
+    if (jobs <= 1) {/*no point in a thread*/
+        for (i = 0; i < num_inputs; i++) {
+            read_link_input(&inputs[i]);
+        }
+        return;
+    }
+
+    threads = malloc(jobs * sizeof(pthread_t));
+    read_jobs = malloc(jobs * sizeof(ReadJob));
+    started = malloc(jobs);
+    for (i = 0; i < jobs; i++) {
+        read_jobs[i].inputs = inputs;
+        read_jobs[i].num_inputs = num_inputs;
+        read_jobs[i].first = i;
+        read_jobs[i].step = jobs;
+        started[i] = pthread_create(&threads[i], NULL, read_worker, &read_jobs[i]) == 0;
+        if (!started[i]) {/*couldn't get a thread, read the job's inputs here instead*/
+            read_worker(&read_jobs[i]);
+        }
+    }
+    for (i = 0; i < jobs; i++) {
+        if (started[i]) {
+            pthread_join(threads[i], NULL);
+        }
+    }
+    free(threads);
+    free(read_jobs);
+    free(started);
+}
+
+void free_link_input(LinkInput *in) {
+    free_object(&in->obj);
+    free(in->ents);
+    free(in->exts);
+    in->ents = in->exts = NULL;
+}
+
+/**
+ * Moves an address of an input to where it is in the linked image
+ *
+ * @param in the input
+ * @param addr the address in the input
+ * @param ok a reference to a flag that is cleared if the address is outside the input
+ * @return the address in the linked image
+ */
+unsigned int relocate(const LinkInput *in, unsigned int addr, int *ok) {
+    unsigned int off;
+    off = addr - BASE_ADDRESS;
+    if (addr < BASE_ADDRESS || off >= in->obj.ic + in->obj.dc) {
+        *ok = 0;
+        return addr;
+    }
+    return BASE_ADDRESS + (off < in->obj.ic ? in->code_base + off : in->data_base + off - in->obj.ic);
+}
+
+unsigned int link_inputs(LinkInput *inputs, unsigned int num_inputs, ObjectFile *out) {
+    Arena *arena;
+    HashTable *exports;/*label to Export of every label some input exports*/
+    Export *exp;
+    LinkInput *in;
+    ObjectSymbol *sym;
+    word w, *code;
+    unsigned int errors, i, j, addr, off;
+    int ok;
+
+    errors = 0;
+    out->ic = out->dc = 0;
+    out->words = NULL;
+    for (i = 0; i < num_inputs; i++) {/*code of all inputs goes first*/
+        inputs[i].code_base = out->ic;
+        out->ic += inputs[i].obj.ic;
+    }
+    for (i = 0; i < num_inputs; i++) {/*followed by the data of all inputs*/
+        inputs[i].data_base = out->ic + out->dc;
+        out->dc += inputs[i].obj.dc;
+    }
+    if (BASE_ADDRESS + out->ic + out->dc > (1 << VALUE_BITS)) {
+        fprintf(stderr, "linked image of %u words doesn't fit in %d addresses\n", out->ic + out->dc,
+                (1 << VALUE_BITS) - BASE_ADDRESS);
+        return 1;
+    }
+
+    /*index all exports by name, with their address in the linked image*/
+    arena = new_arena(ARENA_BLOCK_SIZE);
+    exports = new_hashtable(LINK_TABLE_SIZE, arena);
+    for (i = 0; i < num_inputs; i++) {
+        for (j = 0; j < inputs[i].num_ents; j++) {
+            sym = &inputs[i].ents[j];
+            ok = 1;
+            addr = relocate(&inputs[i], sym->addr, &ok);
+            if (!ok) {
+                fprintf(stderr, "%s: exported label %s has address %u outside the file\n", inputs[i].name,
+                        sym->name, sym->addr);
+                errors++;
+                continue;
+            }
+            exp = (Export *) ht_get(exports, sym->name);
+            if (exp != NULL) {
+                fprintf(stderr, "duplicate symbol %s exported by %s and %s\n", sym->name, inputs[exp->input].name,
+                        inputs[i].name);
+                errors++;
+                continue;
+            }
+            exp = arena_alloc(arena, sizeof(Export), MEM_OTHER);
+            exp->addr = addr;
+            exp->input = i;
+            ht_put(exports, sym->name, exp);
+        }
+    }
+
+    out->words = malloc((out->ic + out->dc > 0 ? out->ic + out->dc : 1) * sizeof(word));
+    for (i = 0; i < num_inputs; i++) {
+        in = &inputs[i];
+        code = out->words + in->code_base;
+
+        for (j = 0; j < in->obj.ic; j++) {/*move the addresses in the code along with the code*/
+            w = in->obj.words[j];
+            if (ERA_OF(w) == ERA_RELOCATABLE) {
+                ok = 1;
+                addr = relocate(in, VALUE_OF(w), &ok);
+                if (!ok) {
+                    fprintf(stderr, "%s: word at address %u holds address %u outside the file\n", in->name,
+                            BASE_ADDRESS + j, VALUE_OF(w));
+                    errors++;
+                }
+                w = FIELD(addr, VALUE_BITS, VALUE_SHIFT) | FIELD(ERA_RELOCATABLE, ERA_BITS, ERA_SHIFT);
+            }
+            code[j] = w;
+        }
+        /*data words are values, not addresses*/
+        memcpy(out->words + in->data_base, in->obj.words + in->obj.ic, in->obj.dc * sizeof(word));
+
+        for (j = 0; j < in->num_exts; j++) {/*fill in the address of every use of an external label*/
+            sym = &in->exts[j];
+            off = sym->addr - BASE_ADDRESS;
+            if (sym->addr < BASE_ADDRESS || off >= in->obj.ic || ERA_OF(code[off]) != ERA_EXTERNAL) {
+                fprintf(stderr, "%s: use of %s at address %u isn't an external reference\n", in->name, sym->name,
+                        sym->addr);
+                errors++;
+                continue;
+            }
+            exp = (Export *) ht_get(exports, sym->name);
+            if (exp == NULL) {
+                fprintf(stderr, "undefined symbol %s used by %s at address %u\n", sym->name, in->name, sym->addr);
+                errors++;
+                code[off] = 0;/*reported, the image isn't written anyway*/
+                continue;
+            }
+            code[off] = FIELD(exp->addr, VALUE_BITS, VALUE_SHIFT) | FIELD(ERA_RELOCATABLE, ERA_BITS, ERA_SHIFT);
+        }
+        for (j = 0; j < in->obj.ic; j++) {/*every external reference must have been listed in the .ext file*/
+            if (ERA_OF(code[j]) == ERA_EXTERNAL) {
+                fprintf(stderr, "%s: external reference at address %u isn't in the .ext file\n", in->name,
+                        BASE_ADDRESS + j);
+                errors++;
+            }
+        }
+    }
+    free_arena(arena);
+
+    if (errors > 0) {
+        free_object(out);
+    }
+    return errors;
+}
@@ -0,0 +1,94 @@
+/*
+ * link.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  linking of separately assembled files into one image. the code of all the files goes first, in the order
+ *  they are given, followed by the data of all the files. the words that hold addresses in a file are moved
+ *  along with the file, and the words that use external labels get the address the label is exported at
+ */
+
+#ifndef LINK_H
+#define LINK_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "util.h"
+#include "isa.h"
+#include "object.h"
+#include "hashtable.h"
+#include "symfile.h"
+#include "arena.h"
+
+#define LINK_TABLE_SIZE 1024 /*size of the exports hashtable entries array*/
+#define LINK_JOBS 4 /*default number of threads reading the inputs*/
+
+#define ERA_ABSOLUTE 0 /*ERA bits of a word that doesn't hold an address*/
+#define ERA_EXTERNAL 1 /*ERA bits of a word that uses an external label*/
+#define ERA_RELOCATABLE 2 /*ERA bits of a word that holds an address in the file*/
+
+/**
+ * LinkInput struct
+ *
+ * Holds everything read from the files of one assembled source and where it goes in the linked image
+ */
+typedef struct {
+    const char *name; /*the name the files were assembled as, without extension*/
+    byte use_sym; /*read the symbols from the .sym file instead of the .ent and .ext files*/
+    byte ok; /*if all the files were read*/
+    ObjectFile obj; /*the .ob file*/
+    ObjectSymbol *ents; /*the .ent file, labels the file exports*/
+    unsigned int num_ents;
+    ObjectSymbol *exts; /*the .ext file, the words that use external labels*/
+    unsigned int num_exts;
+    unsigned int code_base; /*offset of the file's code in the linked image*/
+    unsigned int data_base; /*offset of the file's data in the linked image*/
+} LinkInput;
+
+/**
+ * Export struct
+ *
+ * Holds a label exported by one of the files and it's address in the linked image
+ */
+typedef struct {
+    unsigned int addr; /*address in the linked image*/
+    unsigned int input; /*index of the file that exports it*/
+} Export;
+
+/**
+ * Reads the .ob, .ent, and .ext files of an assembled source, or the .ob and .sym files, prints errors to stderr
+ *
+ * @param in the input to fill, it's name and use_sym must be set
+ */
+void read_link_input(LinkInput *in);
+
+/**
+ * Reads the files of many assembled sources using several threads, each thread reads whole inputs
+ *
+ * @param inputs the inputs to fill, their names must be set
+ * @param num_inputs the number of inputs
+ * @param jobs the number of threads to use
+ */
+void read_link_inputs(LinkInput *inputs, unsigned int num_inputs, unsigned int jobs);
+
+/**
+ * Frees the memory of an input
+ *
+ * @param in the input
+ */
+void free_link_input(LinkInput *in);
+
+/**
+ * Links inputs into one image. reports duplicate exports, uses of labels no input exports,
+ * and anything else that keeps the image from being linked to stderr
+ *
+ * @param inputs the inputs, all read successfully
+ * @param num_inputs the number of inputs
+ * @param out the object file to put the linked image in, it's words must be freed with free_object
+ * @return the number of errors, the image is only filled when there are none
+ */
+unsigned int link_inputs(LinkInput *inputs, unsigned int num_inputs, ObjectFile *out);
+
+#endif /* LINK_H */
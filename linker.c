@@ -0,0 +1,84 @@
+/*
+ ============================================================================
+ Name        : linker.c
+ Version     : 0.0.1
+ Description : links files made by the assembler into one .ob file
+ ============================================================================
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "link.h"
+
+int main(int argc, char *argv[]) {/*main function*/
+    LinkInput *inputs;
+    ObjectFile out;
+    unsigned int num_inputs, jobs, errors, i;
+    const char *out_name;/*options*/
+    byte use_sym;
+    char ob_file_path[MAX_FILE_PATH];
+
+    out_name = "a";
+    use_sym = 0;
+    jobs = LINK_JOBS;
+    for (i = 1; i < argc; i++) {/*look for options first so they apply no matter where they are*/
+        if (argv[i][0] != '-') {
+            continue;
+        }
+        if (strncmp(argv[i], "--out=", 6) == 0) {
+            out_name = argv[i] + 6;
+        } else if (strncmp(argv[i], "--jobs=", 7) == 0) {
+            jobs = strtoul(argv[i] + 7, NULL, 10);
+        } else if (strcmp(argv[i], "--sym") == 0) {
+            use_sym = 1;
+        } else {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    inputs = malloc(argc * sizeof(LinkInput));
+    num_inputs = 0;
+    for (i = 1; i < argc; i++) {/*every other argument is a file name, without extension like the assembler takes*/
+        if (argv[i][0] != '-') {
+            inputs[num_inputs].use_sym = use_sym;
+            inputs[num_inputs++].name = argv[i];
+        }
+    }
+    if (num_inputs == 0) {
+        fprintf(stderr, "usage: %s [--out=name] [--jobs=n] [--sym] file...\n", argv[0]);
+        free(inputs);
+        return 1;
+    }
+
+    read_link_inputs(inputs, num_inputs, jobs);
+    errors = 0;
+    for (i = 0; i < num_inputs; i++) {
+        if (!inputs[i].ok) {
+            errors++;
+        }
+    }
+    if (errors == 0) {
+        errors = link_inputs(inputs, num_inputs, &out);
+    }
+    if (errors == 0) {
+        sprintf(ob_file_path, "%s.ob", out_name);
+        if (write_object(ob_file_path, &out)) {
+            printf("linked %u files into %s, %u code words and %u data words\n", num_inputs, ob_file_path, out.ic,
+                   out.dc);
+        } else {
+            errors++;
+        }
+        free_object(&out);
+    } else {
+        printf("got %u error(s), %s.ob not created\n", errors, out_name);
+    }
+
+    for (i = 0; i < num_inputs; i++) {
+        free_link_input(&inputs[i]);
+    }
+    free(inputs);
+    return errors > 0;
+}
@@ -16,42 +16,43 @@ int cmp_data(void *a, void *b) {
     return memcmp(uca, ucb, sizeof(void *)) == 0;
 }
 
-List *new_list() {
+List *new_list(Arena *arena) {
     List *l;
-    l = malloc(sizeof(List));/*allocate memory for new list pointers*/
+    l = arena_alloc(arena, sizeof(List), MEM_LIST);/*allocate memory for new list pointers*/
+    l->arena = arena;
     l->length = 0;/*set count of items to 0*/
     l->head = NULL;/*indicate list is empty*/
     l->tail = NULL;
     return l;
 }
 
-void free_node(Node *n) {
+void free_node(Node *n, Arena *arena) {
     if (n == NULL) /*make sure we got a node*/
         return;
 
-    free(n);/*free memory held by the node*/
+    arena_free(arena, n);/*free memory held by the node*/
 }
 
 void free_list(List *l) {
     Node *current;/*iterator*/
     Node *tmp;/*for swapping*/
 
-    if (l == NULL)/*make sure we got a list*/
+    if (l == NULL || l->arena != NULL)/*make sure we got a list, arena lists go away with their arena*/
         return;
     current = l->head;/*start iterating from the last node inserted*/
 
     while (current != NULL) {/*iterate over all nodes*/
         tmp = current;
         current = current->next;/*move to next node*/
-        free_node(tmp);/*free current node*/
+        free_node(tmp, NULL);/*free current node*/
     }
 
-    free(l);/*free list memory*/
+    mem_free(l);/*free list memory*/
 }
 
 void l_push(List *l, void *data) {
     Node *new_node;
-    new_node = (Node *) malloc(sizeof(Node));/*allocate memory for a new node*/
+    new_node = (Node *) arena_alloc(l->arena, sizeof(Node), MEM_LIST);/*allocate memory for a new node*/
     new_node->data = data;/*set data pointer of new node to given data pointer*/
     new_node->next = l->head;/*set new node as the next node after the current head of the list*/
     new_node->prev = NULL;
@@ -64,11 +65,19 @@ void l_push(List *l, void *data) {
     l->length++;/*increase the count*/
 }
 
-void l_remove(Node *n) {
+void l_remove(List *l, Node *n) {
     if (n->prev != NULL) { /*make sure to retain connectivity of pointer chain*/
         n->prev->next = n->next;
+    } else {
+        l->head = n->next;
+    }
+    if (n->next != NULL) {
+        n->next->prev = n->prev;
+    } else {
+        l->tail = n->prev;
     }
-    free_node(n);/*free memory occupied by node*/
+    l->length--;
+    free_node(n, l->arena);/*free memory occupied by node*/
 }
 
 Node *l_find(List *l, void *data) {
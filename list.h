@@ -12,6 +12,8 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "arena.h"
+
 /**
  * Node sturct
  *
@@ -34,18 +36,21 @@ typedef struct {
 	int length; /*count of items in the list*/
 	Node* head; /*the last element to be pushed into the list*/
 	Node* tail; /*the first element to be pushed into the list*/
+	Arena* arena; /*the arena the list and it's nodes are allocated from, null for malloc*/
 } List;
 
 /**
  * Creates new empty list
  *
+ * @param arena the arena to allocate the list and it's nodes from, null to use malloc
  * @return pointer to new empty list in memory
  */
-List* new_list();
+List* new_list(Arena *arena);
 
 /**
  * Frees all memory occupied by the list including the nodes but
- * not including the data pointer at each node
+ * not including the data pointer at each node. does nothing for a list
+ * allocated from an arena since it's freed along with the arena
  *
  * @param l pointer to the list to free
  */
@@ -55,8 +60,9 @@ void free_list(List *l);
  * Frees the memory occupied by the node not including data pointer
  *
  * @param n pointer to the node to free
+ * @param arena the arena the node was allocated from
  */
-void free_node(Node* n);
+void free_node(Node* n, Arena* arena);
 
 /**
  * Push node to the list like in a stack
@@ -69,9 +75,10 @@ void l_push(List* l, void* data);
 /**
  * Remove node from the list and free it
  *
+ * @param l pointer to the list the node is in
  * @param n pointer to node to remove
  */
-void l_remove(Node* n);
+void l_remove(List* l, Node* n);
 
 /**
  * Find a node that contains a given data, compares node data by
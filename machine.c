@@ -0,0 +1,439 @@
+/*
+ * machine.c
+ *
+ *  Created on: Oct 19, 2026
+ */
+#include "machine.h"
+
+#define NORM(value) SIGN_EXTEND(value, ASM_WORD_SIZE) /*wraps a result around like the machine word does*/
+#define LEA_OPCODE 6
+
+/**
+ * Stops the machine on an illegal action
+ *
+ * @param m the machine
+ * @param inst the instruction that did it
+ * @param error what went wrong
+ * @return null so handlers can return it
+ */
+const Inst *machine_error(Machine *m, const Inst *inst, const char *error) {
+    m->pc = inst;
+    m->error = error;
+    return NULL;
+}
+
+/**
+ * Finds where a jump to the label of an instruction goes
+ *
+ * @param m the machine
+ * @param inst the jump instruction
+ * @return the target instruction, null if the label isn't an instruction
+ */
+const Inst *jump(Machine *m, const Inst *inst) {
+    if (inst->target == NULL) {
+        return machine_error(m, inst, "jump to an address that isn't an instruction");
+    }
+    return inst->target;
+}
+
+/**
+ * Finds where a jump to an address known only at run time goes
+ *
+ * @param m the machine
+ * @param inst the jump instruction
+ * @param addr the address
+ * @return the target instruction, null if the address isn't an instruction
+ */
+const Inst *jump_to(Machine *m, const Inst *inst, long addr) {
+    if (addr < 0 || addr >= MEM_SIZE || m->code_at[addr] == NULL) {
+        return machine_error(m, inst, "jump to an address that isn't an instruction");
+    }
+    return m->code_at[addr];
+}
+
+/**
+ * Passes the parameters of a jump with parameters in PARAM1_REG and PARAM2_REG
+ *
+ * @param m the machine
+ * @param inst the jump instruction
+ */
+void pass_params(Machine *m, const Inst *inst) {
+    long p1, p2;
+    p1 = *inst->param1;/*read both first, a parameter may be one of the registers*/
+    p2 = *inst->param2;
+    m->regs[PARAM1_REG] = p1;
+    m->regs[PARAM2_REG] = p2;
+}
+
+/**
+ * Pushes the instruction after a jsr to the stack
+ *
+ * @param m the machine
+ * @param inst the jsr instruction
+ * @return 1 if it was pushed, 0 if the stack is full
+ */
+int push_return(Machine *m, const Inst *inst) {
+    if (m->sp == STACK_SIZE) {
+        machine_error(m, inst, "stack overflow");
+        return 0;
+    }
+    m->stack[m->sp++] = inst + 1;
+    return 1;
+}
+
+/*opcode handlers, the ones that don't use the machine still take it so every handler has the same type*/
+
+const Inst *op_mov(Machine *m, const Inst *inst) {
+    (void) m;
+    *inst->dst = *inst->src;
+    return inst + 1;
+}
+
+const Inst *op_cmp(Machine *m, const Inst *inst) {
+    m->zero = *inst->src == *inst->dst;
+    return inst + 1;
+}
+
+const Inst *op_add(Machine *m, const Inst *inst) {
+    (void) m;
+    *inst->dst = NORM(*inst->dst + *inst->src);
+    return inst + 1;
+}
+
+const Inst *op_sub(Machine *m, const Inst *inst) {
+    (void) m;
+    *inst->dst = NORM(*inst->dst - *inst->src);
+    return inst + 1;
+}
+
+const Inst *op_not(Machine *m, const Inst *inst) {
+    (void) m;
+    *inst->dst = NORM(~*inst->dst);
+    return inst + 1;
+}
+
+const Inst *op_clr(Machine *m, const Inst *inst) {
+    (void) m;
+    *inst->dst = 0;
+    return inst + 1;
+}
+
+const Inst *op_inc(Machine *m, const Inst *inst) {
+    (void) m;
+    *inst->dst = NORM(*inst->dst + 1);
+    return inst + 1;
+}
+
+const Inst *op_dec(Machine *m, const Inst *inst) {
+    (void) m;
+    *inst->dst = NORM(*inst->dst - 1);
+    return inst + 1;
+}
+
+const Inst *op_jmp(Machine *m, const Inst *inst) {
+    return jump(m, inst);
+}
+
+const Inst *op_jmp_ind(Machine *m, const Inst *inst) {
+    return jump_to(m, inst, *inst->dst);
+}
+
+const Inst *op_jmp_par(Machine *m, const Inst *inst) {
+    pass_params(m, inst);
+    return jump(m, inst);
+}
+
+const Inst *op_bne(Machine *m, const Inst *inst) {
+    return m->zero ? inst + 1 : jump(m, inst);
+}
+
+const Inst *op_bne_ind(Machine *m, const Inst *inst) {
+    return m->zero ? inst + 1 : jump_to(m, inst, *inst->dst);
+}
+
+const Inst *op_bne_par(Machine *m, const Inst *inst) {
+    if (m->zero) {
+        return inst + 1;
+    }
+    pass_params(m, inst);
+    return jump(m, inst);
+}
+
+const Inst *op_red(Machine *m, const Inst *inst) {
+    int c;
+    c = getc(m->in);
+    *inst->dst = c == EOF ? -1 : NORM(c);
+    return inst + 1;
+}
+
+const Inst *op_prn(Machine *m, const Inst *inst) {
+    fprintf(m->out, "%ld\n", *inst->dst);
+    return inst + 1;
+}
+
+const Inst *op_jsr(Machine *m, const Inst *inst) {
+    return push_return(m, inst) ? jump(m, inst) : NULL;
+}
+
+const Inst *op_jsr_ind(Machine *m, const Inst *inst) {
+    return push_return(m, inst) ? jump_to(m, inst, *inst->dst) : NULL;
+}
+
+const Inst *op_jsr_par(Machine *m, const Inst *inst) {
+    if (!push_return(m, inst)) {
+        return NULL;
+    }
+    pass_params(m, inst);
+    return jump(m, inst);
+}
+
+const Inst *op_rts(Machine *m, const Inst *inst) {
+    if (m->sp == 0) {
+        return machine_error(m, inst, "rts with an empty stack");
+    }
+    return m->stack[--m->sp];
+}
+
+const Inst *op_stop(Machine *m, const Inst *inst) {
+    m->pc = inst;
+    return NULL;
+}
+
+const Inst *op_end(Machine *m, const Inst *inst) {
+    return machine_error(m, inst, "ran past the end of the code");
+}
+
+/*handlers by opcode, lea is a mov of the address which is a constant once decoded*/
+const Handler handlers[NUM_OPCODES] = {
+        op_mov, op_cmp, op_add, op_sub, op_not, op_clr, op_mov, op_inc,
+        op_dec, op_jmp, op_bne, op_red, op_prn, op_jsr, op_rts, op_stop
+};
+
+/**
+ * Picks the handler of a jump opcode by the addressing mode of it's operand
+ *
+ * @param op the opcode
+ * @param mode the addressing mode of the operand
+ * @return the handler
+ */
+Handler jump_handler(int op, int mode) {
+    Handler direct, indirect, params;
+    if (op == 10) {
+        direct = op_bne;
+        indirect = op_bne_ind;
+        params = op_bne_par;
+    } else if (op == 13) {
+        direct = op_jsr;
+        indirect = op_jsr_ind;
+        params = op_jsr_par;
+    } else {
+        direct = op_jmp;
+        indirect = op_jmp_ind;
+        params = op_jmp_par;
+    }
+    if (mode == MODE_DIR) {/*the target of a label is known before running*/
+        return direct;
+    }
+    return mode == MODE_JMP ? params : indirect;
+}
+
+/**
+ * Reads the address in a direct operand word
+ *
+ * @param w the operand word
+ * @param err a reference to put an error in
+ * @return the address
+ */
+long operand_address(word w, const char **err) {
+    if (BITS_AT(w, ERA_BITS, ERA_SHIFT) & 1) {/*the address of an external label is only known after linking*/
+        *err = "reference to an external label";
+    }
+    return BITS_AT(w, VALUE_BITS, VALUE_SHIFT);
+}
+
+/**
+ * Resolves an operand word to where the operand lives
+ *
+ * @param m the machine
+ * @param inst the instruction, immediates are kept in it's constants
+ * @param mode the addressing mode of the operand
+ * @param w the operand word
+ * @param reg_shift where the register is in the word for a register operand
+ * @param slot which of the instruction constants to use for an immediate
+ * @param err a reference to put an error in
+ * @return pointer to the operand
+ */
+long *decode_operand(Machine *m, Inst *inst, int mode, word w, int reg_shift, int slot, const char **err) {
+    int reg;
+    switch (mode) {
+        case MODE_IMM:
+            inst->consts[slot] = SIGN_EXTEND(BITS_AT(w, VALUE_BITS, VALUE_SHIFT), VALUE_BITS);
+            return &inst->consts[slot];
+        case MODE_DIR:
+            return &m->mem[operand_address(w, err)];
+        case MODE_REG:
+            reg = BITS_AT(w, REG_BITS, reg_shift);
+            if (reg >= NUM_REGS) {
+                *err = "no such register";
+                return &m->regs[0];
+            }
+            return &m->regs[reg];
+        default:
+            *err = "illegal addressing mode";
+            return &m->regs[0];
+    }
+}
+
+/**
+ * Predecodes the instruction at the start of the given words
+ *
+ * @param m the machine
+ * @param inst the instruction to fill
+ * @param words the words of the code from the instruction on
+ * @param avail the number of words left in the code
+ * @param target a reference to put the address a jump to a label goes to in, -1 for other instructions
+ * @param err a reference to put an error in
+ * @return the number of words the instruction takes
+ */
+unsigned int decode_inst(Machine *m, Inst *inst, const word *words, unsigned int avail, long *target,
+                         const char **err) {
+    int op, src_mode, dst_mode, param1_mode, param2_mode;
+    unsigned int len;
+
+    op = BITS_AT(words[0], OPCODE_BITS, OPCODE_SHIFT);
+    src_mode = BITS_AT(words[0], MODE_BITS, SRC_MODE_SHIFT);
+    dst_mode = BITS_AT(words[0], MODE_BITS, DST_MODE_SHIFT);
+    inst->exec = handlers[op];
+    *target = -1;
+
+    /*find the length first so we never read past the code*/
+    switch (isa[op].optype) {
+        case OPTYPE_BIN:/*two register operands share a word*/
+            len = src_mode == MODE_REG && dst_mode == MODE_REG ? 2 : 3;
+            break;
+        case OPTYPE_JMP:
+            if (dst_mode == MODE_JMP) {/*label word and parameter words, two register parameters share a word*/
+                len = BITS_AT(words[0], MODE_BITS, PARAM1_MODE_SHIFT) == MODE_REG &&
+                      BITS_AT(words[0], MODE_BITS, PARAM2_MODE_SHIFT) == MODE_REG ? 3 : 4;
+            } else {
+                len = 2;
+            }
+            break;
+        case OPTYPE_UNI:
+            len = 2;
+            break;
+        default:
+            len = 1;
+    }
+    if (len > avail) {
+        *err = "instruction runs past the end of the code";
+        return len;
+    }
+
+    switch (isa[op].optype) {
+        case OPTYPE_BIN:
+            inst->src = decode_operand(m, inst, src_mode, words[1], SRC_REG_SHIFT, 0, err);
+            inst->dst = decode_operand(m, inst, dst_mode, words[len - 1], DST_REG_SHIFT, 1, err);
+            if (op == LEA_OPCODE) {/*lea moves the address of the label, not what is there*/
+                if (src_mode != MODE_DIR) {
+                    *err = "lea of something other than a label";
+                }
+                inst->consts[0] = operand_address(words[1], err);
+                inst->src = &inst->consts[0];
+            }
+            break;
+        case OPTYPE_UNI:
+            inst->dst = decode_operand(m, inst, dst_mode, words[1], DST_REG_SHIFT, 1, err);
+            break;
+        case OPTYPE_JMP:
+            inst->exec = jump_handler(op, dst_mode);
+            if (dst_mode == MODE_JMP) {
+                param1_mode = BITS_AT(words[0], MODE_BITS, PARAM1_MODE_SHIFT);
+                param2_mode = BITS_AT(words[0], MODE_BITS, PARAM2_MODE_SHIFT);
+                *target = operand_address(words[1], err);
+                inst->param1 = decode_operand(m, inst, param1_mode, words[2], SRC_REG_SHIFT, 0, err);
+                inst->param2 = decode_operand(m, inst, param2_mode, words[len - 1], DST_REG_SHIFT, 1, err);
+            } else if (dst_mode == MODE_DIR) {
+                *target = operand_address(words[1], err);
+            } else {
+                inst->dst = decode_operand(m, inst, dst_mode, words[1], DST_REG_SHIFT, 1, err);
+            }
+            break;
+    }
+    return len;
+}
+
+Machine *new_machine(const ObjectFile *obj, const char *name) {
+    Machine *m;
+    Inst *inst;
+    long *targets;/*label each instruction jumps to, resolved once all instructions are decoded*/
+    const char *err;
+    unsigned int addr, end, i;
+
+    if (BASE_ADDRESS + obj->ic + obj->dc > MEM_SIZE) {
+        fprintf(stderr, "%s: program doesn't fit in %d words of memory\n", name, MEM_SIZE);
+        return NULL;
+    }
+    m = calloc(1, sizeof(Machine));/*registers, memory and flags all start zeroed*/
+    m->in = stdin;
+    m->out = stdout;
+    for (i = 0; i < obj->ic + obj->dc; i++) {/*load the image*/
+        m->mem[BASE_ADDRESS + i] = NORM(obj->words[i]);
+    }
+
+    m->code = malloc((obj->ic + 1) * sizeof(Inst));/*there are at most as many instructions as code words*/
+    targets = malloc((obj->ic + 1) * sizeof(long));
+    addr = BASE_ADDRESS;
+    end = BASE_ADDRESS + obj->ic;
+    err = NULL;
+    while (addr < end) {
+        inst = &m->code[m->num_insts];
+        memset(inst, 0, sizeof(Inst));
+        inst->addr = addr;
+        m->code_at[addr] = inst;
+        addr += decode_inst(m, inst, obj->words + (addr - BASE_ADDRESS), end - addr, &targets[m->num_insts], &err);
+        if (err != NULL) {
+            fprintf(stderr, "%s: can't decode instruction at address %u: %s\n", name, inst->addr, err);
+            free(targets);
+            free_machine(m);
+            return NULL;
+        }
+        m->num_insts++;
+    }
+    /*falling off the end of the code is an error rather than running into the data*/
+    inst = &m->code[m->num_insts];
+    memset(inst, 0, sizeof(Inst));
+    inst->exec = op_end;
+    inst->addr = end;
+
+    for (i = 0; i < m->num_insts; i++) {/*all the instructions are known now, so jumps to labels can be resolved*/
+        if (targets[i] >= 0) {
+            m->code[i].target = m->code_at[targets[i]];
+        }
+    }
+    free(targets);
+    return m;
+}
+
+void free_machine(Machine *m) {
+    if (m == NULL)/*make sure we got a machine*/
+        return;
+    free(m->code);
+    free(m);
+}
+
+int run_machine(Machine *m, unsigned long limit, unsigned long *steps) {
+    const Inst *pc;
+    unsigned long n;
+
+    pc = m->code;
+    for (n = 0; n < limit && pc != NULL; n++) {/*the handlers do all the work*/
+        pc = pc->exec(m, pc);
+    }
+    *steps = n;
+    if (pc != NULL) {
+        m->pc = pc;
+        return RUN_LIMIT;
+    }
+    return m->error != NULL ? RUN_ERROR : RUN_HALTED;
+}
@@ -0,0 +1,99 @@
+/*
+ * machine.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  emulator of the 14 bit machine. the code of a program is predecoded once into an array of instructions,
+ *  each holding a pointer to the handler of it's opcode and pointers to where it's operands live (a register,
+ *  a memory word or a constant kept in the instruction), so running an instruction is one indirect call with
+ *  no decoding. the handler returns the next instruction to run
+ */
+
+#ifndef MACHINE_H
+#define MACHINE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "util.h"
+#include "isa.h"
+#include "object.h"
+
+#define MEM_SIZE (1 << VALUE_BITS) /*every address an operand word can hold*/
+#define NUM_REGS 8
+#define STACK_SIZE 1024 /*deepest jsr nesting*/
+#define PARAM1_REG 6 /*register that gets the 1st parameter of a jump with parameters*/
+#define PARAM2_REG 7 /*register that gets the 2nd parameter of a jump with parameters*/
+
+#define RUN_HALTED 0 /*the program reached stop*/
+#define RUN_LIMIT 1 /*the instruction limit was reached*/
+#define RUN_ERROR 2 /*the program did something illegal, see the machine error*/
+
+typedef struct Machine Machine;
+typedef struct Inst Inst;
+
+/*runs an instruction and returns the next one to run, null to stop*/
+typedef const Inst *(*Handler)(Machine *m, const Inst *inst);
+
+/**
+ * Inst struct
+ *
+ * Used to store a predecoded instruction
+ */
+struct Inst {
+    Handler exec; /*handler of the opcode and addressing modes*/
+    long *src, *dst; /*where the operands live, the only operand of unary and jump opcodes is dst*/
+    long *param1, *param2; /*where the parameters of a jump with parameters live*/
+    const Inst *target; /*instruction a jump to a label goes to, null if the label isn't an instruction*/
+    long consts[2]; /*immediate operands and addresses, src and dst point here for those*/
+    unsigned int addr; /*address of the first word*/
+};
+
+/**
+ * Machine struct
+ *
+ * Used to store the state of the machine and the predecoded program
+ */
+struct Machine {
+    long regs[NUM_REGS]; /*registers, values are kept sign extended*/
+    long mem[MEM_SIZE]; /*memory, values are kept sign extended*/
+    byte zero; /*Z flag, set by cmp*/
+    Inst *code; /*predecoded instructions in address order, followed by one that stops at the end of the code*/
+    unsigned int num_insts;
+    const Inst *code_at[MEM_SIZE]; /*instruction starting at each address, null for addresses that don't start one*/
+    const Inst *stack[STACK_SIZE]; /*return instructions of jsr*/
+    unsigned int sp; /*number of items on the stack*/
+    const Inst *pc; /*instruction the machine stopped at*/
+    const char *error; /*what went wrong, for RUN_ERROR*/
+    FILE *in, *out; /*files red reads from and prn writes to*/
+};
+
+/**
+ * Creates a machine loaded with a program, memory from BASE_ADDRESS holds the object file image
+ * and the code is predecoded. prints an error if the code can't be decoded
+ *
+ * @param obj the object file
+ * @param name name of the program for error messages
+ * @return pointer to new machine, null if the code can't be decoded
+ */
+Machine *new_machine(const ObjectFile *obj, const char *name);
+
+/**
+ * Frees a machine
+ *
+ * @param m the machine to free
+ */
+void free_machine(Machine *m);
+
+/**
+ * Runs the program from it's first instruction
+ *
+ * @param m the machine
+ * @param limit the maximum number of instructions to run
+ * @param steps a reference to put the number of instructions that ran in
+ * @return one of the RUN_ values
+ */
+int run_machine(Machine *m, unsigned long limit, unsigned long *steps);
+
+#endif /* MACHINE_H */
@@ -15,13 +15,18 @@
 #include "util.h"
 #include "list.h"
 #include "hashtable.h"
+#include "stream.h"
+#include "stats.h"
 
 /**
- * Expands macros of an assembly file into a new assembly file
+ * Expands macros of an assembly file into a line stream. lines outside of macro definitions are
+ * appended to the stream, and a macro call is appended as a reference to the body of the macro
  *
  * @param in_file_path path to assembly file to expand
- * @param out_file_path path to create expanded assembly file in. overrites existing file at path
+ * @param lines an empty line stream to expand the file into
+ * @param macro_table an empty table to put the ids of the defined macros in, emptying it after is up to the caller
+ * @return 1 if the file was expanded, 0 if it couldn't be opened
  */
-void expand_macros(const char* in_file_path, const char* out_file_path);
+int expand_macros(const char* in_file_path, LineStream *lines, HashTable *macro_table);
 
 #endif /* MACRO_H_ */
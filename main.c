@@ -9,61 +9,130 @@
  */
 
 #include <stdio.h>
+#include <string.h>
 
-#include "hashtable.h"
-#include "parse.h"
-#include "macro.h"
-#include "address.h"
-#include "assemble.h"
-#include "validate.h"
+#include "context.h"
+#include "stats.h"
+#include "mem.h"
+#include "trace.h"
 
 int main(int argc, char *argv[]) {/*main function*/
-    HashTable *labels;/*to store labels for each file*/
-    Entry *ent;/*iterator*/
-    unsigned int ic, dc, i, j;/*counters*/
-    byte is_valid;/*check if line is valid*/
-    char as_file_path[MAX_FILE_PATH],/*buffers for file paths*/
-            am_file_path[MAX_FILE_PATH],
-            obj_file_path[MAX_FILE_PATH],
-            ent_file_path[MAX_FILE_PATH],
-            ext_file_path[MAX_FILE_PATH];
+    AsmContext *ctx;/*the tables and buffers every file is assembled with*/
+    int stats_format;
+    const char *trace_path;/*where to write the timeline, null for none*/
+    char **responses, *name;/*the names read from every response file, kept until the stats and trace are out*/
+    unsigned int num_responses, num_names, jobs, i, j;
+    byte cache_stats, one_pass, lazy_macros, mem_stats, mem_stats_per_file, perf, stream, pipeline, sym;/*options*/
 
-    for (i = 1; i < argc; i++) {/*iterate over all file names in the command arguments*/
-        labels = new_hashtable(400);/*init new ht for each file*/
-        ic = dc = 0;/*reset counters*/
-        is_valid = 1;/*assume file is valid*/
-
-        printf("assembling %s\n", argv[i]);/*notify user we started assembling the file*/
-        /*generate file paths*/
-        sprintf(as_file_path, "%s.as", argv[i]);
-        sprintf(am_file_path, "%s.am", argv[i]);
-        sprintf(obj_file_path, "%s.ob", argv[i]);
-        sprintf(ent_file_path, "%s.ent", argv[i]);
-        sprintf(ext_file_path, "%s.ext", argv[i]);
-        /*preprocessing step, expand macros into new file*/
-        expand_macros(as_file_path, am_file_path);
-        /*send expanded macro source file to the validation function*/
-        validate_code(am_file_path, &is_valid);
-        if (!is_valid) {/*if file has errors, contiune to next file*/
-            printf("got error(s) in file %s. files not created\n", as_file_path);
-
-        }else {
-            /*first pass, generate labels ht and IC and DC from the macro expanded source file*/
-            address_labels(labels, &ic, &dc, am_file_path);
-            /*second pass, generate binary files from the labels ht and the macro expanded source file*/
-            assemble_code(labels, ic, dc, am_file_path, obj_file_path, ent_file_path, ext_file_path);
+    cache_stats = one_pass = lazy_macros = mem_stats = mem_stats_per_file = perf = stream = pipeline = sym = 0;
+    jobs = 1;/*everything on this thread*/
+    stats_format = -1;/*not printed*/
+    trace_path = NULL;
+    for (i = 1; i < argc; i++) {/*look for options first so they apply to every file no matter where they are*/
+        if (argv[i][0] != '-') {
+            continue;
+        }
+        if (strcmp(argv[i], "--cache-stats") == 0) {
+            cache_stats = 1;
+        } else if (strcmp(argv[i], "--one-pass") == 0) {
+            one_pass = 1;
+        } else if (strcmp(argv[i], "--lazy-macros") == 0) {
+            lazy_macros = 1;
+        } else if (strcmp(argv[i], "--mem-stats") == 0) {
+            mem_stats = 1;
+        } else if (strcmp(argv[i], "--mem-stats=file") == 0) {
+            mem_stats = mem_stats_per_file = 1;
+        } else if (strcmp(argv[i], "--stats") == 0) {
+            stats_format = STATS_TABLE;
+        } else if (strncmp(argv[i], "--stats=", 8) == 0) {
+            stats_format = find_stats_format(argv[i] + 8);
+            if (stats_format < 0) {
+                printf("unknown stats format %s, expected table, json or prom\n", argv[i] + 8);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--stream") == 0) {
+            stream = 1;
+        } else if (strcmp(argv[i], "--pipeline") == 0) {
+            pipeline = 1;
+        } else if (strcmp(argv[i], "--sym") == 0) {
+            sym = 1;
+        } else if (strncmp(argv[i], "--jobs=", 7) == 0) {
+            jobs = strtoul(argv[i] + 7, NULL, 10);
+        } else if (strcmp(argv[i], "--perf") == 0) {
+            perf = 1;
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {/*the path is the next argument*/
+            trace_path = argv[++i];
+        } else if (strncmp(argv[i], "--trace=", 8) == 0) {
+            trace_path = argv[i] + 8;
+        } else {
+            printf("unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if (perf) {/*the counts are printed with the stats, as a table unless another format was asked for*/
+        perf_open();
+        if (stats_format < 0) {
+            stats_format = STATS_TABLE;
+        }
+    }
+    if (trace_path != NULL) {
+        trace_start();
+    }
+    ctx = new_asm_context();
+    ctx->one_pass = one_pass;
+    ctx->lazy_macros = lazy_macros;
+    ctx->stream = stream;
+    ctx->pipeline = pipeline;
+    ctx->sym = sym;
+    ctx->mem_stats_per_file = mem_stats_per_file;
+    /*both passes and the writing of the .ob files are split between threads when there are more than one*/
+    set_output_jobs(ctx->out, jobs);
+    responses = malloc(argc * sizeof(char *));
+    num_responses = 0;
 
-            /*free labels hashtable memory for the next file assembly*/
-            for (j = 0; j < labels->size; j++) {
-                ent = labels->entries[j];
-                while (ent != NULL) {
-                    free_sym_dat((SymbolData *) ent->value);
-                    ent = ent->next;
-                }
+    for (i = 1; i < argc; i++) {/*iterate over all file names in the command arguments*/
+        if (argv[i][0] == '-') {/*skip options*/
+            if (strcmp(argv[i], "--trace") == 0) {/*and the trace path after it*/
+                i++;
             }
+            continue;
         }
-        /*free labels hashtable*/
-        free_hashtable(labels);
+        if (argv[i][0] != '@') {
+            assemble_file(ctx, argv[i]);
+            continue;
+        }
+        /*a response file, assemble every file listed in it*/
+        name = read_response_file(argv[i] + 1, &num_names);
+        if (name == NULL) {
+            continue;
+        }
+        responses[num_responses++] = name;
+        for (j = 0; j < num_names; j++) {
+            assemble_file(ctx, name);
+            name += strlen(name) + 1;
+        }
+    }
+
+    if (cache_stats) {/*show how well the encoding cache paid off*/
+        print_cache_stats(ctx->cache, stdout);
+    }
+    if (stats_format >= 0) {/*stats go to stderr so they don't mix with the assembler's messages*/
+        print_stats(ctx->stats, stats_format, stderr);
+    }
+    perf_close();
+    if (trace_path != NULL) {/*the spans are only kept in memory until now*/
+        trace_write(trace_path);
+    }
+    free_asm_context(ctx);
+    for (i = 0; i < num_responses; i++) {
+        free(responses[i]);
+    }
+    free(responses);
+    if (mem_stats) {/*after freeing everything, memory still live at this point was leaked*/
+        print_mem_stats(stderr, "total", NULL);
+    }
+    if (stream) {/*to show it stays the same as the sources grow*/
+        fprintf(stderr, "peak resident memory %ld KB\n", mem_peak_rss_kb());
     }
 
     return 0;
@@ -0,0 +1,141 @@
+/*
+ * mem.c
+ *
+ *  Created on: Oct 19, 2026
+ */
+#define _DEFAULT_SOURCE /*for getrusage*/
+
+#include <sys/time.h>
+#include <sys/resource.h>
+
+#include "mem.h"
+
+MemCounter mem_counters[NUM_MEM_SUBSYSTEMS];
+
+/*names of the subsystems in the output, indexed by MEM_ values*/
+const char *mem_names[NUM_MEM_SUBSYSTEMS] = {"other", "list", "hashtable", "symbols", "tokens", "stream", "cache",
+                                             "assemble", "arena"};
+
+/**
+ * MemHeader union
+ *
+ * Put in front of every allocation so it can be counted when it's freed, aligned for any type
+ */
+typedef union {
+    struct {
+        unsigned long size; /*bytes allocated, without the header*/
+        int sub; /*subsystem that allocated it*/
+    } h;
+    long l;
+    double d;
+    void *p;
+} MemHeader;
+
+/**
+ * Raises a peak to a value if the value is higher, other threads may be raising it at the same time
+ *
+ * @param peak the peak counter
+ * @param value the value
+ */
+void raise_peak(unsigned long *peak, unsigned long value) {
+    unsigned long curr;
+    curr = __atomic_load_n(peak, __ATOMIC_RELAXED);
+    while (value > curr && !__atomic_compare_exchange_n(peak, &curr, value, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        /*curr was updated to the peak another thread set, try again if it's still lower*/
+    }
+}
+
+void mem_count_alloc(int sub, unsigned long size) {
+    MemCounter *c;
+    unsigned long live;
+    c = &mem_counters[sub];
+    __atomic_add_fetch(&c->allocs, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&c->bytes, size, __ATOMIC_RELAXED);
+    live = __atomic_add_fetch(&c->live, size, __ATOMIC_RELAXED);
+    raise_peak(&c->peak, live);
+    raise_peak(&c->mark_peak, live);
+}
+
+void mem_count_release(int sub, unsigned long allocs, unsigned long size) {
+    __atomic_add_fetch(&mem_counters[sub].frees, allocs, __ATOMIC_RELAXED);
+    __atomic_sub_fetch(&mem_counters[sub].live, size, __ATOMIC_RELAXED);
+}
+
+void *mem_alloc(int sub, unsigned long size) {
+    MemHeader *header;
+    header = malloc(sizeof(MemHeader) + size);
+    if (header == NULL) {
+        return NULL;
+    }
+    header->h.size = size;
+    header->h.sub = sub;
+    mem_count_alloc(sub, size);
+    return header + 1;
+}
+
+void *mem_realloc(void *p, int sub, unsigned long size) {
+    MemHeader *header;
+    unsigned long old_size;
+    if (p == NULL) {
+        return mem_alloc(sub, size);
+    }
+    header = (MemHeader *) p - 1;
+    old_size = header->h.size;
+    header = realloc(header, sizeof(MemHeader) + size);
+    if (header == NULL) {
+        return NULL;
+    }
+    header->h.size = size;
+    /*a resize counts as freeing the old memory and allocating the new*/
+    mem_count_release(header->h.sub, 1, old_size);
+    mem_count_alloc(header->h.sub, size);
+    return header + 1;
+}
+
+void mem_free(void *p) {
+    MemHeader *header;
+    if (p == NULL) {
+        return;
+    }
+    header = (MemHeader *) p - 1;
+    mem_count_release(header->h.sub, 1, header->h.size);
+    free(header);
+}
+
+void mem_mark(MemCounter *since) {
+    int i;
+    for (i = 0; i < NUM_MEM_SUBSYSTEMS; i++) {
+        mem_counters[i].mark_peak = mem_counters[i].live;
+    }
+    memcpy(since, mem_counters, sizeof(mem_counters));
+}
+
+void print_mem_stats(FILE *out, const char *title, const MemCounter *since) {
+    const MemCounter *c;
+    unsigned long allocs, frees, bytes, peak;
+    int i;
+
+    fprintf(out, "%-24s %12s %12s %14s %14s %14s\n", title, "allocs", "frees", "bytes", "live", "peak");
+    for (i = 0; i < NUM_MEM_SUBSYSTEMS; i++) {
+        c = &mem_counters[i];
+        allocs = c->allocs;
+        frees = c->frees;
+        bytes = c->bytes;
+        peak = c->peak;
+        if (since != NULL) {
+            allocs -= since[i].allocs;
+            frees -= since[i].frees;
+            bytes -= since[i].bytes;
+            peak = c->mark_peak;
+        }
+        fprintf(out, "%-24s %12lu %12lu %14lu %14lu %14lu\n", mem_names[i], allocs, frees, bytes, c->live, peak);
+    }
+}
+
+long mem_peak_rss_kb() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+    return usage.ru_maxrss;/*kilobytes on linux*/
+}
@@ -0,0 +1,116 @@
+/*
+ * mem.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  allocation accounting. every allocation is counted against the subsystem that made it, with the number of
+ *  allocations, the bytes, the bytes still allocated and the most bytes that were ever allocated at once.
+ *  memory from an arena is counted when it's handed out and released when the arena is reset, the arena blocks
+ *  behind it are counted on their own so the subsystems don't add up to what was taken from the system.
+ *  the counts are updated atomically so threads may allocate at the same time
+ */
+
+#ifndef MEM_H
+#define MEM_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MEM_OTHER 0
+#define MEM_LIST 1 /*lists and their nodes*/
+#define MEM_HASHTABLE 2 /*hashtables, their entries and keys, like the macro table*/
+#define MEM_SYMBOLS 3 /*the symbol table of labels*/
+#define MEM_TOKENS 4 /*tokens of parsed lines*/
+#define MEM_STREAM 5 /*macro expanded source*/
+#define MEM_CACHE 6 /*encoding cache*/
+#define MEM_ASSEMBLE 7 /*output buffers, the code image and fixups of one pass assembly*/
+#define MEM_ARENA 8 /*arena blocks, the memory behind every arena allocation*/
+#define NUM_MEM_SUBSYSTEMS 9
+
+/**
+ * MemCounter struct
+ *
+ * Holds the allocation counts of a subsystem
+ */
+typedef struct {
+    unsigned long allocs; /*number of allocations*/
+    unsigned long frees; /*number of allocations freed or released by an arena reset*/
+    unsigned long bytes; /*bytes allocated in total*/
+    unsigned long live; /*bytes allocated and not freed yet*/
+    unsigned long peak; /*most live bytes at once*/
+    unsigned long mark_peak; /*most live bytes at once since mem_mark*/
+} MemCounter;
+
+/*the counts of every subsystem, indexed by the MEM_ values*/
+extern MemCounter mem_counters[NUM_MEM_SUBSYSTEMS];
+
+/**
+ * Allocates memory with malloc and counts it
+ *
+ * @param sub the MEM_ value of the subsystem allocating
+ * @param size number of bytes to allocate
+ * @return pointer to the allocated memory
+ */
+void *mem_alloc(int sub, unsigned long size);
+
+/**
+ * Resizes memory given by mem_alloc
+ *
+ * @param p pointer to the memory, may be null
+ * @param sub the MEM_ value of the subsystem allocating, used if p is null
+ * @param size the new number of bytes
+ * @return pointer to the resized memory
+ */
+void *mem_realloc(void *p, int sub, unsigned long size);
+
+/**
+ * Frees memory given by mem_alloc and counts it against the subsystem that allocated it
+ *
+ * @param p pointer to the memory, may be null
+ */
+void mem_free(void *p);
+
+/**
+ * Counts memory an arena handed out
+ *
+ * @param sub the MEM_ value of the subsystem allocating
+ * @param size number of bytes
+ */
+void mem_count_alloc(int sub, unsigned long size);
+
+/**
+ * Counts memory released by an arena reset
+ *
+ * @param sub the MEM_ value of the subsystem that allocated it
+ * @param allocs number of allocations released
+ * @param size number of bytes released
+ */
+void mem_count_release(int sub, unsigned long allocs, unsigned long size);
+
+/**
+ * Copies the counts of every subsystem and starts measuring the mark peaks from the live bytes, so what a
+ * single file did can be printed with print_mem_stats
+ *
+ * @param since an array of NUM_MEM_SUBSYSTEMS counters to copy into
+ */
+void mem_mark(MemCounter *since);
+
+/**
+ * Writes the counts of every subsystem as a table
+ *
+ * @param out the file to write to
+ * @param title the title of the table
+ * @param since counts to subtract from allocations, frees and bytes as copied by mem_mark, the peak is then the
+ * mark peak. null to write the totals
+ */
+void print_mem_stats(FILE *out, const char *title, const MemCounter *since);
+
+/**
+ * Reads the most memory the process ever had resident, everything it touched and not only what was counted
+ *
+ * @return the peak resident memory in kilobytes, 0 if it couldn't be read
+ */
+long mem_peak_rss_kb();
+
+#endif /* MEM_H */
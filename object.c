@@ -0,0 +1,142 @@
+/*
+ * object.c
+ *
+ *  Created on: Oct 19, 2026
+ */
+#include "object.h"
+
+void print_word(word w, FILE *file) {
+    char str[ASM_WORD_SIZE];
+    int i;
+    for (i = 0; i < ASM_WORD_SIZE; i++) {/*most significant bit goes first*/
+        str[ASM_WORD_SIZE - 1 - i] = (w >> i) & 1 ? ONE_CHAR : ZERO_CHAR;
+    }
+    fwrite(str, 1, ASM_WORD_SIZE, file);
+}
+
+void print_int_as_word(long n, FILE *file) {
+    print_word(FIELD(n, ASM_WORD_SIZE, 0), file);/*mask to word size, negative numbers are already two's complement*/
+}
+
+int parse_word(const char *str, word *w) {
+    int i;
+    *w = 0;
+    for (i = 0; i < ASM_WORD_SIZE; i++) {/*most significant bit comes first*/
+        *w <<= 1;
+        if (str[i] == ONE_CHAR) {
+            *w |= 1;
+        } else if (str[i] != ZERO_CHAR) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+int read_object(const char *path, ObjectFile *obj) {
+    FILE *file;
+    char line[LINE_SIZE];
+    unsigned int i, n;
+    word addr;
+
+    obj->words = NULL;
+    /*open object file in read mode*/
+    file = fopen(path, "r");
+    if (file == NULL) {
+        fprintf(stderr, "Error opening object file %s\n", path);
+        return 0;
+    }
+    /*the header holds the number of code and data words*/
+    if (fgets(line, sizeof(line), file) == NULL || sscanf(line, "%u %u", &obj->ic, &obj->dc) != 2) {
+        fprintf(stderr, "%s: missing object file header\n", path);
+        fclose(file);
+        return 0;
+    }
+    n = obj->ic + obj->dc;
+    obj->words = malloc((n > 0 ? n : 1) * sizeof(word));
+
+    for (i = 0; i < n; i++) {/*every line is an address and the word at that address*/
+        if (fgets(line, sizeof(line), file) == NULL) {
+            fprintf(stderr, "%s: expected %u words, got %u\n", path, n, i);
+            break;
+        }
+        if (strlen(line) < 2 * ASM_WORD_SIZE + 1 || line[ASM_WORD_SIZE] != ' ' ||
+            !parse_word(line, &addr) || !parse_word(line + ASM_WORD_SIZE + 1, &obj->words[i])) {
+            fprintf(stderr, "%s: malformed line %u\n", path, i + 2);
+            break;
+        }
+        if (addr != BASE_ADDRESS + i) {/*the image is written in address order with no gaps*/
+            fprintf(stderr, "%s: line %u has address %u instead of %u\n", path, i + 2, addr, BASE_ADDRESS + i);
+            break;
+        }
+    }
+    fclose(file);
+
+    if (i < n) {
+        free_object(obj);
+        return 0;
+    }
+    return 1;
+}
+
+int write_object(const char *path, const ObjectFile *obj) {
+    FILE *file;
+    unsigned int i;
+
+    file = fopen(path, "w");
+    if (file == NULL) {
+        fprintf(stderr, "Error opening object file %s\n", path);
+        return 0;
+    }
+    fprintf(file, "%u %u\n", obj->ic, obj->dc);/*header, the number of code and data words*/
+    for (i = 0; i < obj->ic + obj->dc; i++) {/*address column and word column*/
+        print_int_as_word(BASE_ADDRESS + i, file);
+        fputc(' ', file);
+        print_word(obj->words[i], file);
+        fputc('\n', file);
+    }
+    fclose(file);
+    return 1;
+}
+
+int read_symbols(const char *path, ObjectSymbol **syms, unsigned int *num_syms) {
+    FILE *file;
+    char line[LINE_SIZE + MAX_TOKEN_LEN];
+    char *space;
+    unsigned int cap;
+    word addr;
+
+    *syms = NULL;
+    *num_syms = 0;
+    file = fopen(path, "r");
+    if (file == NULL) {/*no file, no symbols*/
+        return 1;
+    }
+    cap = 16;
+    *syms = malloc(cap * sizeof(ObjectSymbol));
+    while (fgets(line, sizeof(line), file)) {/*every line is a label, a space and an address*/
+        space = strchr(line, ' ');
+        if (space == NULL || space - line >= MAX_TOKEN_LEN || strlen(space + 1) < ASM_WORD_SIZE ||
+            !parse_word(space + 1, &addr)) {
+            fprintf(stderr, "%s: malformed line %u\n", path, *num_syms + 1);
+            fclose(file);
+            free(*syms);
+            *syms = NULL;
+            return 0;
+        }
+        if (*num_syms == cap) {
+            cap *= 2;
+            *syms = realloc(*syms, cap * sizeof(ObjectSymbol));
+        }
+        memcpy((*syms)[*num_syms].name, line, space - line);
+        (*syms)[*num_syms].name[space - line] = '\0';
+        (*syms)[*num_syms].addr = addr;
+        (*num_syms)++;
+    }
+    fclose(file);
+    return 1;
+}
+
+void free_object(ObjectFile *obj) {
+    free(obj->words);
+    obj->words = NULL;
+}
@@ -0,0 +1,105 @@
+/*
+ * object.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  the files the assembler writes, .ob files and the .ent and .ext symbol files. used by the assembler to write
+ *  them and by the tools that work on assembled programs to read them
+ */
+
+#ifndef OBJECT_H
+#define OBJECT_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "util.h"
+#include "isa.h"
+
+/**
+ * ObjectFile struct
+ *
+ * Holds the memory image of an object file, the code words followed by the data words
+ */
+typedef struct {
+    unsigned int ic; /*number of code words*/
+    unsigned int dc; /*number of data words*/
+    word *words; /*ic + dc words, the first one is at BASE_ADDRESS*/
+} ObjectFile;
+
+/**
+ * ObjectSymbol struct
+ *
+ * Holds a line of a .ent or .ext file, an exported label and it's address or a use of an external label
+ * and the address of the word that uses it
+ */
+typedef struct {
+    char name[MAX_TOKEN_LEN]; /*the label*/
+    unsigned int addr; /*the address*/
+} ObjectSymbol;
+
+/**
+ * Writes the bit character representation of a word to a file stream, most significant bit first.
+ * 0 and 1 bit characters are represented by the characters set in macros ZERO_CHAR and ONE_CHAR respectively
+ *
+ * @param w the word to write
+ * @param file the file to write the characters into
+ */
+void print_word(word w, FILE *file);
+
+/**
+ * Shortcut for writing an integer as a word, only the low ASM_WORD_SIZE bits of the integer are written
+ * so negative numbers come out in two's complement
+ *
+ * @param n integer to convert into bits character representation
+ * @param file the file to write characters into
+ */
+void print_int_as_word(long n, FILE *file);
+
+/**
+ * Converts a word in the .ob text form back to a word
+ *
+ * @param str ASM_WORD_SIZE characters of ZERO_CHAR and ONE_CHAR, most significant bit first
+ * @param w a reference to put the word in
+ * @return 1 if the string is a valid word, 0 otherwise
+ */
+int parse_word(const char *str, word *w);
+
+/**
+ * Reads an object file, prints an error to stderr if the file can't be read or is malformed
+ *
+ * @param path path to the .ob file
+ * @param obj the object file struct to fill, it's words must be freed with free_object
+ * @return 1 if the file was read, 0 otherwise
+ */
+int read_object(const char *path, ObjectFile *obj);
+
+/**
+ * Writes an object file
+ *
+ * @param path path to create the .ob file in. overrites existing file at path
+ * @param obj the object file to write
+ * @return 1 if the file was written, 0 if it couldn't be opened
+ */
+int write_object(const char *path, const ObjectFile *obj);
+
+/**
+ * Reads a .ent or .ext file. a missing file has no symbols since the assembler only creates
+ * the files when there are symbols to write. prints an error to stderr if the file is malformed
+ *
+ * @param path path to the file
+ * @param syms a reference to put the array of symbols in, must be freed with free
+ * @param num_syms a reference to put the number of symbols in
+ * @return 1 if the file was read or is missing, 0 otherwise
+ */
+int read_symbols(const char *path, ObjectSymbol **syms, unsigned int *num_syms);
+
+/**
+ * Frees the words of an object file read by read_object
+ *
+ * @param obj the object file
+ */
+void free_object(ObjectFile *obj);
+
+#endif /* OBJECT_H */
@@ -6,19 +6,19 @@
  */
 #include "parse.h"
 
-List *tokenize(char *line) {
+List *tokenize(char *line, Arena *arena) {
     List *tokens; /*list of tokens that resulted*/
     /*tmp storage and flags*/
     char *i, *tmp, tok[LINE_SIZE];
     int k, in_str;
     /*initialize variables*/
-    tokens = new_list();
+    tokens = new_list(arena);
     in_str = k = 0;
 
     for (i = line; *i != '\0'; i++) {/*iterate over characters in the line*/
         if (*i == '"') {/*if we are entering or exiting string, save current token to the list and flip the in string flag*/
             if (k > 0) { /*if token len > 0 than we have a token to save*/
-                tmp = (char *) malloc(k + 2);
+                tmp = (char *) arena_alloc(arena, k + 2, MEM_TOKENS);
                 strncpy(tmp, tok, k);
                 if (in_str) { /*if add " to the token so that we know it's a string token*/
                     tmp[k] = '\"';
@@ -35,21 +35,21 @@ List *tokenize(char *line) {
         if (!in_str) { /*if we are not in a string parse the characters normally as tokens*/
             if (*i == ',' || *i == ':' || *i == '(' || *i == ')') {/*if we hit a single character token, add it and the current token we accumulated to the list*/
                 if (k > 0) {/*if token len > 0 than we have a token to save*/
-                    tmp = (char *) malloc(k + 1);
+                    tmp = (char *) arena_alloc(arena, k + 1, MEM_TOKENS);
                     strncpy(tmp, tok, k);
                     tmp[k] = '\0';
                     l_push(tokens, tmp);
                 }
                 k = 0;/*zero token length because we are starting a new token*/
                 /*add single character token*/
-                tmp = (char *) malloc(2);
+                tmp = (char *) arena_alloc(arena, 2, MEM_TOKENS);
                 tmp[0] = *i;
                 tmp[1] = '\0';
                 l_push(tokens, tmp);
 
             } else if (isspace(*i)) {
                 if (k > 0) {/*if token len > 0 than we have a token to save*/
-                    tmp = (char *) malloc(k + 1);
+                    tmp = (char *) arena_alloc(arena, k + 1, MEM_TOKENS);
                     strncpy(tmp, tok, k);
                     tmp[k] = '\0';
                     l_push(tokens, tmp);
@@ -64,7 +64,7 @@ List *tokenize(char *line) {
 
     }
     if (k > 0) {/*take remaining token if there is any*/
-        tmp = (char *) malloc(k + 1);
+        tmp = (char *) arena_alloc(arena, k + 1, MEM_TOKENS);
         strncpy(tmp, tok, k);
         tmp[k] = '\0';
         l_push(tokens, tmp);
@@ -74,58 +74,7 @@ List *tokenize(char *line) {
 }
 
 int get_opcode(char *opcode) {
-    /*convert opcode to int using simple if-else-if logic*/
-    if (strncmp(opcode, "mov", 3) == 0) {
-        return 0;
-
-    } else if (strncmp(opcode, "cmp", 3) == 0) {
-        return 1;
-
-    } else if (strncmp(opcode, "add", 3) == 0) {
-        return 2;
-
-    } else if (strncmp(opcode, "sub", 3) == 0) {
-        return 3;
-
-    } else if (strncmp(opcode, "not", 3) == 0) {
-        return 4;
-
-    } else if (strncmp(opcode, "clr", 3) == 0) {
-        return 5;
-
-    } else if (strncmp(opcode, "lea", 3) == 0) {
-        return 6;
-
-    } else if (strncmp(opcode, "inc", 3) == 0) {
-        return 7;
-
-    } else if (strncmp(opcode, "dec", 3) == 0) {
-        return 8;
-
-    } else if (strncmp(opcode, "jmp", 3) == 0) {
-        return 9;
-
-    } else if (strncmp(opcode, "bne", 3) == 0) {
-        return 10;
-
-    } else if (strncmp(opcode, "red", 3) == 0) {
-        return 11;
-
-    } else if (strncmp(opcode, "prn", 3) == 0) {
-        return 12;
-
-    } else if (strncmp(opcode, "jsr", 3) == 0) {
-        return 13;
-
-    } else if (strncmp(opcode, "rts", 3) == 0) {
-        return 14;
-
-    } else if (strncmp(opcode, "stop", 4) == 0) {
-        return 15;
-
-    } else {
-        return -1;/*else we got an unrecognized opcode*/
-    }
+    return find_opcode(opcode);/*the opcode names live in the isa descriptor table*/
 }
 
 void parse_tok(char *start, char *end, char *type_val) {
@@ -174,14 +123,14 @@ void parse_tok(char *start, char *end, char *type_val) {
 
 void parse_line(char *line, byte *type, char tokens[MAX_TOKENS_PER_LINE][MAX_TOKEN_LEN], int *num_tokens) {
     /*tmp storage and flags*/
-    char type_val[LINE_SIZE], *tok, *i;
+    char type_val[LINE_SIZE], *tok, *i, *save;/*save is the position of split_token in the line*/
     int k;
     int token_len;
 
     *type = 0;
     *num_tokens = 0;
     k = 0;
-    tok = strtok(line, " ");/*grab first word of the line*/
+    tok = split_token(line, " ", &save);/*grab first word of the line*/
     tok = trim(tok);
 
     if (strlen(tok) == 0) {/*ignore whitespace line*/
@@ -195,13 +144,13 @@ void parse_line(char *line, byte *type, char tokens[MAX_TOKENS_PER_LINE][MAX_TOK
     } else if (tok[strlen(tok) - 1] == ':') {/*label definition*/
         tok = trim(tok);/*copy label name we are defining*/
         strncpy(tokens[k++], tok, strlen(tok) - 1);
-        tok = strtok(NULL, " ");
+        tok = split_token(NULL, " ", &save);
         *type |= SYM_DEF;/*turn on SYM_DEF bit int the type byte to mark token as label definition*/
     }
 
     if (strncmp(tok, ".extern", 7) == 0) {/*.extern definition*/
         *type |= SYM_EXT;/*turn on SYM_EXT bit int the type byte to mark token as external label*/
-        tok = strtok(NULL, " ");
+        tok = split_token(NULL, " ", &save);
         tok = trim(tok);
         strcpy(tokens[k++], tok);/*copy token string*/
         *num_tokens = k;
@@ -209,7 +158,7 @@ void parse_line(char *line, byte *type, char tokens[MAX_TOKENS_PER_LINE][MAX_TOK
 
     } else if (strncmp(tok, ".entry", 6) == 0) {/*.entry defintion*/
         *type |= SYM_ENT;/*turn on SYM_ENT bit int the type byte to mark token as entry label*/
-        tok = strtok(NULL, " ");
+        tok = split_token(NULL, " ", &save);
         tok = trim(tok);
         strcpy(tokens[k++], tok);/*copy token string*/
         *num_tokens = k;
@@ -217,13 +166,13 @@ void parse_line(char *line, byte *type, char tokens[MAX_TOKENS_PER_LINE][MAX_TOK
 
     } else if (strncmp(tok, ".string", 7) == 0) {/*.string data line*/
         *type |= SYM_STR;/*turn on SYM_STR bit int the type byte to mark token as string data*/
-        tok = strtok(NULL, " ");
+        tok = tok[7] != '\0' ? tok + 7 : split_token(NULL, " ", &save);/*the string may follow .string with no space*/
         tok = trim(tok);
         strncpy(tokens[k++], tok + 1, strlen(tok) - 2);/*copy token string without " chars*/
 
     } else if (strncmp(tok, ".data", 5) == 0) {/*.data data line*/
         *type |= SYM_DAT;/*turn on SYM_DAT bit int the type byte to mark token as data*/
-        tok = strtok(NULL, "\"");
+        tok = split_token(NULL, "\"", &save);
         token_len = 0;
         while (tok != NULL) {/*iterate following tokens and copy each 1 to tokens array*/
             for (i = tok; *tok != '\0'; tok++) {/*iterate word because there maybe more than 1 tokens in 1 word like 23,21,1,7,.. instead of  23, 21, 1, 7,..*/
@@ -240,13 +189,13 @@ void parse_line(char *line, byte *type, char tokens[MAX_TOKENS_PER_LINE][MAX_TOK
             if (i < tok) {
                 strncpy(tokens[k++], i, tok - i);/*make sure not to leave last number behind*/
             }
-            tok = strtok(NULL, " ");/*next token*/
+            tok = split_token(NULL, " ", &save);/*next token*/
         }
 
     } else {/*instruction line*/
         *type |= SYM_COD;/*turn on SYM_STR bit int the type byte to mark token as opcode*/
         strcpy(tokens[k++], tok);/*copy opcode token*/
-        tok = strtok(NULL, " ");/*move to next word in string becuase opcode and operands must have space separating them*/
+        tok = split_token(NULL, " ", &save);/*move to next word in string becuase opcode and operands must have space separating them*/
         if (tok != NULL) {/*iterate over all remaining words in the line and all tokens within each word to fully extract all the operands into individual tokens*/
             while (tok != NULL) {
                 i = tok;
@@ -267,7 +216,7 @@ void parse_line(char *line, byte *type, char tokens[MAX_TOKENS_PER_LINE][MAX_TOK
                     strcpy(tokens[k++], type_val);
                 }
 
-                tok = strtok(NULL, " ");
+                tok = split_token(NULL, " ", &save);
             }
         }
     }
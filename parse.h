@@ -13,15 +13,17 @@
 
 #include "util.h"
 #include "list.h"
+#include "isa.h"
 
 /**
  * Converts line of *!macro expanded!* assembly source code to individual string tokens based on the language
  * specification in the assignment
  *
  * @param line line of assembly source code
+ * @param arena the arena to allocate the list and token strings from, null to use malloc
  * @return list of strings where each string is a token from the line in reverse order
  */
-List* tokenize(char* line);
+List* tokenize(char* line, Arena* arena);
 
 /**
  * Convert's opcode string rep (from source code) to integer number rep based on
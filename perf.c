@@ -0,0 +1,113 @@
+/*
+ * perf.c
+ *
+ *  Created on: Oct 19, 2026
+ */
+#define _DEFAULT_SOURCE /*for syscall*/
+
+#include "perf.h"
+
+const char *perf_event_names[NUM_PERF_EVENTS] = {"cycles", "instructions", "branch_misses", "l1d_misses",
+                                                 "llc_misses", "page_faults"};
+
+#ifdef __linux__
+
+#include <errno.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+/*file descriptor of every event, -1 if it isn't counted*/
+int perf_fds[NUM_PERF_EVENTS] = {-1, -1, -1, -1, -1, -1};
+
+/*type and config of every event, indexed by the PERF_ values*/
+const unsigned int perf_types[NUM_PERF_EVENTS] = {PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+                                                  PERF_TYPE_HW_CACHE, PERF_TYPE_HW_CACHE, PERF_TYPE_SOFTWARE};
+const unsigned long perf_configs[NUM_PERF_EVENTS] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_BRANCH_MISSES,
+        PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+        PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+        PERF_COUNT_SW_PAGE_FAULTS};
+
+int perf_open() {
+    struct perf_event_attr attr;
+    int e, opened, err, failed_err;
+
+    opened = err = 0;
+    for (e = 0; e < NUM_PERF_EVENTS; e++) {
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = perf_types[e];
+        attr.config = perf_configs[e];
+        attr.exclude_kernel = 1;/*allowed at the default paranoid level*/
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        /*threads created after this are counted too, their counts are added in when they are joined*/
+        attr.inherit = 1;
+        perf_fds[e] = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);/*this thread and it's threads on any cpu*/
+        if (perf_fds[e] < 0) {/*no such event on this machine, or not allowed*/
+            failed_err = errno;/*before printing, which may change it*/
+            fprintf(stderr, err == 0 ? "perf: not counting %s" : ", %s", perf_event_names[e]);
+            err = failed_err;
+            perf_fds[e] = -1;
+        } else {
+            opened++;
+        }
+    }
+    if (err != 0) {
+        fprintf(stderr, " (%s)\n", strerror(err));
+    }
+    return opened;
+}
+
+void perf_close() {
+    int e;
+    for (e = 0; e < NUM_PERF_EVENTS; e++) {
+        if (perf_fds[e] >= 0) {
+            close(perf_fds[e]);
+            perf_fds[e] = -1;
+        }
+    }
+}
+
+int perf_available(int event) {
+    return perf_fds[event] >= 0;
+}
+
+void perf_read(double counts[NUM_PERF_EVENTS]) {
+    __u64 values[3];/*the count, the time enabled and the time running*/
+    int e;
+
+    for (e = 0; e < NUM_PERF_EVENTS; e++) {
+        counts[e] = 0;
+        if (perf_fds[e] < 0 || read(perf_fds[e], values, sizeof(values)) != sizeof(values)) {
+            continue;
+        }
+        counts[e] = (double) values[0];
+        if (values[2] > 0 && values[2] < values[1]) {/*the event shared a hardware counter with others*/
+            counts[e] *= (double) values[1] / (double) values[2];
+        }
+    }
+}
+
+#else /*no perf_event_open, nothing is counted*/
+
+int perf_open() {
+    fprintf(stderr, "perf: counters are only available on linux\n");
+    return 0;
+}
+
+void perf_close() {
+}
+
+int perf_available(int event) {
+    return 0;
+}
+
+void perf_read(double counts[NUM_PERF_EVENTS]) {
+    memset(counts, 0, NUM_PERF_EVENTS * sizeof(double));
+}
+
+#endif
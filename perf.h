@@ -0,0 +1,61 @@
+/*
+ * perf.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  hardware and software event counters of the assembler process, read with perf_event_open on linux.
+ *  every event is opened on it's own so a machine missing some of them, or a kernel that doesn't allow
+ *  them, still counts the rest. events that can't be opened are left out of the output. the counters are
+ *  opened before any thread is created and are inherited by every thread, a thread's counts show up once it's
+ *  joined
+ */
+
+#ifndef PERF_H
+#define PERF_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PERF_CYCLES 0
+#define PERF_INSTRUCTIONS 1
+#define PERF_BRANCH_MISSES 2
+#define PERF_L1D_MISSES 3 /*level 1 data cache read misses*/
+#define PERF_LLC_MISSES 4 /*last level cache read misses*/
+#define PERF_PAGE_FAULTS 5
+#define NUM_PERF_EVENTS 6
+
+/*names of the events in the output, indexed by the PERF_ values*/
+extern const char *perf_event_names[NUM_PERF_EVENTS];
+
+/**
+ * Opens the counters of every event for the calling thread and the threads it creates later, counting only
+ * user space so it works for unprivileged users. must be called before any thread is created. events that
+ * can't be opened are reported to stderr once
+ *
+ * @return the number of events opened
+ */
+int perf_open();
+
+/**
+ * Closes the counters
+ */
+void perf_close();
+
+/**
+ * Checks if an event is counted
+ *
+ * @param event one of the PERF_ values
+ * @return 1 if the event was opened, 0 otherwise
+ */
+int perf_available(int event);
+
+/**
+ * Reads the counters, scaled up for the time an event wasn't on the hardware when there were more events
+ * than hardware counters
+ *
+ * @param counts an array of NUM_PERF_EVENTS to put the counts in, 0 for events not counted
+ */
+void perf_read(double counts[NUM_PERF_EVENTS]);
+
+#endif /* PERF_H */
@@ -0,0 +1,325 @@
+/*
+ * pipeline.c
+ *
+ *  Created on: Oct 19, 2026
+ */
+#define _POSIX_C_SOURCE 200112L /*for pthreads and sched_yield*/
+
+#include <sched.h>
+
+#include "pipeline.h"
+
+/**
+ * ValidateStage struct
+ *
+ * Holds the rings and result of the validation thread
+ */
+typedef struct {
+    RingReader rd; /*reads the expanded lines*/
+    LineRing *out; /*the valid lines are passed on to the addressing thread through it*/
+    byte is_valid;
+} ValidateStage;
+
+/**
+ * AddressStage struct
+ *
+ * Holds the ring, symbol table and counters of the addressing thread
+ */
+typedef struct {
+    RingReader rd; /*reads the validated lines*/
+    SymbolTable *symbols;
+    unsigned int ic, dc;
+} AddressStage;
+
+LineRing *new_line_ring(unsigned long records) {
+    LineRing *ring;
+    ring = mem_alloc(MEM_STREAM, sizeof(LineRing));
+    ring->records = mem_alloc(MEM_STREAM, records * sizeof(LineRecord));
+    ring->mask = records - 1;
+    ring->head = ring->tail = 0;
+    ring->closed = 0;
+    ring->sleepers = 0;
+    pthread_mutex_init(&ring->lock, NULL);
+    pthread_cond_init(&ring->wake, NULL);
+    return ring;
+}
+
+void free_line_ring(LineRing *ring) {
+    if (ring == NULL)/*make sure we got a ring*/
+        return;
+    pthread_mutex_destroy(&ring->lock);
+    pthread_cond_destroy(&ring->wake);
+    mem_free(ring->records);
+    mem_free(ring);
+}
+
+/**
+ * Checks if a ring has room for a record, for the producer
+ *
+ * @param ring the ring
+ * @return 1 if a record can be pushed, 0 if the ring is full
+ */
+int ring_has_room(LineRing *ring) {
+    return ring->head - __atomic_load_n(&ring->tail, __ATOMIC_SEQ_CST) <= ring->mask;
+}
+
+/**
+ * Checks if a ring has a record to read or was closed, for the consumer
+ *
+ * @param ring the ring
+ * @return 1 if a record can be read or none will come, 0 if the ring is empty and the producer isn't done
+ */
+int ring_has_record(LineRing *ring) {
+    return __atomic_load_n(&ring->head, __ATOMIC_SEQ_CST) != ring->tail ||
+           __atomic_load_n(&ring->closed, __ATOMIC_SEQ_CST);
+}
+
+/**
+ * Waits until a ring is ready for the calling side. the other thread is usually about to catch up so the
+ * thread yields to it a few times first, then it sleeps until the other side wakes it
+ *
+ * @param ring the ring
+ * @param ready checks if the ring is ready, ring_has_room or ring_has_record
+ */
+void ring_wait(LineRing *ring, int (*ready)(LineRing *)) {
+    int spins;
+    for (spins = 0; spins < RING_SPINS; spins++) {
+        if (ready(ring)) {
+            return;
+        }
+        sched_yield();
+    }
+    pthread_mutex_lock(&ring->lock);
+    /*announced before checking again, so the other side either made the ring ready before the check or sees
+     * the sleeper after changing it and wakes it under the lock*/
+    __atomic_add_fetch(&ring->sleepers, 1, __ATOMIC_SEQ_CST);
+    while (!ready(ring)) {
+        pthread_cond_wait(&ring->wake, &ring->lock);
+    }
+    __atomic_sub_fetch(&ring->sleepers, 1, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&ring->lock);
+}
+
+/**
+ * Wakes the thread asleep on a ring after the calling side changed it, if there is one
+ *
+ * @param ring the ring
+ */
+void ring_wake(LineRing *ring) {
+    if (__atomic_load_n(&ring->sleepers, __ATOMIC_SEQ_CST) > 0) {
+        pthread_mutex_lock(&ring->lock);
+        pthread_cond_broadcast(&ring->wake);
+        pthread_mutex_unlock(&ring->lock);
+    }
+}
+
+void ring_push(LineRing *ring, const char *text, unsigned long len) {
+    LineRecord *rec;
+    unsigned long head, n;
+    do {
+        if (!ring_has_room(ring)) {/*full, let the consumer catch up*/
+            ring_wait(ring, ring_has_room);
+        }
+        head = ring->head;
+        rec = &ring->records[head & ring->mask];
+        n = len < LINE_SIZE ? len : LINE_SIZE;
+        memcpy(rec->text, text, n);
+        rec->len = n;
+        __atomic_store_n(&ring->head, head + 1, __ATOMIC_SEQ_CST);/*the record is written before it's published*/
+        ring_wake(ring);
+        text += n;
+        len -= n;
+    } while (len > 0);
+}
+
+void ring_close(LineRing *ring) {
+    __atomic_store_n(&ring->closed, 1, __ATOMIC_SEQ_CST);
+    ring_wake(ring);
+}
+
+/**
+ * Waits for the record at the tail of a ring
+ *
+ * @param ring the ring
+ * @return the record, null once the ring is closed and empty
+ */
+LineRecord *ring_peek(LineRing *ring) {
+    if (!ring_has_record(ring)) {/*empty, let the producer catch up*/
+        ring_wait(ring, ring_has_record);
+    }
+    /*closed with nothing left. the last records may have been pushed between reading head and closed*/
+    if (__atomic_load_n(&ring->head, __ATOMIC_SEQ_CST) == ring->tail) {
+        return NULL;
+    }
+    return &ring->records[ring->tail & ring->mask];
+}
+
+/**
+ * Frees the record at the tail of a ring for the producer
+ *
+ * @param ring the ring
+ */
+void ring_pop(LineRing *ring) {
+    __atomic_store_n(&ring->tail, ring->tail + 1, __ATOMIC_SEQ_CST);/*the record is read before it's given back*/
+    ring_wake(ring);
+}
+
+char *ring_gets(char *buf, int size, RingReader *rd) {
+    LineRecord *rec;
+    unsigned long len;
+    char *newline;
+    int n;
+
+    n = 0;
+    /*records are copied until a newline like ls_gets copies stored lines, a record may lack one if the line
+     * was longer than the buffer it was read with, in which case the next record continues it*/
+    while (n < size - 1 && (rec = ring_peek(rd->ring)) != NULL) {
+        len = rec->len - rd->pos;
+        if (len > (unsigned long) (size - 1 - n)) {/*take no more than the buffer has room for*/
+            len = size - 1 - n;
+        }
+        newline = memchr(rec->text + rd->pos, '\n', len);/*stop after a newline*/
+        if (newline != NULL) {
+            len = newline - (rec->text + rd->pos) + 1;
+        }
+        memcpy(buf + n, rec->text + rd->pos, len);
+        n += len;
+        rd->pos += len;
+        if (rd->pos == rec->len) {/*done with the record, move to the next one*/
+            ring_pop(rd->ring);
+            rd->pos = 0;
+        }
+        if (n > 0 && buf[n - 1] == '\n') {
+            break;
+        }
+    }
+    if (n == 0) {
+        return NULL;
+    }
+    buf[n] = '\0';
+    return buf;
+}
+
+/**
+ * Line stream tap that pushes the expanded lines to a ring
+ *
+ * @param arg the ring
+ * @param line the line
+ * @param len the number of characters
+ */
+void push_expanded(void *arg, const char *line, unsigned long len) {
+    ring_push((LineRing *) arg, line, len);
+}
+
+/**
+ * Thread function that validates the expanded lines, the same way validate_code does
+ *
+ * @param arg the ValidateStage
+ * @return null
+ */
+void *validate_stage(void *arg) {
+    ValidateStage *st;
+    char line[VALIDATE_LINE_SIZE], copy[VALIDATE_LINE_SIZE];/*the line is tokenized in place, the copy is passed on*/
+    Arena *scratch;/*memory for the tokens of the current line*/
+    unsigned int line_num;
+    double start;
+
+    st = (ValidateStage *) arg;
+    start = trace_now();
+    scratch = new_arena(TOKENS_ARENA_SIZE);
+    line_num = 1;/*start counting lines from 1*/
+    st->is_valid = 1;
+    while (ring_gets(line, sizeof(line), &st->rd)) {
+        strcpy(copy, line);
+        if (!validate_line(line, &line_num, scratch)) {
+            st->is_valid = 0;
+        }
+        if (st->is_valid) {/*after an error the lines may be anything, addressing isn't needed anymore*/
+            ring_push(st->out, copy, strlen(copy));
+        }
+    }
+    free_arena(scratch);
+    ring_close(st->out);
+    trace_span("validate", NULL, start);
+    return NULL;
+}
+
+/**
+ * Thread function that addresses the validated lines, the same way address_labels does
+ *
+ * @param arg the AddressStage
+ * @return null
+ */
+void *address_stage(void *arg) {
+    AddressStage *st;
+    char line[LINE_SIZE], tokens[MAX_TOKENS_PER_LINE][MAX_TOKEN_LEN];
+    int num_tokens;
+    byte type;
+    double start;
+
+    st = (AddressStage *) arg;
+    start = trace_now();
+    st->ic = st->dc = 0;
+    while (ring_gets(line, sizeof(line), &st->rd)) {
+        memset(tokens, 0, sizeof(tokens));/*zero all tokens so as not to get contaminents from previous lines*/
+        parse_line(line, &type, tokens, &num_tokens);
+        address_line(st->symbols, type, tokens, num_tokens, &st->ic, &st->dc);
+    }
+    trace_span("address", NULL, start);
+    return NULL;
+}
+
+int pipeline_first_pass(const char *in_file_path, LineStream *lines, HashTable *macro_table, SymbolTable *symbols,
+                        unsigned int *ic, unsigned int *dc, byte *is_valid) {
+    LineRing *expanded, *validated;
+    ValidateStage vs;
+    AddressStage as;
+    pthread_t validate_thread, address_thread;
+    int result;
+    double start;
+
+    expanded = new_line_ring(RING_RECORDS);
+    validated = new_line_ring(RING_RECORDS);
+    vs.rd.ring = expanded;
+    vs.rd.pos = 0;
+    vs.out = validated;
+    as.rd.ring = validated;
+    as.rd.pos = 0;
+    as.symbols = symbols;
+
+    /*the last stage first, so a stage always has someone to empty it's ring*/
+    result = -1;
+    if (pthread_create(&address_thread, NULL, address_stage, &as) != 0) {
+        free_line_ring(expanded);
+        free_line_ring(validated);
+        return result;
+    }
+    if (pthread_create(&validate_thread, NULL, validate_stage, &vs) != 0) {
+        ring_close(validated);/*nothing will come, let the addressing thread finish*/
+        pthread_join(address_thread, NULL);
+        free_line_ring(expanded);
+        free_line_ring(validated);
+        return result;
+    }
+
+    start = trace_now();
+    lines->tap = push_expanded;
+    lines->tap_arg = expanded;
+    result = expand_macros(in_file_path, lines, macro_table);
+    lines->tap = NULL;
+    lines->tap_arg = NULL;
+    ring_close(expanded);
+    trace_span("macros", NULL, start);
+
+    pthread_join(validate_thread, NULL);
+    pthread_join(address_thread, NULL);
+    /*data goes after the code*/
+    relocate_data_labels(symbols, as.ic);
+    *ic = as.ic;
+    *dc = as.dc;
+    *is_valid = vs.is_valid;
+
+    free_line_ring(expanded);
+    free_line_ring(validated);
+    return result;
+}
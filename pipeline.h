@@ -0,0 +1,137 @@
+/*
+ * pipeline.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  the first pass as a pipeline of three threads, so the phases overlap on one big file. macros are expanded on
+ *  the calling thread, the expanded lines are validated on a second thread and addressed on a third. the threads
+ *  are connected by single producer single consumer rings of line records, passed without locks. a full ring makes
+ *  the thread that fills it wait so memory stays bounded no matter which stage is slow. a thread waiting on a full
+ *  or empty ring yields a few times, then sleeps until the other side wakes it. the validation thread is the
+ *  only one that prints and it reads the lines in order, so the errors come out as they do without the pipeline.
+ *  lines are only passed on to addressing until the first error, like an invalid file isn't addressed at all
+ */
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "util.h"
+#include "hashtable.h"
+#include "symtab.h"
+#include "stream.h"
+#include "macro.h"
+#include "validate.h"
+#include "address.h"
+#include "arena.h"
+#include "mem.h"
+#include "trace.h"
+
+#define RING_RECORDS 1024 /*records a ring holds, a power of 2*/
+#define RING_PAD 64 /*bytes of a cache line, the ends of a ring are kept on lines of their own*/
+#define RING_SPINS 64 /*times a thread yields on a full or empty ring before it goes to sleep*/
+
+/**
+ * LineRecord struct
+ *
+ * Holds a line of the expanded source as it's stored in the line stream
+ */
+typedef struct {
+    unsigned int len; /*number of characters in text*/
+    char text[LINE_SIZE]; /*not null terminated*/
+} LineRecord;
+
+/**
+ * LineRing struct
+ *
+ * Holds the records passed from one thread to the next
+ */
+typedef struct {
+    LineRecord *records;
+    unsigned long mask; /*number of records minus one*/
+    char pad0[RING_PAD];
+    unsigned long head; /*records pushed, written by the producer only*/
+    char pad1[RING_PAD];
+    unsigned long tail; /*records popped, written by the consumer only*/
+    char pad2[RING_PAD];
+    int closed; /*set by the producer after the last record*/
+    char pad3[RING_PAD];
+    int sleepers; /*threads asleep on the ring or about to be, only then does the other side take the lock*/
+    pthread_mutex_t lock; /*guards the sleeping, never the records*/
+    pthread_cond_t wake; /*signalled when a record is pushed or popped or the ring is closed*/
+} LineRing;
+
+/**
+ * RingReader struct
+ *
+ * Holds the position of a consumer in the records of a ring
+ */
+typedef struct {
+    LineRing *ring;
+    unsigned long pos; /*characters of the record at the tail already read*/
+} RingReader;
+
+/**
+ * Creates an empty ring
+ *
+ * @param records the number of records, a power of 2
+ * @return the new ring
+ */
+LineRing *new_line_ring(unsigned long records);
+
+/**
+ * Frees a ring
+ *
+ * @param ring the ring to free
+ */
+void free_line_ring(LineRing *ring);
+
+/**
+ * Pushes a line to a ring, waiting for room if it's full. called by the producer only
+ *
+ * @param ring the ring
+ * @param text the line, longer lines than a record holds take several records
+ * @param len the number of characters
+ */
+void ring_push(LineRing *ring, const char *text, unsigned long len);
+
+/**
+ * Marks the end of the records of a ring. called by the producer only
+ *
+ * @param ring the ring
+ */
+void ring_close(LineRing *ring);
+
+/**
+ * Reads the records of a ring like fgets reads a file, waiting for records if it's empty. called by the
+ * consumer only
+ *
+ * @param buf the buffer to read into
+ * @param size the size of the buffer
+ * @param rd the reader
+ * @return buf, null once the ring is closed and every record was read
+ */
+char *ring_gets(char *buf, int size, RingReader *rd);
+
+/**
+ * Expands the macros of a file into a line stream, validates it and fills the symbol table from it at the same
+ * time, like expand_macros followed by validate_code and address_labels do
+ *
+ * @param in_file_path path to assembly file to expand
+ * @param lines an empty line stream to expand the file into
+ * @param macro_table an empty table to put the ids of the defined macros in
+ * @param symbols an empty symbol table to fill
+ * @param ic a reference to put the IC counter in
+ * @param dc a reference to put the DC counter in
+ * @param is_valid a byte reference to put the is_valid flag in
+ * @return 1 if the file was expanded, 0 if it couldn't be opened, -1 if the threads couldn't be started and
+ * nothing was done
+ */
+int pipeline_first_pass(const char *in_file_path, LineStream *lines, HashTable *macro_table, SymbolTable *symbols,
+                        unsigned int *ic, unsigned int *dc, byte *is_valid);
+
+#endif /* PIPELINE_H */
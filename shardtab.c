@@ -0,0 +1,113 @@
+/*
+ * shardtab.c
+ *
+ *  Created on: Oct 19, 2026
+ */
+#define _POSIX_C_SOURCE 200112L /*for reader writer locks*/
+
+#include "shardtab.h"
+
+ShardedTable *new_sharded_table(unsigned int num_shards) {
+    ShardedTable *t;
+    unsigned int i, bits;
+
+    t = mem_alloc(MEM_SYMBOLS, sizeof(ShardedTable));
+    bits = 0;
+    while ((1u << bits) < num_shards && bits < 16) {
+        bits++;
+    }
+    t->num_shards = 1u << bits;
+    t->shift = SHARDTAB_HASH_BITS - bits;
+    t->shards = mem_alloc(MEM_SYMBOLS, t->num_shards * sizeof(SymbolShard));
+    for (i = 0; i < t->num_shards; i++) {
+        pthread_rwlock_init(&t->shards[i].lock, NULL);
+        t->shards[i].table = new_symbol_table();
+    }
+    return t;
+}
+
+void free_sharded_table(ShardedTable *t) {
+    unsigned int i;
+    if (t == NULL)/*make sure we got a table*/
+        return;
+    for (i = 0; i < t->num_shards; i++) {
+        pthread_rwlock_destroy(&t->shards[i].lock);
+        free_symbol_table(t->shards[i].table);
+    }
+    mem_free(t->shards);
+    mem_free(t);
+}
+
+/**
+ * Finds the shard a name belongs to. the hash is multiplied by the golden ratio so every bit of it reaches
+ * the high bits of the low 32, which the shard is taken from. the high bits of the hash alone are 0 for
+ * short names, and the low bits pick the slot in the shard's table
+ *
+ * @param t the table
+ * @param name the name
+ * @return the shard
+ */
+SymbolShard *sht_shard(ShardedTable *t, const char *name) {
+    unsigned long mixed;
+    mixed = (st_hash(name) * SHARDTAB_MIX) & SHARDTAB_HASH_MASK;
+    return &t->shards[t->num_shards > 1 ? mixed >> t->shift : 0];
+}
+
+int sht_define(ShardedTable *t, const char *name, int addr, byte type) {
+    SymbolShard *shard;
+    unsigned int id;
+    int result;
+
+    shard = sht_shard(t, name);
+    pthread_rwlock_wrlock(&shard->lock);
+    /*checked and defined under the same lock, no other thread can define it in between*/
+    id = st_intern(shard->table, name, addr, 0);
+    if (shard->table->types[id] & SYM_DEF) {
+        result = SHARDTAB_DUPLICATE;
+    } else {
+        shard->table->types[id] |= type | SYM_DEF;
+        shard->table->addrs[id] = addr;
+        result = SHARDTAB_DEFINED;
+    }
+    pthread_rwlock_unlock(&shard->lock);
+    return result;
+}
+
+void sht_declare(ShardedTable *t, const char *name, byte type) {
+    SymbolShard *shard;
+    unsigned int id;
+
+    shard = sht_shard(t, name);
+    pthread_rwlock_wrlock(&shard->lock);
+    id = st_intern(shard->table, name, 0, 0);
+    shard->table->types[id] |= type;
+    pthread_rwlock_unlock(&shard->lock);
+}
+
+int sht_find(ShardedTable *t, const char *name, int *addr, byte *type) {
+    SymbolShard *shard;
+    int id;
+
+    shard = sht_shard(t, name);
+    pthread_rwlock_rdlock(&shard->lock);/*any number of threads look up at once*/
+    id = st_find(shard->table, name);
+    if (id != SYMTAB_NO_SYMBOL) {
+        if (addr != NULL) {
+            *addr = shard->table->addrs[id];
+        }
+        if (type != NULL) {
+            *type = shard->table->types[id];
+        }
+    }
+    pthread_rwlock_unlock(&shard->lock);
+    return id != SYMTAB_NO_SYMBOL;
+}
+
+unsigned int sht_count(ShardedTable *t) {
+    unsigned int i, n;
+    n = 0;
+    for (i = 0; i < t->num_shards; i++) {
+        n += t->shards[i].table->num_symbols;
+    }
+    return n;
+}
@@ -0,0 +1,116 @@
+/*
+ * shardtab.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  a symbol table several threads can define and look up labels in at once. the names are split between
+ *  shards by the high bits of their mixed hash, every shard is a symbol table of it's own behind a reader writer
+ *  lock, so threads only wait for each other when they touch labels of the same shard and lookups only wait
+ *  for definitions. a label is defined at most once, the check and the definition happen under the same lock
+ *
+ *  the assembler doesn't use it. the chunks of the threaded first pass only know their addresses once the chunks
+ *  before them are counted, and when a label is defined twice or declared external the source order decides
+ *  what it ends up as, so the labels are added to one SymbolTable after the threads are done, in order. the
+ *  passes after that read the table without locks. it's kept for tools that fill a table from many threads,
+ *  symbench measures it
+ */
+
+#ifndef SHARDTAB_H
+#define SHARDTAB_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "util.h"
+#include "symtab.h"
+#include "mem.h"
+
+#define SHARDTAB_SHARDS 64 /*default number of shards*/
+#define SHARDTAB_PAD 64 /*bytes between the locks of neighbouring shards, the size of a cache line*/
+#define SHARDTAB_MIX 0x9E3779B9UL /*2^32 divided by the golden ratio, mixes a hash before it picks the shard*/
+#define SHARDTAB_HASH_BITS 32 /*bits of the mixed hash, an unsigned long has at least 32*/
+#define SHARDTAB_HASH_MASK 0xFFFFFFFFUL
+
+#define SHARDTAB_DEFINED 1 /*returned when a label is defined for the first time*/
+#define SHARDTAB_DUPLICATE 0 /*returned when a label was already defined*/
+
+/**
+ * SymbolShard struct
+ *
+ * Holds the labels of one shard and the lock that guards them
+ */
+typedef struct {
+    pthread_rwlock_t lock;
+    SymbolTable *table;
+    char pad[SHARDTAB_PAD]; /*keeps threads working on different shards off each other's cache lines*/
+} SymbolShard;
+
+/**
+ * ShardedTable struct
+ *
+ * Holds the shards of a concurrent symbol table
+ */
+typedef struct {
+    SymbolShard *shards;
+    unsigned int num_shards; /*a power of 2*/
+    unsigned int shift; /*how far the mixed hash of a name is shifted to get it's shard*/
+} ShardedTable;
+
+/**
+ * Creates an empty concurrent symbol table
+ *
+ * @param num_shards the number of shards, rounded up to a power of 2. 1 makes a table with a single lock
+ * @return the new table
+ */
+ShardedTable *new_sharded_table(unsigned int num_shards);
+
+/**
+ * Frees a concurrent symbol table, no thread may use it anymore
+ *
+ * @param t the table to free
+ */
+void free_sharded_table(ShardedTable *t);
+
+/**
+ * Defines a label, unless it's already defined. when several threads define the same label exactly one of
+ * them gets SHARDTAB_DEFINED
+ *
+ * @param t the table
+ * @param name the name of the label
+ * @param addr the address of the label
+ * @param type the SYM_ bits of the label, SYM_DEF is added to them
+ * @return SHARDTAB_DEFINED if the label was defined, SHARDTAB_DUPLICATE if it was defined before and is left as is
+ */
+int sht_define(ShardedTable *t, const char *name, int addr, byte type);
+
+/**
+ * Declares a label entry or external without defining it, adding the label if it's not in the table
+ *
+ * @param t the table
+ * @param name the name of the label
+ * @param type the SYM_ bits to turn on
+ */
+void sht_declare(ShardedTable *t, const char *name, byte type);
+
+/**
+ * Looks a label up
+ *
+ * @param t the table
+ * @param name the name of the label
+ * @param addr reference to put the address in, may be null
+ * @param type reference to put the SYM_ bits in, may be null
+ * @return 1 if the label is in the table, 0 otherwise
+ */
+int sht_find(ShardedTable *t, const char *name, int *addr, byte *type);
+
+/**
+ * Counts the labels in the table, no thread may change it meanwhile
+ *
+ * @param t the table
+ * @return the number of labels
+ */
+unsigned int sht_count(ShardedTable *t);
+
+#endif /* SHARDTAB_H */
@@ -0,0 +1,270 @@
+/*
+ * stats.c
+ *
+ *  Created on: Oct 19, 2026
+ */
+#define _POSIX_C_SOURCE 200112L /*for clock_gettime*/
+
+#include <time.h>
+
+#include "stats.h"
+
+unsigned long stat_counters[NUM_COUNTERS];
+
+/*names of the phases and counters in the output, indexed by PHASE_ and STAT_ values*/
+const char *phase_names[NUM_PHASES] = {"macros", "validate", "address", "assemble"};
+const char *counter_names[NUM_COUNTERS] = {"lines", "tokens", "symbols", "words", "bytes"};
+
+Stats *new_stats() {
+    Stats *stats;
+    stats = malloc(sizeof(Stats));
+    stats->cap = 16;
+    stats->num_files = 0;
+    stats->files = malloc(stats->cap * sizeof(FileStats));
+    return stats;
+}
+
+void free_stats(Stats *stats) {
+    free(stats->files);
+    free(stats);
+}
+
+FileStats *stats_begin_file(Stats *stats, const char *name) {
+    FileStats *fs;
+    if (stats->num_files == stats->cap) {
+        stats->cap *= 2;
+        stats->files = realloc(stats->files, stats->cap * sizeof(FileStats));
+    }
+    fs = &stats->files[stats->num_files++];
+    memset(fs, 0, sizeof(FileStats));
+    strncpy(fs->name, name, MAX_FILE_PATH - 1);
+    memset(stat_counters, 0, sizeof(stat_counters));
+    return fs;
+}
+
+void stats_end_file(FileStats *fs) {
+    memcpy(fs->counters, stat_counters, sizeof(stat_counters));
+}
+
+void stat_clock(StatClock *clk) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    clk->wall = ts.tv_sec + ts.tv_nsec / 1e9;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    clk->cpu = ts.tv_sec + ts.tv_nsec / 1e9;
+    perf_read(clk->perf);
+}
+
+void stat_lap(FileStats *fs, int phase, StatClock *clk) {
+    StatClock now;
+    int e;
+    stat_clock(&now);
+    fs->wall[phase] += now.wall - clk->wall;
+    fs->cpu[phase] += now.cpu - clk->cpu;
+    for (e = 0; e < NUM_PERF_EVENTS; e++) {
+        fs->perf[phase][e] += now.perf[e] - clk->perf[e];
+    }
+    *clk = now;
+}
+
+int find_stats_format(const char *name) {
+    if (strcmp(name, "table") == 0) {
+        return STATS_TABLE;
+    }
+    if (strcmp(name, "json") == 0) {
+        return STATS_JSON;
+    }
+    if (strcmp(name, "prom") == 0) {
+        return STATS_PROM;
+    }
+    return -1;
+}
+
+void print_quoted(const char *s, FILE *out) {
+    fputc('"', out);
+    for (; *s != '\0'; s++) {
+        if (*s == '"' || *s == '\\') {
+            fputc('\\', out);
+        }
+        fputc(*s, out);
+    }
+    fputc('"', out);
+}
+
+/**
+ * Writes the event counts of every phase as a table, nothing if no event was counted
+ *
+ * @param stats the stats
+ * @param out the file to write to
+ */
+void print_perf_table(const Stats *stats, FILE *out) {
+    const FileStats *fs;
+    unsigned int i;
+    int p, e, counted;
+
+    counted = 0;
+    for (e = 0; e < NUM_PERF_EVENTS; e++) {
+        counted += perf_available(e);
+    }
+    if (counted == 0) {
+        return;
+    }
+    fprintf(out, "\n%-24s %-10s", "file", "phase");
+    for (e = 0; e < NUM_PERF_EVENTS; e++) {
+        if (perf_available(e)) {
+            fprintf(out, " %14s", perf_event_names[e]);
+        }
+    }
+    fputc('\n', out);
+    for (i = 0; i < stats->num_files; i++) {
+        fs = &stats->files[i];
+        for (p = 0; p < NUM_PHASES; p++) {
+            fprintf(out, "%-24s %-10s", fs->name, phase_names[p]);
+            for (e = 0; e < NUM_PERF_EVENTS; e++) {
+                if (perf_available(e)) {
+                    fprintf(out, " %14.0f", fs->perf[p][e]);
+                }
+            }
+            fputc('\n', out);
+        }
+    }
+}
+
+/**
+ * Writes the stats as tables, the times of the phases, the counters and the event counts
+ *
+ * @param stats the stats
+ * @param out the file to write to
+ */
+void print_stats_table(const Stats *stats, FILE *out) {
+    const FileStats *fs;
+    unsigned int i;
+    int p, c;
+    double wall, cpu;
+
+    fprintf(out, "%-24s %-10s %12s %12s\n", "file", "phase", "wall ms", "cpu ms");
+    for (i = 0; i < stats->num_files; i++) {
+        fs = &stats->files[i];
+        wall = cpu = 0;
+        for (p = 0; p < NUM_PHASES; p++) {
+            fprintf(out, "%-24s %-10s %12.3f %12.3f\n", fs->name, phase_names[p], fs->wall[p] * 1e3, fs->cpu[p] * 1e3);
+            wall += fs->wall[p];
+            cpu += fs->cpu[p];
+        }
+        fprintf(out, "%-24s %-10s %12.3f %12.3f\n", fs->name, "total", wall * 1e3, cpu * 1e3);
+    }
+    fprintf(out, "\n%-24s", "file");
+    for (c = 0; c < NUM_COUNTERS; c++) {
+        fprintf(out, " %12s", counter_names[c]);
+    }
+    fputc('\n', out);
+    for (i = 0; i < stats->num_files; i++) {
+        fs = &stats->files[i];
+        fprintf(out, "%-24s", fs->name);
+        for (c = 0; c < NUM_COUNTERS; c++) {
+            fprintf(out, " %12lu", fs->counters[c]);
+        }
+        fputc('\n', out);
+    }
+    print_perf_table(stats, out);
+}
+
+/**
+ * Writes the stats as a JSON object with an array of files, times are in seconds
+ *
+ * @param stats the stats
+ * @param out the file to write to
+ */
+void print_stats_json(const Stats *stats, FILE *out) {
+    const FileStats *fs;
+    unsigned int i;
+    int p, c, e;
+
+    fputs("{\"files\":[", out);
+    for (i = 0; i < stats->num_files; i++) {
+        fs = &stats->files[i];
+        fputs(i == 0 ? "{\"name\":" : ",{\"name\":", out);
+        print_quoted(fs->name, out);
+        fputs(",\"phases\":{", out);
+        for (p = 0; p < NUM_PHASES; p++) {
+            fprintf(out, "%s\"%s\":{\"wall\":%.9f,\"cpu\":%.9f", p == 0 ? "" : ",", phase_names[p], fs->wall[p], fs->cpu[p]);
+            for (e = 0; e < NUM_PERF_EVENTS; e++) {/*only the events counted*/
+                if (perf_available(e)) {
+                    fprintf(out, ",\"%s\":%.0f", perf_event_names[e], fs->perf[p][e]);
+                }
+            }
+            fputc('}', out);
+        }
+        fputs("},\"counters\":{", out);
+        for (c = 0; c < NUM_COUNTERS; c++) {
+            fprintf(out, "%s\"%s\":%lu", c == 0 ? "" : ",", counter_names[c], fs->counters[c]);
+        }
+        fputs("}}", out);
+    }
+    fputs("]}\n", out);
+}
+
+/**
+ * Writes the stats in prometheus text format, a sample per file and phase, event or counter
+ *
+ * @param stats the stats
+ * @param out the file to write to
+ */
+void print_stats_prom(const Stats *stats, FILE *out) {
+    const FileStats *fs;
+    unsigned int i;
+    int p, c, e, cpu;
+
+    for (cpu = 0; cpu < 2; cpu++) {
+        fprintf(out, "# HELP assembler_phase_%s_seconds %s time of a phase of assembling a file\n",
+                cpu ? "cpu" : "wall", cpu ? "CPU" : "Wall");
+        fprintf(out, "# TYPE assembler_phase_%s_seconds gauge\n", cpu ? "cpu" : "wall");
+        for (i = 0; i < stats->num_files; i++) {
+            fs = &stats->files[i];
+            for (p = 0; p < NUM_PHASES; p++) {
+                fprintf(out, "assembler_phase_%s_seconds{file=", cpu ? "cpu" : "wall");
+                print_quoted(fs->name, out);
+                fprintf(out, ",phase=\"%s\"} %.9f\n", phase_names[p], cpu ? fs->cpu[p] : fs->wall[p]);
+            }
+        }
+    }
+    for (e = 0; e < NUM_PERF_EVENTS; e++) {
+        if (!perf_available(e)) {
+            continue;
+        }
+        fprintf(out, "# HELP assembler_phase_%s Number of %s of a phase of assembling a file\n", perf_event_names[e],
+                perf_event_names[e]);
+        fprintf(out, "# TYPE assembler_phase_%s gauge\n", perf_event_names[e]);
+        for (i = 0; i < stats->num_files; i++) {
+            fs = &stats->files[i];
+            for (p = 0; p < NUM_PHASES; p++) {
+                fprintf(out, "assembler_phase_%s{file=", perf_event_names[e]);
+                print_quoted(fs->name, out);
+                fprintf(out, ",phase=\"%s\"} %.0f\n", phase_names[p], fs->perf[p][e]);
+            }
+        }
+    }
+    for (c = 0; c < NUM_COUNTERS; c++) {
+        fprintf(out, "# HELP assembler_%s Number of %s of assembling a file\n", counter_names[c], counter_names[c]);
+        fprintf(out, "# TYPE assembler_%s gauge\n", counter_names[c]);
+        for (i = 0; i < stats->num_files; i++) {
+            fs = &stats->files[i];
+            fprintf(out, "assembler_%s{file=", counter_names[c]);
+            print_quoted(fs->name, out);
+            fprintf(out, "} %lu\n", fs->counters[c]);
+        }
+    }
+}
+
+void print_stats(const Stats *stats, int format, FILE *out) {
+    switch (format) {
+        case STATS_JSON:
+            print_stats_json(stats, out);
+            break;
+        case STATS_PROM:
+            print_stats_prom(stats, out);
+            break;
+        default:
+            print_stats_table(stats, out);
+    }
+}
@@ -0,0 +1,150 @@
+/*
+ * stats.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  wall and cpu time of every phase of assembling a file, and counters of what the phases did.
+ *  counting is an addition and timing is a clock read per phase, so both are always on and --stats
+ *  only decides if they are printed. with --perf the clock readings also read the event counters of perf.h
+ */
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "util.h"
+#include "perf.h"
+
+#define PHASE_MACROS 0 /*expand_macros and writing the .am file, the whole first pass when it's pipelined*/
+#define PHASE_VALIDATE 1 /*validate_code*/
+#define PHASE_ADDRESS 2 /*address_labels, part of the assemble phase in one pass assembly*/
+#define PHASE_ASSEMBLE 3 /*assemble_code or assemble_one_pass*/
+#define NUM_PHASES 4
+
+#define STAT_LINES 0 /*source lines read*/
+#define STAT_TOKENS 1 /*tokens produced by validation*/
+#define STAT_SYMBOLS 2 /*labels defined or declared external*/
+#define STAT_WORDS 3 /*words written to the object file*/
+#define STAT_BYTES 4 /*bytes written to the .am, .ob, .ent and .ext files*/
+#define NUM_COUNTERS 5
+
+#define STATS_TABLE 0 /*print a table for people*/
+#define STATS_JSON 1 /*print one JSON object*/
+#define STATS_PROM 2 /*print prometheus text format, for a textfile collector*/
+
+/*counts an event of the file being assembled*/
+#define STAT_ADD(counter, n) (stat_counters[counter] += (n))
+
+/*the counters of the file being assembled*/
+extern unsigned long stat_counters[NUM_COUNTERS];
+
+/**
+ * StatClock struct
+ *
+ * Holds a reading of the wall and cpu clocks in seconds, and of the event counters
+ */
+typedef struct {
+    double wall;
+    double cpu;
+    double perf[NUM_PERF_EVENTS]; /*0 for events not counted*/
+} StatClock;
+
+/**
+ * FileStats struct
+ *
+ * Holds the times and counters of assembling one file
+ */
+typedef struct {
+    char name[MAX_FILE_PATH]; /*the file name as given to the assembler*/
+    double wall[NUM_PHASES]; /*wall seconds of each phase*/
+    double cpu[NUM_PHASES]; /*cpu seconds of each phase*/
+    double perf[NUM_PHASES][NUM_PERF_EVENTS]; /*event counts of each phase, PERF_ values*/
+    unsigned long counters[NUM_COUNTERS]; /*the STAT_ counters*/
+} FileStats;
+
+/**
+ * Stats struct
+ *
+ * Holds the stats of every file assembled
+ */
+typedef struct {
+    FileStats *files;
+    unsigned int num_files;
+    unsigned int cap;
+} Stats;
+
+/**
+ * Creates new empty stats
+ *
+ * @return pointer to the new stats
+ */
+Stats *new_stats();
+
+/**
+ * Frees stats
+ *
+ * @param stats the stats to free
+ */
+void free_stats(Stats *stats);
+
+/**
+ * Adds a file to the stats and zeroes the counters for it
+ *
+ * @param stats the stats
+ * @param name the file name as given to the assembler
+ * @return the stats of the file, valid until the next file is added
+ */
+FileStats *stats_begin_file(Stats *stats, const char *name);
+
+/**
+ * Copies the counters into the stats of the file once it's assembled
+ *
+ * @param fs the stats of the file
+ */
+void stats_end_file(FileStats *fs);
+
+/**
+ * Reads the wall and cpu clocks and the event counters
+ *
+ * @param clk the reading to set
+ */
+void stat_clock(StatClock *clk);
+
+/**
+ * Adds the time since a clock reading to a phase of a file, and sets the reading to now for the next phase
+ *
+ * @param fs the stats of the file
+ * @param phase one of the PHASE_ values
+ * @param clk the reading from the start of the phase
+ */
+void stat_lap(FileStats *fs, int phase, StatClock *clk);
+
+/**
+ * Finds the STATS_ value of a format name
+ *
+ * @param name table, json or prom
+ * @return the STATS_ value, -1 if there is no format with that name
+ */
+int find_stats_format(const char *name);
+
+/**
+ * Writes a string in quotes with backslashes and quotes escaped, the same for JSON strings and prometheus labels
+ *
+ * @param s the string
+ * @param out the file to write to
+ */
+void print_quoted(const char *s, FILE *out);
+
+/**
+ * Writes the stats of every file, the event counts only for the events counted
+ *
+ * @param stats the stats
+ * @param format one of the STATS_ values
+ * @param out the file to write to
+ */
+void print_stats(const Stats *stats, int format, FILE *out);
+
+#endif /* STATS_H */
@@ -0,0 +1,351 @@
+/*
+ * stream.c
+ *
+ *  Created on: Oct 19, 2026
+ */
+#include "stream.h"
+
+LineStream *new_line_stream() {
+    LineStream *ls;
+    ls = mem_alloc(MEM_STREAM, sizeof(LineStream));/*allocate memory for the stream*/
+    ls->text_cap = LS_INIT_SIZE * LINE_SIZE;
+    ls->text = mem_alloc(MEM_STREAM, ls->text_cap);
+    ls->text_len = 0;
+    ls->lines_cap = ls->refs_cap = ls->macros_cap = LS_INIT_SIZE;
+    ls->line_starts = mem_alloc(MEM_STREAM, (ls->lines_cap + 1) * sizeof(unsigned long));
+    ls->line_starts[0] = 0;/*the end of the last line is always kept after the last start*/
+    ls->num_lines = 0;
+    ls->refs = mem_alloc(MEM_STREAM, ls->refs_cap * sizeof(LineRef));
+    ls->num_refs = 0;
+    ls->macros = mem_alloc(MEM_STREAM, ls->macros_cap * sizeof(MacroBody));
+    ls->num_macros = 0;
+    ls->spill = ls->bodies = NULL;
+    ls->bodies_len = ls->body_start = 0;
+    ls->spill_path[0] = '\0';
+    ls->tap = NULL;
+    ls->tap_arg = NULL;
+    ls_rewind(ls);
+    return ls;
+}
+
+LineStream *new_spill_stream(const char *path) {
+    LineStream *ls;
+    FILE *spill, *bodies;
+    spill = path != NULL ? fopen(path, "w+") : tmpfile();/*written first and read back by every pass*/
+    if (spill == NULL) {
+        printf("Error opening out file %s\n", path != NULL ? path : "(temporary)");
+        return NULL;
+    }
+    bodies = tmpfile();/*read back at every call of the macro*/
+    if (bodies == NULL) {
+        printf("Error opening out file (temporary)\n");
+        fclose(spill);
+        return NULL;
+    }
+    ls = new_line_stream();
+    ls->spill = spill;
+    ls->bodies = bodies;
+    if (path != NULL) {
+        strncpy(ls->spill_path, path, MAX_FILE_PATH - 1);
+        ls->spill_path[MAX_FILE_PATH - 1] = '\0';
+    }
+    return ls;
+}
+
+void free_line_stream(LineStream *ls) {
+    if (ls == NULL)/*make sure we got a stream*/
+        return;
+    if (ls->spill != NULL) {
+        fclose(ls->spill);
+    }
+    if (ls->bodies != NULL) {
+        fclose(ls->bodies);
+    }
+    mem_free(ls->text);
+    mem_free(ls->line_starts);
+    mem_free(ls->refs);
+    mem_free(ls->macros);
+    mem_free(ls);
+}
+
+void ls_clear(LineStream *ls) {
+    ls->text_len = 0;
+    ls->num_lines = ls->num_refs = ls->num_macros = 0;
+    ls_rewind(ls);
+}
+
+unsigned int ls_store_line(LineStream *ls, const char *line) {
+    unsigned long len;
+    len = strlen(line);
+    if (ls->bodies != NULL) {/*after the end of the file, a call may have read from the middle*/
+        fseek(ls->bodies, 0, SEEK_END);
+        fwrite(line, 1, len, ls->bodies);
+        ls->bodies_len += len;
+        return ls->num_lines++;
+    }
+    if (ls->text_len + len > ls->text_cap) {/*grow the text if the line doesn't fit*/
+        while (ls->text_len + len > ls->text_cap) {
+            ls->text_cap *= 2;
+        }
+        ls->text = mem_realloc(ls->text, MEM_STREAM, ls->text_cap);
+    }
+    if (ls->num_lines == ls->lines_cap) {
+        ls->lines_cap *= 2;
+        ls->line_starts = mem_realloc(ls->line_starts, MEM_STREAM, (ls->lines_cap + 1) * sizeof(unsigned long));
+    }
+    memcpy(ls->text + ls->text_len, line, len);
+    ls->text_len += len;
+    ls->line_starts[++ls->num_lines] = ls->text_len;/*the start of the next line is the end of this one*/
+    return ls->num_lines - 1;
+}
+
+/**
+ * Appends a reference to the end of the stream
+ *
+ * @param ls the line stream
+ * @param macro id of the macro for a call, LS_SOURCE for a source line
+ * @param line index of the stored line for a source line
+ */
+void ls_add_ref(LineStream *ls, int macro, unsigned int line) {
+    if (ls->num_refs == ls->refs_cap) {
+        ls->refs_cap *= 2;
+        ls->refs = mem_realloc(ls->refs, MEM_STREAM, ls->refs_cap * sizeof(LineRef));
+    }
+    ls->refs[ls->num_refs].macro = macro;
+    ls->refs[ls->num_refs].line = line;
+    ls->num_refs++;
+}
+
+void ls_add_line(LineStream *ls, const char *line) {
+    if (ls->tap != NULL) {
+        ls->tap(ls->tap_arg, line, strlen(line));
+    }
+    if (ls->spill != NULL) {/*source lines of a spill stream aren't stored*/
+        fputs(line, ls->spill);
+        return;
+    }
+    ls_add_ref(ls, LS_SOURCE, ls_store_line(ls, line));
+}
+
+int ls_add_macro(LineStream *ls, unsigned int first_line, unsigned int num_lines) {
+    if (ls->num_macros == ls->macros_cap) {
+        ls->macros_cap *= 2;
+        ls->macros = mem_realloc(ls->macros, MEM_STREAM, ls->macros_cap * sizeof(MacroBody));
+    }
+    ls->macros[ls->num_macros].first_line = first_line;
+    ls->macros[ls->num_macros].num_lines = num_lines;
+    ls->macros[ls->num_macros].offset = ls->body_start;
+    ls->macros[ls->num_macros].len = ls->bodies_len - ls->body_start;
+    ls->body_start = ls->bodies_len;/*the next body starts after this one*/
+    return ls->num_macros++;
+}
+
+/**
+ * Appends a call to a macro at the end of a spill stream, the body is copied from the bodies file line by line
+ *
+ * @param ls the line stream
+ * @param body the body of the macro
+ */
+void ls_spill_call(LineStream *ls, MacroBody *body) {
+    char line[LINE_SIZE];
+    unsigned long left, len;
+    fseek(ls->bodies, body->offset, SEEK_SET);
+    left = body->len;
+    while (left > 0 && fgets(line, sizeof(line), ls->bodies)) {
+        len = strlen(line);
+        if (len > left) {/*the last line of the body had no newline, the next body follows it*/
+            len = left;
+        }
+        if (ls->tap != NULL) {
+            ls->tap(ls->tap_arg, line, len);
+        }
+        fwrite(line, 1, len, ls->spill);
+        left -= len;
+    }
+}
+
+void ls_add_call(LineStream *ls, int macro) {
+    MacroBody *body;
+    unsigned int i;
+    body = &ls->macros[macro];
+    if (ls->bodies != NULL) {
+        ls_spill_call(ls, body);
+        return;
+    }
+    for (i = 0; ls->tap != NULL && i < body->num_lines; i++) {
+        ls->tap(ls->tap_arg, ls->text + ls->line_starts[body->first_line + i],
+                ls->line_starts[body->first_line + i + 1] - ls->line_starts[body->first_line + i]);
+    }
+    if (ls->spill != NULL) {/*the lines of a body are stored one after the other, so the whole body is one block*/
+        fwrite(ls->text + ls->line_starts[body->first_line], 1,
+               ls->line_starts[body->first_line + body->num_lines] - ls->line_starts[body->first_line], ls->spill);
+        return;
+    }
+    ls_add_ref(ls, macro, 0);
+}
+
+void ls_rewind(LineStream *ls) {
+    if (ls->spill != NULL) {/*also switches the file from writing to reading*/
+        fseek(ls->spill, 0, SEEK_SET);
+    }
+    ls->ref = 0;
+    ls->body_line = 0;
+    ls->pos = 0;
+}
+
+/**
+ * Checks if the expanded source ends a line right before a reference
+ *
+ * @param ls the line stream
+ * @param ref the reference
+ * @return 1 if the last stored line before it ends with a newline or there is none, 0 otherwise
+ */
+int ls_ends_line_before(LineStream *ls, unsigned int ref) {
+    MacroBody *body;
+    long line;
+
+    line = -1;
+    while (line == -1 && ref > 0) {/*calls of empty macros add nothing, look before them*/
+        ref--;
+        if (ls->refs[ref].macro == LS_SOURCE) {
+            line = ls->refs[ref].line;
+        } else {
+            body = &ls->macros[ls->refs[ref].macro];
+            if (body->num_lines > 0) {
+                line = body->first_line + body->num_lines - 1;
+            }
+        }
+    }
+    return line == -1 || (ls->line_starts[line + 1] > ls->line_starts[line] &&
+                          ls->text[ls->line_starts[line + 1] - 1] == '\n');
+}
+
+unsigned int ls_line_start(LineStream *ls, unsigned int ref) {
+    while (ref < ls->num_refs && !ls_ends_line_before(ls, ref)) {/*a line longer than the buffer it was read with*/
+        ref++;
+    }
+    return ref;
+}
+
+void ls_view(LineStream *ls, unsigned int first_ref, unsigned int last_ref, LineStream *view) {
+    *view = *ls;
+    view->num_refs = last_ref;/*the reader stops where the range ends*/
+    view->ref = first_ref;
+    view->body_line = 0;
+    view->pos = 0;
+    view->tap = NULL;
+}
+
+/**
+ * Finds the stored line the reader is at, skipping past the ends of macro bodies
+ *
+ * @param ls the line stream
+ * @return index of the stored line, -1 at the end of the stream
+ */
+long ls_current_line(LineStream *ls) {
+    LineRef *ref;
+    MacroBody *body;
+    while (ls->ref < ls->num_refs) {
+        ref = &ls->refs[ls->ref];
+        if (ref->macro == LS_SOURCE) {
+            return ref->line;
+        }
+        body = &ls->macros[ref->macro];
+        if (ls->body_line < body->num_lines) {
+            return body->first_line + ls->body_line;
+        }
+        ls->ref++;/*done with the body, continue after the call*/
+        ls->body_line = 0;
+    }
+    return -1;
+}
+
+char *ls_gets(char *buf, int size, LineStream *ls) {
+    long line;
+    unsigned long start, end, len;
+    char *newline;
+    int n;
+
+    if (ls->spill != NULL) {
+        return fgets(buf, size, ls->spill);
+    }
+    n = 0;
+    /*lines are copied until a newline like fgets does, a stored line may lack one if it was
+     * longer than the buffer it was read with, in which case the next line continues it*/
+    while (n < size - 1 && (line = ls_current_line(ls)) != -1) {
+        start = ls->line_starts[line] + ls->pos;
+        end = ls->line_starts[line + 1];
+        len = end - start;
+        if (len > (unsigned long) (size - 1 - n)) {/*take no more than the buffer has room for*/
+            len = size - 1 - n;
+        }
+        newline = memchr(ls->text + start, '\n', len);/*stop after a newline*/
+        if (newline != NULL) {
+            len = newline - (ls->text + start) + 1;
+        }
+        memcpy(buf + n, ls->text + start, len);
+        n += len;
+        start += len;
+        ls->pos = start - ls->line_starts[line];
+        if (start == end) {/*move on to the next line*/
+            ls->pos = 0;
+            if (ls->refs[ls->ref].macro == LS_SOURCE) {
+                ls->ref++;
+            } else {
+                ls->body_line++;
+            }
+        }
+        if (n > 0 && buf[n - 1] == '\n') {
+            break;
+        }
+    }
+    if (n == 0) {
+        return NULL;
+    }
+    buf[n] = '\0';
+    return buf;
+}
+
+int ls_write_file(LineStream *ls, const char *path) {
+    FILE *file;
+    LineRef *ref;
+    MacroBody *body;
+    unsigned long start, end;
+    unsigned int i;
+    char buf[BUFSIZ];
+    size_t n;
+
+    if (ls->spill != NULL && strcmp(path, ls->spill_path) == 0) {/*already written there*/
+        fflush(ls->spill);
+        fseek(ls->spill, 0, SEEK_END);
+        STAT_ADD(STAT_BYTES, ftell(ls->spill));
+        return 1;
+    }
+    /*open output file in write mode inorder to create/ovewrite it*/
+    file = fopen(path, "w");
+    if (file == NULL) {
+        printf("Error opening out file %s\n", path);
+        return 0;
+    }
+    if (ls->spill != NULL) {/*copy the spill file, the reader position doesn't matter since every pass rewinds*/
+        fseek(ls->spill, 0, SEEK_SET);
+        while ((n = fread(buf, 1, sizeof(buf), ls->spill)) > 0) {
+            fwrite(buf, 1, n, file);
+        }
+    }
+    for (i = 0; i < ls->num_refs; i++) {
+        ref = &ls->refs[i];
+        if (ref->macro == LS_SOURCE) {
+            start = ls->line_starts[ref->line];
+            end = ls->line_starts[ref->line + 1];
+        } else {/*the lines of a body are stored one after the other, so the whole body is one block*/
+            body = &ls->macros[ref->macro];
+            start = ls->line_starts[body->first_line];
+            end = ls->line_starts[body->first_line + body->num_lines];
+        }
+        fwrite(ls->text + start, 1, end - start, file);
+    }
+    STAT_ADD(STAT_BYTES, ftell(file));
+    fclose(file);
+    return 1;
+}
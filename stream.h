@@ -0,0 +1,196 @@
+/*
+ * stream.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  the macro expanded source as a stream of line references. every line of the source and of each macro body
+ *  is stored once, a macro call is a single reference to the body of the macro, so the memory a file takes
+ *  grows with the size of the source and not with the size of the expanded source. a spill stream writes the
+ *  expanded source to a file as it's added and every pass reads it back from the file. the macro bodies go to a
+ *  second file, only where each body is in it stays in memory, so the memory stays the same however big the
+ *  source is and grows with the number of macros only by a few bytes each, like the symbol table
+ */
+
+#ifndef STREAM_H
+#define STREAM_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "util.h"
+#include "stats.h"
+#include "mem.h"
+
+#define LS_SOURCE (-1) /*marks a reference to a source line rather than to a macro*/
+#define LS_INIT_SIZE 256 /*initial number of lines, references and macros a stream has room for*/
+
+/**
+ * LineRef struct
+ *
+ * Used to store one entry of the stream, either a source line or a call to a macro
+ */
+typedef struct {
+    int macro; /*id of the called macro, LS_SOURCE for a source line*/
+    unsigned int line; /*index of the stored line for a source line*/
+} LineRef;
+
+/**
+ * MacroBody struct
+ *
+ * Used to store the range of stored lines that make up the body of a macro
+ */
+typedef struct {
+    unsigned int first_line; /*index of the first stored line of the body*/
+    unsigned int num_lines; /*number of lines in the body*/
+    unsigned long offset; /*where the body starts in the bodies file of a spill stream*/
+    unsigned long len; /*bytes of the body in the bodies file of a spill stream*/
+} MacroBody;
+
+/*called with every line added to the end of a stream, the lines of a macro call one by one. the line isn't
+ * null terminated*/
+typedef void (*LineTap)(void *arg, const char *line, unsigned long len);
+
+/**
+ * LineStream struct
+ *
+ * Used to store the lines of a file once, the references that put them in expanded order
+ * and the position of the reader in the expanded lines
+ */
+typedef struct {
+    char *text; /*the stored lines one after the other, not null terminated*/
+    unsigned long text_len, text_cap;
+    unsigned long *line_starts; /*offset in text of each stored line, plus one past the last line*/
+    unsigned int num_lines, lines_cap;
+    LineRef *refs; /*the expanded source in order*/
+    unsigned int num_refs, refs_cap;
+    MacroBody *macros; /*macro bodies by id*/
+    unsigned int num_macros, macros_cap;
+    unsigned int ref, body_line; /*reader position, the current reference and the line within a macro body*/
+    unsigned long pos; /*reader position within the current line*/
+    FILE *spill; /*the expanded source of a spill stream, null if it's kept in memory*/
+    FILE *bodies; /*the macro bodies of a spill stream, null if they're kept in text*/
+    unsigned long bodies_len; /*bytes written to the bodies file*/
+    unsigned long body_start; /*where the body being defined starts in the bodies file*/
+    char spill_path[MAX_FILE_PATH]; /*path of the spill file, empty for a temporary file*/
+    LineTap tap; /*sees the expanded source as it's added, null for none*/
+    void *tap_arg; /*passed to the tap*/
+} LineStream;
+
+/**
+ * Creates new empty line stream
+ *
+ * @return pointer to new line stream
+ */
+LineStream *new_line_stream();
+
+/**
+ * Creates new empty spill stream, the expanded source is written to a file as lines and macro calls are added
+ * and the macro bodies to a temporary file as they are stored, only where each body is stays in memory
+ *
+ * @param path path of the file to write the expanded source to, overwritten if it exists. null for a temporary
+ * file that is removed when the stream is freed
+ * @return pointer to new line stream, null if the file couldn't be created
+ */
+LineStream *new_spill_stream(const char *path);
+
+/**
+ * Frees a line stream along with all the lines stored in it
+ *
+ * @param ls the line stream to free
+ */
+void free_line_stream(LineStream *ls);
+
+/**
+ * Empties a line stream that keeps it's lines in memory so it can be used for another file, the memory it
+ * grew to is kept
+ *
+ * @param ls the line stream to empty
+ */
+void ls_clear(LineStream *ls);
+
+/**
+ * Stores a line without referencing it, used for the lines of macro bodies. a spill stream writes it to the
+ * bodies file
+ *
+ * @param ls the line stream
+ * @param line the line to store, a copy is made
+ * @return the index of the stored line
+ */
+unsigned int ls_store_line(LineStream *ls, const char *line);
+
+/**
+ * Stores a line and appends a reference to it at the end of the stream
+ *
+ * @param ls the line stream
+ * @param line the line to append, a copy is made
+ */
+void ls_add_line(LineStream *ls, const char *line);
+
+/**
+ * Defines a macro body from lines already stored in the stream. in a spill stream the body is every line stored
+ * since the last macro was defined, which are the lines first_line on
+ *
+ * @param ls the line stream
+ * @param first_line index of the first line of the body
+ * @param num_lines number of lines in the body
+ * @return the id of the macro
+ */
+int ls_add_macro(LineStream *ls, unsigned int first_line, unsigned int num_lines);
+
+/**
+ * Appends a call to a macro at the end of the stream, the body is read in place when the call is reached
+ *
+ * @param ls the line stream
+ * @param macro the id of the macro as returned by ls_add_macro
+ */
+void ls_add_call(LineStream *ls, int macro);
+
+/**
+ * Moves the reader back to the start of the stream so it can be read by another pass
+ *
+ * @param ls the line stream
+ */
+void ls_rewind(LineStream *ls);
+
+/**
+ * Finds where a line of the expanded source starts, so a stream can be split into parts that are read on their own
+ *
+ * @param ls the line stream
+ * @param ref the reference to start looking from
+ * @return the first reference from ref on that starts a line, num_refs if there is none
+ */
+unsigned int ls_line_start(LineStream *ls, unsigned int ref);
+
+/**
+ * Sets up a reader over a range of references of a stream that keeps it's lines in memory. the view shares the
+ * lines of the stream, which must not change while it's read, and is read with ls_gets like the stream itself
+ *
+ * @param ls the line stream
+ * @param first_ref the first reference of the range, should start a line
+ * @param last_ref the reference after the last one of the range
+ * @param view the stream struct to set up, nothing needs to be freed
+ */
+void ls_view(LineStream *ls, unsigned int first_ref, unsigned int last_ref, LineStream *view);
+
+/**
+ * Reads the next line of the expanded source, behaves exactly like fgets on the expanded file
+ *
+ * @param buf buffer to read the line into
+ * @param size the size of buf, at most size - 1 characters are read
+ * @param ls the line stream
+ * @return buf, or null if the end of the stream was reached before reading any characters
+ */
+char *ls_gets(char *buf, int size, LineStream *ls);
+
+/**
+ * Writes the expanded source into a file, every macro call is written with a single write. a spill stream
+ * copies it's file, or only flushes it if it already spills to that path
+ *
+ * @param ls the line stream
+ * @param path path to create the file in. overrites existing file at path
+ * @return 1 if the file was written, 0 if it couldn't be opened
+ */
+int ls_write_file(LineStream *ls, const char *path);
+
+#endif /* STREAM_H */
@@ -0,0 +1,238 @@
+/*
+ ============================================================================
+ Name        : symbench.c
+ Version     : 0.0.1
+ Description : measures the concurrent symbol table with more and more threads defining and looking up the
+               same labels, and checks every label was defined exactly once and the shards were evenly filled
+ ============================================================================
+ */
+#define _POSIX_C_SOURCE 200112L /*for pthreads and clock_gettime*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "shardtab.h"
+
+#define NAME_STRIDE 16 /*bytes every generated name takes in the names buffer*/
+#define MAX_SPREAD 2.0 /*most times its even share of the names a shard may hold before the check fails*/
+#define MIN_SHARE 64 /*names each shard needs on average before the spread is checked, fewer are too noisy*/
+
+/**
+ * BenchJob struct
+ *
+ * Holds the work of one thread, all the names starting from it's own place in them
+ */
+typedef struct {
+    ShardedTable *table;
+    const char *names;
+    unsigned long num_names;
+    unsigned long first; /*where the thread starts, so the threads don't all hit the same shard in step*/
+    unsigned long defined; /*labels the thread was the one to define*/
+    unsigned long found; /*labels the thread found*/
+} BenchJob;
+
+/**
+ * Reads the monotonic clock
+ *
+ * @return the clock in seconds
+ */
+double bench_clock() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * Thread function that tries to define every name, most of them are defined by another thread first
+ *
+ * @param arg the BenchJob
+ * @return null
+ */
+void *define_worker(void *arg) {
+    BenchJob *job;
+    unsigned long i, n;
+    job = (BenchJob *) arg;
+    for (i = 0; i < job->num_names; i++) {
+        n = (job->first + i) % job->num_names;
+        if (sht_define(job->table, job->names + n * NAME_STRIDE, (int) n, SYM_COD) == SHARDTAB_DEFINED) {
+            job->defined++;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Thread function that looks up every name
+ *
+ * @param arg the BenchJob
+ * @return null
+ */
+void *lookup_worker(void *arg) {
+    BenchJob *job;
+    unsigned long i, n;
+    int addr;
+    job = (BenchJob *) arg;
+    for (i = 0; i < job->num_names; i++) {
+        n = (job->first + i) % job->num_names;
+        if (sht_find(job->table, job->names + n * NAME_STRIDE, &addr, NULL) && addr == (int) n) {
+            job->found++;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Runs a thread function on every job and waits for them, a job that can't get a thread is run here
+ *
+ * @param worker the thread function
+ * @param jobs the jobs
+ * @param num_jobs the number of jobs
+ * @return the wall time in seconds
+ */
+double run_jobs(void *(*worker)(void *), BenchJob *jobs, unsigned int num_jobs) {
+    pthread_t *threads;
+    byte *started;
+    unsigned int i;
+    double start;
+
+    threads = malloc(num_jobs * sizeof(pthread_t));
+    started = malloc(num_jobs);
+    start = bench_clock();
+    for (i = 0; i < num_jobs; i++) {
+        started[i] = pthread_create(&threads[i], NULL, worker, &jobs[i]) == 0;
+        if (!started[i]) {/*couldn't get a thread, run the job here instead*/
+            worker(&jobs[i]);
+        }
+    }
+    for (i = 0; i < num_jobs; i++) {
+        if (started[i]) {
+            pthread_join(threads[i], NULL);
+        }
+    }
+    start = bench_clock() - start;
+    free(threads);
+    free(started);
+    return start;
+}
+
+/**
+ * Finds how unevenly the names were spread over the shards of a table
+ *
+ * @param table the table
+ * @return the labels in the fullest shard divided by the labels every shard would have if they were spread evenly
+ */
+double shard_spread(ShardedTable *table) {
+    unsigned int i, largest, count;
+    largest = 0;
+    for (i = 0; i < table->num_shards; i++) {
+        if (table->shards[i].table->num_symbols > largest) {
+            largest = table->shards[i].table->num_symbols;
+        }
+    }
+    count = sht_count(table);
+    return count > 0 ? (double) largest * table->num_shards / count : 0;
+}
+
+/**
+ * Measures one number of threads on a new table and prints a row of the results
+ *
+ * @param names the names buffer
+ * @param num_names the number of names
+ * @param num_shards the number of shards of the table
+ * @param num_threads the number of threads
+ * @return 1 if every label was defined exactly once and found and the shards were evenly filled, 0 otherwise
+ */
+int bench_threads(const char *names, unsigned long num_names, unsigned int num_shards, unsigned int num_threads) {
+    ShardedTable *table;
+    BenchJob *jobs;
+    unsigned long defined, found;
+    double define_secs, lookup_secs, ops, spread;
+    unsigned int i;
+    int ok;
+
+    table = new_sharded_table(num_shards);
+    jobs = malloc(num_threads * sizeof(BenchJob));
+    for (i = 0; i < num_threads; i++) {
+        jobs[i].table = table;
+        jobs[i].names = names;
+        jobs[i].num_names = num_names;
+        jobs[i].first = num_names / num_threads * i;
+        jobs[i].defined = jobs[i].found = 0;
+    }
+    define_secs = run_jobs(define_worker, jobs, num_threads);
+    lookup_secs = run_jobs(lookup_worker, jobs, num_threads);
+
+    defined = found = 0;
+    for (i = 0; i < num_threads; i++) {
+        defined += jobs[i].defined;
+        found += jobs[i].found;
+    }
+    ok = defined == num_names && sht_count(table) == num_names && found == num_names * num_threads;
+    spread = shard_spread(table);
+    if (num_names >= (unsigned long) MIN_SHARE * table->num_shards && spread > MAX_SPREAD) {/*names pile up in a few shards*/
+        ok = 0;
+    }
+    ops = (double) num_names * num_threads;
+    printf("%8u %8u %14.2f %14.2f %12lu %8.2f %8s\n", num_threads, table->num_shards,
+           define_secs > 0 ? ops / define_secs / 1e6 : 0, lookup_secs > 0 ? ops / lookup_secs / 1e6 : 0,
+           (unsigned long) ops - defined, spread, ok ? "ok" : "FAILED");
+    fflush(stdout);
+    free(jobs);
+    free_sharded_table(table);
+    return ok;
+}
+
+int main(int argc, char *argv[]) {/*main function*/
+    char *names;
+    unsigned long num_names, i;
+    unsigned int max_threads, num_shards, threads;
+    int failed;
+
+    max_threads = 8;
+    num_names = 100000;
+    num_shards = SHARDTAB_SHARDS;
+    for (i = 1; i < (unsigned long) argc; i++) {
+        if (strncmp(argv[i], "--threads=", 10) == 0) {
+            max_threads = strtoul(argv[i] + 10, NULL, 10);
+        } else if (strncmp(argv[i], "--names=", 8) == 0) {
+            num_names = strtoul(argv[i] + 8, NULL, 10);
+        } else if (strncmp(argv[i], "--shards=", 9) == 0) {
+            num_shards = strtoul(argv[i] + 9, NULL, 10);
+        } else {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            fprintf(stderr, "usage: %s [--threads=max] [--names=n] [--shards=n]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (max_threads < 1) {
+        max_threads = 1;
+    }
+    if (num_names < 1) {
+        num_names = 1;
+    }
+
+    names = malloc(num_names * NAME_STRIDE);
+    for (i = 0; i < num_names; i++) {/*label names like the ones in the generated sources*/
+        sprintf(names + i * NAME_STRIDE, "L%lu", i);
+    }
+
+    printf("%8s %8s %14s %14s %12s %8s %8s\n", "threads", "shards", "define Mops/s", "lookup Mops/s", "duplicates",
+           "spread", "check");
+    failed = 0;
+    for (threads = 1;; threads *= 2) {/*doubling the threads up to the most asked for*/
+        if (threads > max_threads) {
+            threads = max_threads;
+        }
+        if (!bench_threads(names, num_names, num_shards, threads)) {
+            failed = 1;
+        }
+        if (threads == max_threads) {
+            break;
+        }
+    }
+    free(names);
+    return failed;
+}
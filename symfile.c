@@ -0,0 +1,215 @@
+/*
+ * symfile.c
+ *
+ *  Created on: Oct 19, 2026
+ */
+#define _POSIX_C_SOURCE 200112L /*for mmap*/
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "symfile.h"
+
+/**
+ * SortedName struct
+ *
+ * Holds a symbol of the table while the symbols are sorted by name
+ */
+typedef struct {
+    const char *name;
+    unsigned int id;
+} SortedName;
+
+/**
+ * Compares symbols by name for qsort
+ *
+ * @param a the first SortedName
+ * @param b the second SortedName
+ * @return like strcmp of the names
+ */
+int compare_names(const void *a, const void *b) {
+    return strcmp(((const SortedName *) a)->name, ((const SortedName *) b)->name);
+}
+
+long write_sym_file(SymbolTable *symbols, const char *path) {
+    FILE *file;
+    SymFileHeader header;
+    SymFileSymbol *records;
+    SortedName *sorted;
+    unsigned int *uses, *index, *rank, *next_use, i, id, n;
+    unsigned long slot, mask, len;
+    char pad[4];
+    long size;
+
+    n = symbols->num_symbols;
+    header.magic = SYMFILE_MAGIC;
+    header.version = SYMFILE_VERSION;
+    header.num_symbols = n;
+    header.num_uses = symbols->num_uses;
+    header.index_size = 1;
+    while (header.index_size < 2 * n) {
+        header.index_size *= 2;
+    }
+    header.names_len = 0;
+
+    sorted = mem_alloc(MEM_SYMBOLS, (n > 0 ? n : 1) * sizeof(SortedName));
+    rank = mem_alloc(MEM_SYMBOLS, (n > 0 ? n : 1) * sizeof(unsigned int));
+    next_use = mem_alloc(MEM_SYMBOLS, (n > 0 ? n : 1) * sizeof(unsigned int));
+    records = mem_alloc(MEM_SYMBOLS, (n > 0 ? n : 1) * sizeof(SymFileSymbol));
+    for (i = 0; i < n; i++) {
+        sorted[i].name = st_name(symbols, i);
+        sorted[i].id = i;
+    }
+    qsort(sorted, n, sizeof(SortedName), compare_names);
+
+    /*the records in name order, with room for the uses of every symbol one after the other*/
+    for (i = 0; i < n; i++) {
+        id = sorted[i].id;
+        rank[id] = i;
+        records[i].name = header.names_len;
+        records[i].addr = symbols->types[id] & SYM_EXT ? 0 : symbols->addrs[id] + BASE_ADDRESS;
+        records[i].type = symbols->types[id];
+        records[i].num_uses = 0;
+        header.names_len += strlen(sorted[i].name) + 1;
+    }
+    for (i = 0; i < symbols->num_uses; i++) {
+        records[rank[symbols->use_syms[i]]].num_uses++;
+    }
+    for (i = 0, id = 0; i < n; i++) {
+        records[i].first_use = next_use[sorted[i].id] = id;
+        id += records[i].num_uses;
+    }
+    uses = mem_alloc(MEM_SYMBOLS, (symbols->num_uses > 0 ? symbols->num_uses : 1) * sizeof(unsigned int));
+    for (i = 0; i < symbols->num_uses; i++) {/*the uses were recorded in address order, they stay in it*/
+        uses[next_use[symbols->use_syms[i]]++] = symbols->use_addrs[i];
+    }
+
+    index = mem_alloc(MEM_SYMBOLS, header.index_size * sizeof(unsigned int));
+    memset(index, 0, header.index_size * sizeof(unsigned int));
+    mask = header.index_size - 1;
+    for (i = 0; i < n; i++) {/*linear probing, the index is never more than half full*/
+        slot = st_hash(sorted[i].name) & mask;
+        while (index[slot] != 0) {
+            slot = (slot + 1) & mask;
+        }
+        index[slot] = i + 1;
+    }
+    memset(pad, 0, sizeof(pad));
+    header.names_len = (header.names_len + 3) & ~3u;/*so the file keeps 4 byte alignment*/
+
+    file = fopen(path, "wb");
+    size = -1;
+    if (file == NULL) {
+        printf("Error opening file: %s\n", path);
+    } else {
+        fwrite(&header, sizeof(header), 1, file);
+        fwrite(records, sizeof(SymFileSymbol), n, file);
+        fwrite(uses, sizeof(unsigned int), header.num_uses, file);
+        fwrite(index, sizeof(unsigned int), header.index_size, file);
+        for (i = 0, len = 0; i < n; i++) {
+            fwrite(sorted[i].name, 1, strlen(sorted[i].name) + 1, file);
+            len += strlen(sorted[i].name) + 1;
+        }
+        fwrite(pad, 1, header.names_len - len, file);
+        size = ferror(file) ? -1 : ftell(file);
+        if (fclose(file) != 0) {
+            size = -1;
+        }
+        if (size < 0) {
+            printf("Error writing file: %s\n", path);
+        }
+    }
+    mem_free(sorted);
+    mem_free(rank);
+    mem_free(next_use);
+    mem_free(records);
+    mem_free(uses);
+    mem_free(index);
+    return size;
+}
+
+int open_sym_file(const char *path, SymFile *sf) {
+    const SymFileHeader *h;
+    struct stat st;
+    unsigned long expected;
+    unsigned int i;
+    int fd, ok;
+
+    sf->map = NULL;
+    sf->size = 0;
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "%s: can't open file\n", path);
+        return 0;
+    }
+    ok = fstat(fd, &st) == 0 && st.st_size >= (long) sizeof(SymFileHeader);
+    if (ok) {
+        sf->size = st.st_size;
+        sf->map = mmap(NULL, sf->size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ok = sf->map != MAP_FAILED;
+    }
+    close(fd);/*the mapping stays*/
+    if (!ok) {
+        fprintf(stderr, "%s: not a symbol file\n", path);
+        sf->map = NULL;
+        return 0;
+    }
+
+    h = sf->header = (const SymFileHeader *) sf->map;
+    expected = sizeof(SymFileHeader) + (unsigned long) h->num_symbols * sizeof(SymFileSymbol) +
+               ((unsigned long) h->num_uses + h->index_size) * sizeof(unsigned int) + h->names_len;
+    ok = h->magic == SYMFILE_MAGIC && h->version == SYMFILE_VERSION && expected == sf->size &&
+         h->index_size > 0 && (h->index_size & (h->index_size - 1)) == 0 && h->index_size >= 2 * h->num_symbols;
+    if (ok) {
+        sf->symbols = (const SymFileSymbol *) (h + 1);
+        sf->uses = (const unsigned int *) (sf->symbols + h->num_symbols);
+        sf->index = sf->uses + h->num_uses;
+        sf->names = (const char *) (sf->index + h->index_size);
+        /*everything the lookups follow must stay inside the file*/
+        for (i = 0; ok && i < h->num_symbols; i++) {
+            ok = sf->symbols[i].name < h->names_len && memchr(sf->names + sf->symbols[i].name, '\0',
+                                                               h->names_len - sf->symbols[i].name) != NULL &&
+                 sf->symbols[i].first_use <= h->num_uses &&
+                 sf->symbols[i].num_uses <= h->num_uses - sf->symbols[i].first_use;
+        }
+        for (i = 0; ok && i < h->index_size; i++) {
+            ok = sf->index[i] <= h->num_symbols;
+        }
+    }
+    if (!ok) {
+        fprintf(stderr, "%s: malformed symbol file\n", path);
+        close_sym_file(sf);
+        return 0;
+    }
+    return 1;
+}
+
+void close_sym_file(SymFile *sf) {
+    if (sf->map != NULL) {
+        munmap(sf->map, sf->size);
+    }
+    sf->map = NULL;
+    sf->size = 0;
+}
+
+int sym_file_find(const SymFile *sf, const char *name) {
+    unsigned long slot, mask, probes;
+    unsigned int n;
+
+    mask = sf->header->index_size - 1;
+    slot = st_hash(name) & mask;
+    /*at least half the slots are empty, the probes are bounded anyway*/
+    for (probes = 0; probes <= mask && (n = sf->index[slot]) != 0; probes++) {
+        if (strcmp(sf->names + sf->symbols[n - 1].name, name) == 0) {
+            return (int) n - 1;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return SYMFILE_NO_SYMBOL;
+}
+
+const char *sym_file_name(const SymFile *sf, unsigned int n) {
+    return sf->names + sf->symbols[n].name;
+}
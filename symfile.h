@@ -0,0 +1,114 @@
+/*
+ * symfile.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  the .sym file, every label of an assembled file with it's address, type bits and the uses of it as an
+ *  external label, in a binary form that is read by mapping it into memory. everything is a native 32 bit
+ *  unsigned int except the names: a header, the symbols sorted by name, the use sites grouped by symbol in
+ *  address order, a hash index of the symbols and the names with their null terminators. a symbol is found by
+ *  probing the index, without parsing the file
+ */
+
+#ifndef SYMFILE_H
+#define SYMFILE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "util.h"
+#include "isa.h"
+#include "symtab.h"
+#include "mem.h"
+
+#define SYMFILE_MAGIC 0x4D595341u /*"ASYM" in the first bytes of the file on a little endian machine*/
+#define SYMFILE_VERSION 1
+#define SYMFILE_NO_SYMBOL (-1) /*returned when a name isn't in the file*/
+
+/**
+ * SymFileHeader struct
+ *
+ * Holds the first bytes of a .sym file, the sizes of the parts that follow
+ */
+typedef struct {
+    unsigned int magic; /*SYMFILE_MAGIC, read as something else on a machine of the other byte order*/
+    unsigned int version;
+    unsigned int num_symbols;
+    unsigned int num_uses;
+    unsigned int index_size; /*slots in the index, a power of 2 at least twice the symbols*/
+    unsigned int names_len; /*bytes of the names, a multiple of 4*/
+} SymFileHeader;
+
+/**
+ * SymFileSymbol struct
+ *
+ * Holds a symbol of a .sym file
+ */
+typedef struct {
+    unsigned int name; /*offset of the name in the names*/
+    unsigned int addr; /*the address with BASE_ADDRESS added, as in the .ent file. 0 for an external label*/
+    unsigned int type; /*the SYM_ bits*/
+    unsigned int first_use; /*index of the first use site of the symbol*/
+    unsigned int num_uses; /*use sites of the symbol, the addresses of the words that use it as an external label*/
+} SymFileSymbol;
+
+/**
+ * SymFile struct
+ *
+ * Holds a .sym file mapped into memory and where it's parts are
+ */
+typedef struct {
+    void *map;
+    unsigned long size;
+    const SymFileHeader *header;
+    const SymFileSymbol *symbols;
+    const unsigned int *uses;
+    const unsigned int *index; /*symbol number plus one in every slot, 0 for an empty slot*/
+    const char *names;
+} SymFile;
+
+/**
+ * Writes the .sym file of a symbol table
+ *
+ * @param symbols the symbol table after assembly, with the extern uses recorded
+ * @param path path to create the file in. overrites existing file at path
+ * @return the size of the file, -1 if it couldn't be written
+ */
+long write_sym_file(SymbolTable *symbols, const char *path);
+
+/**
+ * Maps a .sym file into memory, prints an error to stderr if the file can't be read or is malformed
+ *
+ * @param path path to the .sym file
+ * @param sf the struct to fill, must be closed with close_sym_file
+ * @return 1 if the file was mapped, 0 otherwise
+ */
+int open_sym_file(const char *path, SymFile *sf);
+
+/**
+ * Unmaps a .sym file
+ *
+ * @param sf the file
+ */
+void close_sym_file(SymFile *sf);
+
+/**
+ * Finds a symbol by probing the index of a .sym file
+ *
+ * @param sf the file
+ * @param name the name of the symbol
+ * @return the symbol number, SYMFILE_NO_SYMBOL if there is no symbol by that name
+ */
+int sym_file_find(const SymFile *sf, const char *name);
+
+/**
+ * Gets the name of a symbol of a .sym file
+ *
+ * @param sf the file
+ * @param n the symbol number
+ * @return the name, valid until the file is closed
+ */
+const char *sym_file_name(const SymFile *sf, unsigned int n);
+
+#endif /* SYMFILE_H */
@@ -0,0 +1,189 @@
+/*
+ * symtab.c
+ *
+ *  Created on: Oct 19, 2026
+ */
+#include "symtab.h"
+
+SymbolTable *new_symbol_table() {
+    SymbolTable *st;
+    st = mem_alloc(MEM_SYMBOLS, sizeof(SymbolTable));
+    st->cap = SYMTAB_MIN_SYMBOLS;
+    st->addrs = mem_alloc(MEM_SYMBOLS, st->cap * sizeof(int));
+    st->types = mem_alloc(MEM_SYMBOLS, st->cap * sizeof(byte));
+    st->names = mem_alloc(MEM_SYMBOLS, st->cap * sizeof(unsigned long));
+    st->hashes = mem_alloc(MEM_SYMBOLS, st->cap * sizeof(unsigned long));
+    st->num_symbols = 0;
+    st->text_cap = st->cap * 8;
+    st->text = mem_alloc(MEM_SYMBOLS, st->text_cap);
+    st->text_len = 0;
+    st->index_size = st->cap * 2;
+    st->index = mem_alloc(MEM_SYMBOLS, st->index_size * sizeof(unsigned int));
+    memset(st->index, 0, st->index_size * sizeof(unsigned int));
+    st->uses_cap = SYMTAB_MIN_SYMBOLS;
+    st->use_syms = mem_alloc(MEM_SYMBOLS, st->uses_cap * sizeof(unsigned int));
+    st->use_addrs = mem_alloc(MEM_SYMBOLS, st->uses_cap * sizeof(long));
+    st->num_uses = 0;
+    return st;
+}
+
+void free_symbol_table(SymbolTable *st) {
+    if (st == NULL)/*make sure we got a table*/
+        return;
+    mem_free(st->addrs);
+    mem_free(st->types);
+    mem_free(st->names);
+    mem_free(st->hashes);
+    mem_free(st->text);
+    mem_free(st->index);
+    mem_free(st->use_syms);
+    mem_free(st->use_addrs);
+    mem_free(st);
+}
+
+unsigned long st_hash(const char *name) {
+    unsigned long c, hash;
+    hash = HASH_MAGIC_NUM;
+    while ((c = (unsigned char) *name++)) {
+        hash = ((hash << 5) + hash) + c;
+    }
+    return hash;
+}
+
+/**
+ * Finds the slot of the index a name is in, or the empty slot it would go in
+ *
+ * @param st the symbol table
+ * @param name the name to look for
+ * @param hash the full hash of the name
+ * @return the slot
+ */
+unsigned long st_slot(SymbolTable *st, const char *name, unsigned long hash) {
+    unsigned long slot, mask;
+    unsigned int id;
+
+    mask = st->index_size - 1;
+    slot = hash & mask;
+    while ((id = st->index[slot]) != 0) {/*linear probing, the index is never more than half full*/
+        id--;
+        if (st->hashes[id] == hash && strcmp(st->text + st->names[id], name) == 0) {
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+void st_clear(SymbolTable *st) {
+    unsigned long slot, mask;
+    unsigned int id;
+
+    mask = st->index_size - 1;
+    for (id = 0; id < st->num_symbols; id++) {/*empty only the slots the symbols took*/
+        slot = st->hashes[id] & mask;
+        while (st->index[slot] != id + 1) {/*slots emptied before may be in the way, the symbol is still there*/
+            slot = (slot + 1) & mask;
+        }
+        st->index[slot] = 0;
+    }
+    st->num_symbols = 0;
+    st->text_len = 0;
+    st->num_uses = 0;
+}
+
+int st_find(SymbolTable *st, const char *name) {
+    unsigned long slot;
+    slot = st_slot(st, name, st_hash(name));
+    return st->index[slot] != 0 ? (int) st->index[slot] - 1 : SYMTAB_NO_SYMBOL;
+}
+
+/**
+ * Doubles the room for symbols and the index, putting every symbol back in the bigger index
+ *
+ * @param st the symbol table
+ */
+void st_grow(SymbolTable *st) {
+    unsigned long slot, mask;
+    unsigned int id;
+
+    st->cap *= 2;
+    st->addrs = mem_realloc(st->addrs, MEM_SYMBOLS, st->cap * sizeof(int));
+    st->types = mem_realloc(st->types, MEM_SYMBOLS, st->cap * sizeof(byte));
+    st->names = mem_realloc(st->names, MEM_SYMBOLS, st->cap * sizeof(unsigned long));
+    st->hashes = mem_realloc(st->hashes, MEM_SYMBOLS, st->cap * sizeof(unsigned long));
+
+    st->index_size = st->cap * 2;
+    mem_free(st->index);
+    st->index = mem_alloc(MEM_SYMBOLS, st->index_size * sizeof(unsigned int));
+    memset(st->index, 0, st->index_size * sizeof(unsigned int));
+    mask = st->index_size - 1;
+    for (id = 0; id < st->num_symbols; id++) {/*the names are all different so there is no need to compare them*/
+        slot = st->hashes[id] & mask;
+        while (st->index[slot] != 0) {
+            slot = (slot + 1) & mask;
+        }
+        st->index[slot] = id + 1;
+    }
+}
+
+unsigned int st_intern(SymbolTable *st, const char *name, int addr, byte type) {
+    unsigned long hash, slot, len;
+    unsigned int id;
+
+    hash = st_hash(name);
+    slot = st_slot(st, name, hash);
+    if (st->index[slot] != 0) {
+        return st->index[slot] - 1;
+    }
+    if (st->num_symbols == st->cap) {/*the slot changes with the index*/
+        st_grow(st);
+        slot = st_slot(st, name, hash);
+    }
+    len = strlen(name) + 1;/*with the null terminator*/
+    while (st->text_len + len > st->text_cap) {
+        st->text_cap *= 2;
+        st->text = mem_realloc(st->text, MEM_SYMBOLS, st->text_cap);
+    }
+    memcpy(st->text + st->text_len, name, len);
+
+    id = st->num_symbols++;
+    st->addrs[id] = addr;
+    st->types[id] = type;
+    st->names[id] = st->text_len;
+    st->hashes[id] = hash;
+    st->text_len += len;
+    st->index[slot] = id + 1;
+    return id;
+}
+
+const char *st_name(SymbolTable *st, unsigned int id) {
+    return st->text + st->names[id];
+}
+
+void st_add_use(SymbolTable *st, unsigned int id, long addr) {
+    if (st->num_uses == st->uses_cap) {
+        st->uses_cap *= 2;
+        st->use_syms = mem_realloc(st->use_syms, MEM_SYMBOLS, st->uses_cap * sizeof(unsigned int));
+        st->use_addrs = mem_realloc(st->use_addrs, MEM_SYMBOLS, st->uses_cap * sizeof(long));
+    }
+    st->use_syms[st->num_uses] = id;
+    st->use_addrs[st->num_uses] = addr;
+    st->num_uses++;
+}
+
+void st_view(SymbolTable *st, SymbolTable *view) {
+    *view = *st;
+    view->uses_cap = SYMTAB_MIN_SYMBOLS;
+    view->use_syms = mem_alloc(MEM_SYMBOLS, view->uses_cap * sizeof(unsigned int));
+    view->use_addrs = mem_alloc(MEM_SYMBOLS, view->uses_cap * sizeof(long));
+    view->num_uses = 0;
+}
+
+void st_merge_uses(SymbolTable *st, SymbolTable *view) {
+    unsigned int i;
+    for (i = 0; st != NULL && i < view->num_uses; i++) {
+        st_add_use(st, view->use_syms[i], view->use_addrs[i]);
+    }
+    mem_free(view->use_syms);
+    mem_free(view->use_addrs);
+}
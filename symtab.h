@@ -0,0 +1,135 @@
+/*
+ * symtab.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  the labels of a file as parallel arrays indexed by symbol id, ids are given in the order the labels first
+ *  appear. the index is an open addressing table that only maps names to ids and grows with the labels, so
+ *  passes over every symbol read the arrays from start to end instead of chasing entries around the heap.
+ *  the uses of external labels are kept in arrays of their own in the order they are recorded
+ */
+
+#ifndef SYMTAB_H
+#define SYMTAB_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "util.h"
+#include "hashtable.h"
+#include "mem.h"
+
+#define SYMTAB_MIN_SYMBOLS 64 /*symbols a table starts with room for*/
+#define SYMTAB_NO_SYMBOL (-1) /*returned when a name isn't in the table*/
+
+/**
+ * SymbolTable struct
+ *
+ * Holds the addresses, types and names of the labels and the index from names to ids
+ */
+typedef struct {
+    int *addrs; /*the address of every symbol in the binary encoding*/
+    byte *types; /*the SYM_ bits of every symbol*/
+    unsigned long *names; /*offset of the name of every symbol in the names text*/
+    unsigned long *hashes; /*full hash of every name, to grow the index without hashing again*/
+    unsigned int num_symbols;
+    unsigned int cap; /*room in the symbol arrays*/
+    char *text; /*the names one after the other with their null terminators*/
+    unsigned long text_len;
+    unsigned long text_cap;
+    unsigned int *index; /*id plus one of the symbol in every slot, 0 for an empty slot*/
+    unsigned int index_size; /*slots in the index, a power of 2 at least twice the symbols*/
+    unsigned int *use_syms; /*id of the external label of every use*/
+    long *use_addrs; /*address of the word of every use*/
+    unsigned int num_uses;
+    unsigned int uses_cap;
+} SymbolTable;
+
+/**
+ * Creates an empty symbol table
+ *
+ * @return the new table
+ */
+SymbolTable *new_symbol_table();
+
+/**
+ * Frees a symbol table
+ *
+ * @param st the table to free
+ */
+void free_symbol_table(SymbolTable *st);
+
+/**
+ * Removes every symbol and use from a table, in time proportional to the number of symbols. the arrays keep
+ * the size they grew to
+ *
+ * @param st the table to clear
+ */
+void st_clear(SymbolTable *st);
+
+/**
+ * Hashes a name the same way the hashtable does, without reducing it to a slot
+ *
+ * @param name the name to hash
+ * @return the full hash value
+ */
+unsigned long st_hash(const char *name);
+
+/**
+ * Finds the id of a symbol
+ *
+ * @param st the symbol table
+ * @param name the name of the symbol
+ * @return the id, SYMTAB_NO_SYMBOL if there is no symbol by that name
+ */
+int st_find(SymbolTable *st, const char *name);
+
+/**
+ * Finds the id of a symbol, adding it first if there is no symbol by that name
+ *
+ * @param st the symbol table
+ * @param name the name of the symbol
+ * @param addr the address to give the symbol if it's added
+ * @param type the SYM_ bits to give the symbol if it's added
+ * @return the id
+ */
+unsigned int st_intern(SymbolTable *st, const char *name, int addr, byte type);
+
+/**
+ * Gets the name of a symbol
+ *
+ * @param st the symbol table
+ * @param id the id of the symbol
+ * @return the name, valid until the next symbol is added
+ */
+const char *st_name(SymbolTable *st, unsigned int id);
+
+/**
+ * Records a use of an external label
+ *
+ * @param st the symbol table
+ * @param id the id of the label
+ * @param addr the address of the word that uses it
+ */
+void st_add_use(SymbolTable *st, unsigned int id, long addr);
+
+/**
+ * Sets up a table that shares the symbols of another but records the uses of external labels in arrays of it's
+ * own, so several threads can look labels up and record uses at once. the symbols must not change while the
+ * view is used
+ *
+ * @param st the symbol table
+ * @param view the table struct to set up, freed with st_merge_uses
+ */
+void st_view(SymbolTable *st, SymbolTable *view);
+
+/**
+ * Appends the uses a view recorded to the uses of it's table and frees the arrays of the view
+ *
+ * @param st the symbol table the view was set up from, null to only free the view
+ * @param view the view
+ */
+void st_merge_uses(SymbolTable *st, SymbolTable *view);
+
+#endif /* SYMTAB_H */
@@ -0,0 +1,337 @@
+/*
+ * encode_test.c
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  encodes every opcode with every legal combination of addressing modes twice, once with instruction_to_bin
+ *  and once with the bit matrix encoder the assembler used before words were packed, and compares the words.
+ *  the reference encoder is the old one with the changes made to the output since applied to it, each is
+ *  marked where it is made
+ *
+ *  usage: encode_test
+ */
+#include "../assemble.h"
+
+/*the operands every addressing mode is tried with, arrays and not literals since the encoders trim them*/
+char imm_operands[][MAX_TOKEN_LEN] = {"i0", "i5", "i-1", "i-2048", "i2047"};
+char reg_operands[][MAX_TOKEN_LEN] = {"r0", "r3", "r7"};
+char label_operands[][MAX_TOKEN_LEN] = {"lLOCAL", "lDATA", "lEXTERN", "lENTRY"};
+
+#define NUM_IMM_OPERANDS (sizeof(imm_operands) / MAX_TOKEN_LEN)
+#define NUM_REG_OPERANDS (sizeof(reg_operands) / MAX_TOKEN_LEN)
+#define NUM_LABEL_OPERANDS (sizeof(label_operands) / MAX_TOKEN_LEN)
+
+#define TEST_IC 117 /*the IC the instructions are encoded at*/
+
+void int_to_bin(long num, int bits, char *bin) {
+    int k, i, neg;/*flag and iterators*/
+    k = 0;/*start counting bits from 0*/
+    neg = num < 0;/*set flag to 1 if num is negative*/
+    if (neg) { /*make sure we work on positive numbers in this step*/
+        num *= -1;
+    }
+    while (num > 0 &&
+           k < bits) {/*keep diving by 2 and adding the remainder to encod integer into bits until integer reaches 0*/
+        bin[k] = num % 2;/*place bits into provided bin array*/
+        num /= 2;
+        k++;/*count bits*/
+    }
+    if (neg) {/*if number was originally negative, preform two's complement convertion on the allotted bits*/
+        for (i = 0; i < bits; i++) {
+            bin[i] = !bin[i];/*flip bits*/
+        }
+        /*add 1*/
+        bin[0] += 1;
+        for (i = 0; i < bits - 1 && bin[i] > 1; i++) {
+            bin[i] = 0;
+            bin[i + 1] += 1;
+        }
+    }
+}
+
+/**
+ * Zero the array
+ *
+ * @param word
+ */
+void clear_word(char word[ASM_WORD_SIZE]) {
+    int i;
+    for (i = 0; i < ASM_WORD_SIZE; i++) {/*self-explanatory*/
+        word[i] = 0;
+    }
+}
+
+/**
+ * Packs an array of 1 and 0 bytes into a word
+ *
+ * @param bits the array, lowest bit first
+ * @return the word
+ */
+word pack_word(char bits[ASM_WORD_SIZE]) {
+    word w;
+    int i;
+    w = 0;
+    for (i = ASM_WORD_SIZE - 1; i >= 0; i--) {
+        w = (w << 1) | (bits[i] ? 1 : 0);
+    }
+    return w;
+}
+
+/**
+ * The reference encoder, converts an instruction into bit matrix words the way the assembler did before
+ * instruction_to_bin packed them
+ *
+ * @param symbols the symbol table with the labels the operands use
+ * @param opcode the string representation of the opcode
+ * @param operands the string representation of the operands
+ * @param num_operands the number of operands in the operands parameter
+ * @param bin the words of the instruction, zeroed by the caller
+ * @param num_words the number of words the instruction uses, 0 on error
+ */
+void ref_instruction_to_bin(SymbolTable *symbols, char *opcode, char *operands[3], int num_operands,
+                            char bin[4][ASM_WORD_SIZE], int *num_words) {
+    int bin_opcode, bin_operands[3], k, offset, word_offset, id;
+    char *operand;
+    int era[3]; /*ERA bits of every label operand word*/
+
+    *num_words = 0;
+    bin_opcode = find_opcode(opcode);
+
+    for (k = 0; k < num_operands; k++) {
+        operand = operands[k];
+        era[k] = 2;
+        if (operand[0] == 'r') {
+            bin_operands[k] = str_to_int(operand + 1);
+
+        } else if (operand[0] == 'i') {
+            bin_operands[k] = str_to_int(trim(operand + 1));
+
+        } else if (operand[0] == 'l') {
+            id = st_find(symbols, trim(operand + 1));
+            if (id == SYMTAB_NO_SYMBOL) {
+                return;
+            }
+            bin_operands[k] = symbols->addrs[id] + BASE_ADDRESS;
+            /*changed: the word of an external label gets ERA bits 01 and address 0, the old encoder OR-ed 01 into
+             * the relocatable bits and kept the address. it also read the label types of the operands without
+             * setting them for other operands, and OR-ed the entry ERA bits 10 that every label word already has*/
+            if (symbols->types[id] & SYM_EXT) {
+                bin_operands[k] = 0;
+                era[k] = 1;
+            }
+
+        } else {
+            return;
+        }
+    }
+
+    *num_words = 1;
+    int_to_bin(bin_opcode, 4, bin[0] + 6);
+
+    offset = 0;
+    word_offset = 1;
+
+    if (num_operands == 3) {
+        int_to_bin(2, 2, bin[0] + 2);
+        int_to_bin(era[0], 2, bin[1]);
+        int_to_bin(bin_operands[0], ASM_WORD_SIZE - 2, bin[1] + 2);
+        offset = 1;
+        word_offset = 2;
+        int_to_bin(get_addr_type(operands[offset + 1]), 2, bin[0] + ASM_WORD_SIZE - 4);
+        int_to_bin(get_addr_type(operands[offset]), 2, bin[0] + ASM_WORD_SIZE - 2);
+        *num_words = 4;
+    }
+
+    if (num_operands > 1) {
+
+        if (num_operands == 2) {
+            int_to_bin(get_addr_type(operands[0]), 2, bin[0] + 4);
+            int_to_bin(get_addr_type(operands[1]), 2, bin[0] + 2);
+            *num_words = 3;
+        }
+
+        if (operands[offset][0] == 'r' && operands[offset + 1][0] == 'r') {
+            int_to_bin(bin_operands[offset + 1], 5, bin[word_offset] + 2);
+            int_to_bin(bin_operands[offset], 5, bin[word_offset] + 8);
+            *num_words -= 1;
+
+        } else if (operands[offset][0] == 'r' && operands[offset + 1][0] != 'r') {
+            int_to_bin(bin_operands[offset], 5, bin[word_offset] + 8);
+            int_to_bin(bin_operands[offset + 1], ASM_WORD_SIZE - 2, bin[word_offset + 1] + 2);
+
+        } else if (operands[offset][0] != 'r' && operands[offset + 1][0] == 'r') {
+            int_to_bin(bin_operands[offset], ASM_WORD_SIZE - 2, bin[word_offset] + 2);
+            int_to_bin(bin_operands[offset + 1], 5, bin[word_offset + 1] + 2);
+
+        } else {
+            int_to_bin(bin_operands[offset], ASM_WORD_SIZE - 2, bin[word_offset] + 2);
+            int_to_bin(bin_operands[offset + 1], ASM_WORD_SIZE - 2, bin[word_offset + 1] + 2);
+        }
+
+        if (operands[offset][0] == 'l') {
+            int_to_bin(era[offset], 2, bin[word_offset]);
+        }
+        if (operands[offset + 1][0] == 'l') {
+            int_to_bin(era[offset + 1], 2, bin[word_offset + 1]);
+        }
+
+    } else if (num_operands == 1) {
+        *num_words = 2;
+        if (operands[0][0] == 'l') {
+            int_to_bin(era[0], 2, bin[1]);
+        }
+        int_to_bin(bin_operands[0], ASM_WORD_SIZE - 2, bin[1] + 2);
+        /*changed: the addressing mode of the operand, the old encoder put 2 here for every opcode but prn and
+         * nothing for prn*/
+        int_to_bin(get_addr_type(operands[0]), 2, bin[0] + 2);
+    }
+}
+
+/**
+ * Puts every operand of the addressing modes of a mask in an array
+ *
+ * @param modes mask of MODE_BIT values
+ * @param operands the array to put the operands in
+ * @return the number of operands
+ */
+int mode_operands(byte modes, char *operands[]) {
+    unsigned int i, n;
+    n = 0;
+    for (i = 0; (modes & MODE_BIT(MODE_IMM)) && i < NUM_IMM_OPERANDS; i++) {
+        operands[n++] = imm_operands[i];
+    }
+    for (i = 0; (modes & MODE_BIT(MODE_DIR)) && i < NUM_LABEL_OPERANDS; i++) {
+        operands[n++] = label_operands[i];
+    }
+    for (i = 0; (modes & MODE_BIT(MODE_REG)) && i < NUM_REG_OPERANDS; i++) {
+        operands[n++] = reg_operands[i];
+    }
+    return n;
+}
+
+/**
+ * Encodes an instruction with both encoders and prints the words if they differ
+ *
+ * @param symbols the symbol table with the labels the operands use
+ * @param cache the cache to encode with, may be null
+ * @param opcode the opcode integer rep
+ * @param operands the string representation of the operands
+ * @param num_operands the number of operands in the operands parameter
+ * @return 1 if the words are the same, 0 if not
+ */
+int compare_encoders(SymbolTable *symbols, EncodeCache *cache, int opcode, char *operands[3], int num_operands) {
+    char ref_bin[4][ASM_WORD_SIZE];
+    word bin[4];
+    int i, num_words, ref_num_words, same;
+
+    for (i = 0; i < 4; i++) {
+        clear_word(ref_bin[i]);
+    }
+    ref_instruction_to_bin(symbols, (char *) isa[opcode].name, operands, num_operands, ref_bin, &ref_num_words);
+    instruction_to_bin(TEST_IC, symbols, cache, (char *) isa[opcode].name, operands, num_operands, bin, &num_words,
+                       1);
+
+    same = num_words == ref_num_words && num_words > 0;
+    for (i = 0; same && i < num_words; i++) {
+        same = bin[i] == pack_word(ref_bin[i]);
+    }
+    if (!same) {
+        printf("%s%s", cache != NULL ? "(cached) " : "", isa[opcode].name);
+        for (i = 0; i < num_operands; i++) {
+            printf("%s%s", i == 0 ? " " : ",", operands[i]);
+        }
+        printf(": %d words", num_words);
+        for (i = 0; i < num_words; i++) {
+            printf(" %04x", bin[i]);
+        }
+        printf(", expected %d words", ref_num_words);
+        for (i = 0; i < ref_num_words; i++) {
+            printf(" %04x", pack_word(ref_bin[i]));
+        }
+        printf("\n");
+    }
+    return same;
+}
+
+/**
+ * Encodes every combination of operands of an opcode with both encoders
+ *
+ * @param symbols the symbol table with the labels the operands use
+ * @param cache the cache to encode with, may be null
+ * @param opcode the opcode integer rep
+ * @param failed reference to the number of instructions whose words differ
+ * @return the number of instructions compared
+ */
+int compare_opcode(SymbolTable *symbols, EncodeCache *cache, int opcode, int *failed) {
+    char *srcs[NUM_IMM_OPERANDS + NUM_LABEL_OPERANDS + NUM_REG_OPERANDS];
+    char *dsts[NUM_IMM_OPERANDS + NUM_LABEL_OPERANDS + NUM_REG_OPERANDS];
+    char *params[NUM_IMM_OPERANDS + NUM_LABEL_OPERANDS + NUM_REG_OPERANDS];
+    char *operands[3];
+    const OpcodeDesc *desc;
+    int num_srcs, num_dsts, num_params, i, j, k, n;
+
+    desc = &isa[opcode];
+    num_srcs = mode_operands(desc->src_modes, srcs);
+    num_dsts = mode_operands(desc->dst_modes, dsts);
+    num_params = mode_operands(desc->param_modes, params);
+    n = 0;
+
+    if (desc->optype == OPTYPE_INS) {
+        n++;
+        *failed += !compare_encoders(symbols, cache, opcode, operands, 0);
+
+    } else if (desc->optype == OPTYPE_BIN) {
+        for (i = 0; i < num_srcs; i++) {
+            for (j = 0; j < num_dsts; j++, n++) {
+                operands[0] = srcs[i];
+                operands[1] = dsts[j];
+                *failed += !compare_encoders(symbols, cache, opcode, operands, 2);
+            }
+        }
+
+    } else {/*unary and jump opcodes take their only operand as destination*/
+        for (i = 0; i < num_dsts; i++, n++) {
+            operands[0] = dsts[i];
+            *failed += !compare_encoders(symbols, cache, opcode, operands, 1);
+        }
+        if (desc->optype == OPTYPE_JMP) {/*a jump with parameters, to a label*/
+            for (i = 0; i < (int) NUM_LABEL_OPERANDS; i++) {
+                for (j = 0; j < num_params; j++) {
+                    for (k = 0; k < num_params; k++, n++) {
+                        operands[0] = label_operands[i];
+                        operands[1] = params[j];
+                        operands[2] = params[k];
+                        *failed += !compare_encoders(symbols, cache, opcode, operands, 3);
+                    }
+                }
+            }
+        }
+    }
+    return n;
+}
+
+int main() {
+    SymbolTable *symbols;
+    EncodeCache *cache;
+    int opcode, compared, failed;
+
+    symbols = new_symbol_table();
+    st_intern(symbols, "LOCAL", 3, SYM_DEF | SYM_COD);
+    st_intern(symbols, "DATA", 41, SYM_DEF | SYM_DAT);
+    st_intern(symbols, "EXTERN", 0, SYM_EXT);
+    st_intern(symbols, "ENTRY", 12, SYM_DEF | SYM_COD | SYM_ENT);
+    cache = new_encode_cache(CACHE_MAX_ENTRIES);
+
+    compared = failed = 0;
+    for (opcode = 0; opcode < NUM_OPCODES; opcode++) {
+        compared += compare_opcode(symbols, NULL, opcode, &failed);
+        /*twice with the cache, the second time the encodings come from it*/
+        compare_opcode(symbols, cache, opcode, &failed);
+        compare_opcode(symbols, cache, opcode, &failed);
+    }
+
+    free_encode_cache(cache);
+    free_symbol_table(symbols);
+    printf("%d instructions, %d encoded differently\n", compared, failed);
+    return failed != 0;
+}
@@ -0,0 +1,11 @@
+.extern OUT
+.extern FN
+.entry START
+START:  mov OUT, r2
+        cmp r1, OUT
+        add #4, TOTAL
+        jsr FN
+        bne FN(OUT,r3)
+        stop
+TOTAL:  .data 0,-12
+.entry TOTAL
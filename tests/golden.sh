@@ -0,0 +1,65 @@
+#!/bin/sh
+#
+# golden.sh
+#
+#  Created on: Oct 19, 2026
+#
+#  assembles a source in a work directory and compares the files it wrote with the expected ones in
+#  tests/expected. the .ob has to match byte for byte. the .ent and .ext are compared as sorted lines since their
+#  order follows the symbol table. a file with no expected file must not be written at all
+#
+#  usage: golden.sh assembler work_dir source [assembler options]
+#  the source is given without .as like the assembler takes it
+
+if [ $# -lt 3 ]; then
+    echo "usage: $0 assembler work_dir source [assembler options]" >&2
+    exit 2
+fi
+assembler=$1
+work=$2
+source=$3
+shift 3
+expected=$(dirname "$0")/expected
+name=$(basename "$source")
+run=$name
+if [ $# -gt 0 ]; then
+    run="$name $*"
+fi
+
+mkdir -p "$work" || exit 2
+rm -f "$work/$name.am" "$work/$name.ob" "$work/$name.ent" "$work/$name.ext" "$work/$name.sym"
+cp "$source.as" "$work/$name.as" || exit 2
+"$assembler" "$@" "$work/$name" > "$work/$name.out" 2>&1 || {
+    echo "$run: the assembler failed, see $work/$name.out"
+    exit 1
+}
+
+failed=0
+for ext in ob ent ext; do
+    want=$expected/$name.$ext
+    got=$work/$name.$ext
+    if [ ! -f "$want" ]; then
+        if [ -f "$got" ]; then
+            echo "$run: wrote $name.$ext, none was expected"
+            failed=1
+        fi
+    elif [ ! -f "$got" ]; then
+        echo "$run: $name.$ext is missing"
+        failed=1
+    elif [ $ext = ob ]; then
+        if ! cmp -s "$want" "$got"; then
+            echo "$run: $name.ob differs from the expected one"
+            diff "$want" "$got"
+            failed=1
+        fi
+    else
+        sort "$want" > "$work/$name.$ext.want"
+        sort "$got" > "$work/$name.$ext.got"
+        if ! cmp -s "$work/$name.$ext.want" "$work/$name.$ext.got"; then
+            echo "$run: $name.$ext differs from the expected one"
+            diff "$work/$name.$ext.want" "$work/$name.$ext.got"
+            failed=1
+        fi
+    fi
+done
+exit $failed
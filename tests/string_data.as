@@ -0,0 +1,8 @@
+MAIN:   red r3
+        prn #100
+        lea NAME, r1
+        inc COUNT
+        stop
+NAME:   .string "ab"
+COUNT:  .data 255,-1000,7
+.entry COUNT
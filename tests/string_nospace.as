@@ -0,0 +1,3 @@
+MSG:    .string"hi"
+        prn MSG
+        stop
@@ -0,0 +1,12 @@
+MAIN:   inc r1
+        dec COUNT
+        not r2
+        clr COUNT
+        prn #-7
+        prn r3
+        prn COUNT
+        jmp NEXT
+NEXT:   bne MAIN(r1,#3)
+        jsr END
+END:    stop
+COUNT:  .data 5
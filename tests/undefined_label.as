@@ -0,0 +1,8 @@
+.extern OUT
+MAIN:   mov r1, OUT
+        jmp MISSING
+        add #1, OUT
+        cmp NOWHERE, r2
+        inc COUNT
+        stop
+COUNT:  .data 3
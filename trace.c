@@ -0,0 +1,135 @@
+/*
+ * trace.c
+ *
+ *  Created on: Oct 19, 2026
+ */
+#define _POSIX_C_SOURCE 200112L /*for clock_gettime and getpid*/
+
+#include <time.h>
+#include <unistd.h>
+
+#include "trace.h"
+#include "stats.h"
+
+int trace_enabled;
+
+double trace_origin;/*the clock when the trace started, in microseconds*/
+TraceBuffer *trace_buffers;/*the buffers of every thread, the last one to record first*/
+int trace_threads;/*number of buffers*/
+THREAD_LOCAL TraceBuffer *trace_local;/*the buffer of the calling thread*/
+
+/**
+ * Reads the monotonic clock
+ *
+ * @return the clock in microseconds
+ */
+double trace_clock() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+/**
+ * Creates the buffer of the calling thread and links it to the others
+ *
+ * @return the new buffer
+ */
+TraceBuffer *trace_attach() {
+    TraceBuffer *buf;
+    buf = malloc(sizeof(TraceBuffer));
+    buf->cap = TRACE_BUFFER_EVENTS;
+    buf->num_events = 0;
+    buf->events = malloc(buf->cap * sizeof(TraceEvent));
+    buf->tid = __atomic_add_fetch(&trace_threads, 1, __ATOMIC_RELAXED);
+    buf->next = __atomic_load_n(&trace_buffers, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(&trace_buffers, &buf->next, buf, 0, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+        /*another thread linked it's buffer first, buf->next was updated to it so try again*/
+    }
+    trace_local = buf;
+    return buf;
+}
+
+void trace_start() {
+    trace_origin = trace_clock();
+    if (trace_local == NULL) {/*the main thread gets the first buffer before any worker can record*/
+        trace_attach();
+    }
+    trace_enabled = 1;
+}
+
+double trace_now() {
+    return trace_enabled ? trace_clock() - trace_origin : 0;
+}
+
+void trace_span(const char *name, const char *file, double start) {
+    TraceBuffer *buf;
+    TraceEvent *ev;
+
+    if (!trace_enabled) {
+        return;
+    }
+    buf = trace_local != NULL ? trace_local : trace_attach();
+    if (buf->num_events == buf->cap) {
+        buf->cap *= 2;
+        buf->events = realloc(buf->events, buf->cap * sizeof(TraceEvent));
+    }
+    ev = &buf->events[buf->num_events++];
+    ev->name = name;
+    ev->file = file;
+    ev->start = start;
+    ev->dur = trace_now() - start;
+}
+
+int trace_write(const char *path) {
+    FILE *out;
+    TraceBuffer *buf, *next;
+    TraceEvent *ev;
+    unsigned long i;
+    long pid;
+
+    out = fopen(path, "w");
+    if (out == NULL) {
+        fprintf(stderr, "Error creating trace file %s\n", path);
+    }
+    pid = (long) getpid();
+    if (out != NULL) {
+        fprintf(out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+        fprintf(out, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%ld,\"tid\":0,\"args\":{\"name\":\"assembler\"}}", pid);
+    }
+    buf = __atomic_load_n(&trace_buffers, __ATOMIC_ACQUIRE);
+    while (buf != NULL) {
+        if (out != NULL) {
+            fprintf(out, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%ld,\"tid\":%d,\"args\":{\"name\":", pid, buf->tid);
+            if (buf->tid == 1) {/*the buffer trace_start attached*/
+                fputs("\"main\"}}", out);
+            } else {
+                fprintf(out, "\"worker %d\"}}", buf->tid - 1);
+            }
+            for (i = 0; i < buf->num_events; i++) {
+                ev = &buf->events[i];
+                fputs(",\n{\"name\":", out);
+                print_quoted(ev->name, out);
+                fprintf(out, ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%ld,\"tid\":%d", ev->start, ev->dur, pid, buf->tid);
+                if (ev->file != NULL) {
+                    fputs(",\"args\":{\"file\":", out);
+                    print_quoted(ev->file, out);
+                    fputc('}', out);
+                }
+                fputc('}', out);
+            }
+        }
+        next = buf->next;
+        free(buf->events);
+        free(buf);
+        buf = next;
+    }
+    trace_buffers = NULL;
+    trace_threads = 0;
+    trace_local = NULL;
+    if (out == NULL) {
+        return 0;
+    }
+    fputs("\n]}\n", out);
+    fclose(out);
+    return 1;
+}
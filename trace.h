@@ -0,0 +1,82 @@
+/*
+ * trace.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  a timeline of the assembly in the chrome trace event format, for chrome://tracing or perfetto. every
+ *  thread records spans in a buffer of it's own with no locking, the buffers are linked when a thread
+ *  records it's first span, or starts the trace, and written together at exit. when tracing isn't started
+ *  recording a span is a check of a flag
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "util.h"
+
+#define TRACE_BUFFER_EVENTS 1024 /*spans a thread's buffer starts with room for*/
+
+/**
+ * TraceEvent struct
+ *
+ * Holds a span of a thread
+ */
+typedef struct {
+    const char *name; /*must live until the trace is written*/
+    const char *file; /*the file the span belongs to, null for none. must live until the trace is written*/
+    double start; /*microseconds since the trace started*/
+    double dur; /*microseconds*/
+} TraceEvent;
+
+/**
+ * TraceBuffer struct
+ *
+ * Holds the spans of one thread
+ */
+typedef struct TraceBuffer {
+    TraceEvent *events;
+    unsigned long num_events;
+    unsigned long cap;
+    int tid; /*1 for the thread that started the trace, the others are numbered in the order they recorded*/
+    struct TraceBuffer *next; /*the buffer of the thread before*/
+} TraceBuffer;
+
+/*1 once trace_start was called*/
+extern int trace_enabled;
+
+/**
+ * Starts tracing, times are measured from now. the calling thread is the main thread of the trace, it's
+ * buffer is attached here so no worker can take it's place
+ */
+void trace_start();
+
+/**
+ * Reads the trace clock
+ *
+ * @return microseconds since the trace started, 0 if tracing isn't started
+ */
+double trace_now();
+
+/**
+ * Records a span of the calling thread from a time until now, does nothing if tracing isn't started
+ *
+ * @param name the name of the span
+ * @param file the file the span belongs to, null for none
+ * @param start the time the span started, as returned by trace_now
+ */
+void trace_span(const char *name, const char *file, double start);
+
+/**
+ * Writes the spans of every thread as a JSON trace and frees them. must be called when no other thread
+ * records spans
+ *
+ * @param path path of the file to write
+ * @return 1 on success, 0 if the file couldn't be created
+ */
+int trace_write(const char *path);
+
+#endif /* TRACE_H */
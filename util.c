@@ -49,6 +49,25 @@ char *trim(char *str) {
     return trim_left(str);
 }
 
+char *split_token(char *str, const char *delims, char **save) {
+    char *end;
+    if (str == NULL) {/*continue where the last call stopped*/
+        str = *save;
+    }
+    str += strspn(str, delims);/*skip separators before the token*/
+    if (*str == '\0') {
+        *save = str;
+        return NULL;
+    }
+    end = str + strcspn(str, delims);
+    if (*end != '\0') {/*terminate the token and continue after the separator next time*/
+        *end = '\0';
+        end++;
+    }
+    *save = end;
+    return str;
+}
+
 int str_to_int(char *str) {
     int num, i, len;
     num = 0;
@@ -77,3 +96,35 @@ FILE *open_file_append(const char *path) {
     file = fopen(path, "a");
     return file;
 }
+
+char *read_response_file(const char *path, unsigned int *num_names) {
+    FILE *file;
+    char line[MAX_FILE_PATH], *name, *names;
+    unsigned long len, cap, name_len;
+
+    file = fopen(path, "r");
+    if (file == NULL) {
+        printf("Error opening response file %s\n", path);
+        return NULL;
+    }
+    cap = 256;
+    len = 0;
+    names = malloc(cap);
+    *num_names = 0;
+    while (fgets(line, sizeof(line), file)) {/*a name on every line*/
+        name = trim(line);
+        name_len = strlen(name);
+        if (name_len == 0) {
+            continue;
+        }
+        while (len + name_len + 1 > cap) {
+            cap *= 2;
+            names = realloc(names, cap);
+        }
+        memcpy(names + len, name, name_len + 1);/*with the null terminator*/
+        len += name_len + 1;
+        (*num_names)++;
+    }
+    fclose(file);
+    return names;
+}
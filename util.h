@@ -30,13 +30,28 @@
 #define OPTYPE_BIN 2 /*represents opcode with 2 operands*/
 #define OPTYPE_JMP 4 /*represents jump opcode*/
 
+/*declares a variable every thread has it's own copy of. C90 has no thread local storage, C11 has _Thread_local
+ * and gcc and clang have had __thread for long before that. only the trace buffers use it, passing a buffer to
+ * every function that records a span would be worse*/
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#define THREAD_LOCAL _Thread_local
+#elif defined(__GNUC__)
+#define THREAD_LOCAL __thread
+#else
+#error "no thread local storage, THREAD_LOCAL has to be defined for this compiler"
+#endif
+
 #include <stdio.h>
+#include <stdlib.h>
 #include <ctype.h>
 #include <string.h>
 
 /*shortcut when trying to save memory space*/
 typedef unsigned char byte;
 
+/*packed machine word, only the low ASM_WORD_SIZE bits are used*/
+typedef unsigned short word;
+
 /**
  * Checks if character is a digit
  *
@@ -86,6 +101,17 @@ char* trim_right(char *str, int len);
  */
 char* trim(char *str);
 
+/**
+ * Splits a string into tokens like strtok, but keeps it's position in a pointer of the caller instead of a
+ * static one so threads can split strings at the same time
+ *
+ * @param str the string to split, null to continue the string of the last call with the same save pointer
+ * @param delims the characters that separate tokens
+ * @param save a reference to a pointer to keep the position in between calls
+ * @return the next token, null terminated in place, null if there are no more tokens
+ */
+char* split_token(char* str, const char* delims, char** save);
+
 /**
  * Convertes a string to integer based on the characters in string (given they are digits)
  *
@@ -101,4 +127,15 @@ int str_to_int(char* str);
  */
 FILE* open_file_append(const char* path);
 
+/**
+ * Reads the file names listed in a response file, one per line. whitespace around the names is trimmed and
+ * empty lines are skipped
+ *
+ * @param path path to the response file
+ * @param num_names the number of names read
+ * @return the names one after the other, each ending with a null terminator, to free with free. null if the
+ * file couldn't be opened
+ */
+char* read_response_file(const char* path, unsigned int* num_names);
+
 #endif /* UTIL_H_ */
@@ -22,17 +22,8 @@ int is_valid_opcode(char *str, int *opcode, byte *optype) {
     if (op == -1) {
         return 0;/*if integer opcode was not found then opcode string is invalid*/
     }
-    /*figure out which type of opcode we got according to the language spec and set it*/
-    if (op == 6 || (op >= 0 && op <= 3)) {
-        *optype = OPTYPE_BIN;/*binary operand op*/
-    } else if (op == 4 || op == 5 || op == 7
-               || op == 8 || op == 11 || op == 12) {
-        *optype = OPTYPE_UNI;/*unary operand op*/
-    } else if (op == 9 || op == 10 || op == 13) {
-        *optype = OPTYPE_JMP;/*jump type op*/
-    } else {
-        *optype = OPTYPE_INS;/*0 operand ops like ret or stop*/
-    }
+    /*the type of opcode according to the language spec is kept in the isa descriptor table*/
+    *optype = isa[op].optype;
     /*set opcode*/
     *opcode = op;
     /*if we didn't return then the value is correct*/
@@ -74,7 +65,7 @@ int is_valid_imm(char *str, char *err, byte no_prefix) {
         }
 
         num *= 10;
-        num += str[i];
+        num += str[i] - '0';
     }
     /*after we converted the string to an integer, we must check that said integer fits within our word
      * as specified, we get 12 bits to store a data word and we are storing signed numbers so that leaves
@@ -140,73 +131,116 @@ int is_valid_label(char *str, char *err) {
     return 1;
 }
 
-void validate_code(const char *code_file_path, byte *is_valid) {
-    /*flags, counter and tmp storage*/
-    char line[LINE_SIZE + 10];
-    FILE *in_file;
-    List *tokens;
+/**
+ * Gets the addressing mode of an operand token as it appears in the source code
+ *
+ * @param str operand token string
+ * @return one of the MODE_ values defined in isa.h
+ */
+int get_token_mode(char *str) {
+    if (str[0] == '#') return MODE_IMM;/*immediates start with #*/
+    if (str[0] == 'r') return MODE_REG;/*registers start with r*/
+    return MODE_DIR;/*anything else has to be a label*/
+}
+
+/**
+ * Check if given token string constitutes a valid operand of whatever addressing mode it has
+ *
+ * @param str token string to check
+ * @param err an empty buffer to put the error in. if token string is valid operand buffer will remain empty
+ * @param imm_code error code to report for an invalid immediate value
+ * @param reg_code error code to report for an invalid register
+ * @param label_code error code to report for an invalid label
+ * @return 1 if string is a valid operand, 0 otherwise
+ */
+int is_valid_operand(char *str, char *err, int imm_code, int reg_code, int label_code) {
+    char sub_err[ERR_SIZE / 2];
+    switch (get_token_mode(str)) {
+        case MODE_IMM:
+            if (!is_valid_imm(str, sub_err, 0)) {
+                sprintf(err, "(%d): invalid immediate value \"%s\", %s", imm_code, str, sub_err);
+                return 0;
+            }
+            break;
+        case MODE_REG:
+            if (!is_valid_reg(str, sub_err)) {
+                sprintf(err, "(%d): invalid register name \"%s\", %s", reg_code, str, sub_err);
+                return 0;
+            }
+            break;
+        default:
+            if (!is_valid_label(str, sub_err)) {
+                sprintf(err, "(%d): invalid label \"%s\", %s", label_code, str, sub_err);
+                return 0;
+            }
+    }
+    /*if we didn't return then the value is correct*/
+    return 1;
+}
+
+int validate_line(char *line, unsigned int *line_num, Arena *scratch) {
     char tok_err[ERR_SIZE];
-    Node *curr;
-    unsigned int line_num, line_len, i;
+    List *tokens;
+    unsigned int line_len, i;
 
-    *is_valid = 1; /*assume code file is correct*/
+    memset(tok_err, '\0', ERR_SIZE);/*reset error message buffer*/
+    line_len = strlen(line);/*for readability and ease of use*/
 
-    /*open source code file in read mode*/
-    in_file = fopen(code_file_path, "r");
-    if (in_file == NULL) {
-        printf("error code (0) failed to open file %s", code_file_path);
-        *is_valid = 0;
-        return;
+    if (line_len > LINE_SIZE) { /*check for line length*/
+        printf("line %d error code (99): exeeded maximum line size of %d characters", *line_num, LINE_SIZE);
+        return 0;
     }
-    line_num = 1;/*start counting lines from 1*/
 
-    while (fgets(line, sizeof(line), in_file)) {/*iterate over all lines*/
-        memset(tok_err, '\0', ERR_SIZE);/*reset error message buffer*/
-        line_len = strlen(line);/*for readability and ease of use*/
-
-        if (line_len > LINE_SIZE) { /*check for line length*/
-            printf("line %d error code (99): exeeded maximum line size of %d characters", line_num, LINE_SIZE);
-            *is_valid = 0;
-            continue;
+    if (line[0] == ';') {/*comment line*/
+        return 1;
+    }
+    for (i = 0; i < line_len; i++) {/*check that entire line is whitespace*/
+        if (!isspace(line[i])) {
+            break;
         }
+    }
+    if (i >= line_len) { /*whitespace line*/
+        return 1;
+    }
 
-        if (line[0] == ';') {/*comment line*/
-            continue;
-        }
-        for (i = 0; i < line_len; i++) {/*check that entire line is whitespace*/
-            if (!isspace(line[i])) {
-                break;
-            }
-        }
-        if (i >= line_len) { /*whitespace line*/
-            continue;
-        }
+    tokens = tokenize(line, scratch);/*convert the line to language tokens*/
+    STAT_ADD(STAT_TOKENS, tokens->length);
+    validate_tokens(tokens, tok_err);/*get error code from line tokens, if there is any*/
+    arena_reset(scratch);/*free tokens because after checking for errors we have nothing to do with them*/
 
-        tokens = tokenize(line);/*convert the line to language tokens*/
-        validate_tokens(tokens, tok_err);/*get error code from line tokens, if there is any*/
-        curr = tokens->tail;/*free tokens list because after checking for errors we have nothing to do with it*/
-        while (curr) {
-            free(curr->data);/*free token string*/
-            curr = curr->prev;
-        }
-        free_list(tokens);/*free list data*/
+    if (strlen(tok_err) > 0) {
+        /*if we found an error in the line, print the error*/
+        printf("line %d error code %s\n", *line_num, tok_err);
+    }
+    (*line_num)++;/*count lines to report which line if the offending line*/
+    return strlen(tok_err) == 0;
+}
 
-        if (strlen(tok_err) > 0) {
-            /*if we found an error in the line, print the error and mark file as in correct by
-             * setting is_valid = 0*/
-            printf("line %d error code %s\n", line_num, tok_err);
+void validate_code(LineStream *lines, byte *is_valid) {
+    /*flags, counter and tmp storage*/
+    char line[VALIDATE_LINE_SIZE];
+    Arena *scratch;/*memory for the tokens of the current line*/
+    unsigned int line_num;
+
+    *is_valid = 1; /*assume code file is correct*/
+
+    ls_rewind(lines);/*read the code from the start*/
+    scratch = new_arena(TOKENS_ARENA_SIZE);
+    line_num = 1;/*start counting lines from 1*/
+
+    while (ls_gets(line, sizeof(line), lines)) {/*iterate over all lines*/
+        if (!validate_line(line, &line_num, scratch)) {/*mark file as incorrect by setting is_valid = 0*/
             *is_valid = 0;
         }
-        line_num++;/*count lines to report which line if the offending line*/
     }
-    /*close the code file*/
-    fclose(in_file);
+    free_arena(scratch);
 }
 
 void validate_tokens(List *tokens, char *err) {
     /*flags, counters, and tmp storage*/
     byte type, optype, need_comma;
-    int opcode;
+    int opcode, mode;
+    const OpcodeDesc *desc;
     Node *curr;
     char *tmp, sub_err[ERR_SIZE / 2];
     curr = tokens->tail;
@@ -326,6 +360,7 @@ void validate_tokens(List *tokens, char *err) {
             sprintf(err, "(13): invalid opcode \"%s\"", tmp);
             return;
         }
+        desc = &isa[opcode];/*what the opcode accepts*/
         curr = curr->prev;
 
         if (optype == OPTYPE_INS) { /*make sure we dont have any tokens after a no operand instruction*/
@@ -340,30 +375,18 @@ void validate_tokens(List *tokens, char *err) {
                 return;
             }
             tmp = (char *) curr->data;
-            /*validate unary instruction operand*/
-            if (tmp[0] == '#') {
-                if (opcode == 12) { /*is prn opcode we can have any operand type*/
-                    if (!is_valid_imm(tmp, sub_err,0)) {/*verify that immediate is valid immediate*/
-                        sprintf(err, "(16): invalid immediate value \"%s\", %s", tmp, sub_err);
-                        return;
-                    }
-
-                } else {/*otherwise, all other unary instructions can only accept label or register as operand*/
+            /*validate unary instruction operand, only prn can accept an immediate*/
+            mode = get_token_mode(tmp);
+            if (!(desc->dst_modes & MODE_BIT(mode))) {
+                if (mode == MODE_IMM) {
                     sprintf(err, "(17): cannot pass immediate value to opcode %d", opcode);
-                    return;
-                }
-
-            } else if (tmp[0] == 'r') {
-                if (!is_valid_reg(tmp, sub_err)) {
-                    sprintf(err, "(18): invalid register name \"%s\", %s", tmp, sub_err);
-                    return;
-                }
-
-            } else {
-                if (!is_valid_label(tmp, sub_err)) {
-                    sprintf(err, "(19): invalid label \"%s\", %s", tmp, sub_err);
-                    return;
+                } else {
+                    sprintf(err, "(70): operand \"%s\" has an addressing mode not allowed for opcode %d", tmp, opcode);
                 }
+                return;
+            }
+            if (!is_valid_operand(tmp, err, 16, 18, 19)) {
+                return;
             }
             /*make sure we don't have more than 1 operand*/
             curr = curr->prev;
@@ -378,34 +401,18 @@ void validate_tokens(List *tokens, char *err) {
                 return;
             }
             tmp = (char *) curr->data;
-
-            if (tmp[0] == '#') {
-                if (opcode == 6) {/*if is lea opcode we cannot have immediate in the source operand*/
-                    sprintf(err, "(22): source operand for opcode 6 must be label");
-                    return;
-                } else {
-                    if (!is_valid_imm(tmp, sub_err,0)) {
-                        sprintf(err, "(23): invalid immediate value \"%s\", %s", tmp, sub_err);
-                        return;
-                    }
-                }
-
-            } else if (tmp[0] == 'r') {
-                if (opcode == 6) { /*if is lea opcode we cannot have register in the source operand*/
-                    sprintf(err, "(24): source operand for opcode 6 must be label");
-                    return;
+            /*validate source operand, lea only accepts a label*/
+            mode = get_token_mode(tmp);
+            if (!(desc->src_modes & MODE_BIT(mode))) {
+                if (desc->src_modes == MODE_BIT(MODE_DIR)) {
+                    sprintf(err, "(%d): source operand for opcode %d must be label", mode == MODE_IMM ? 22 : 24, opcode);
                 } else {
-                    if (!is_valid_reg(tmp, sub_err)) {
-                        sprintf(err, "(25): invalid register name \"%s\", %s", tmp, sub_err);
-                        return;
-                    }
-                }
-
-            } else {
-                if (!is_valid_label(tmp, sub_err)) {
-                    sprintf(err, "(26) : invalid label \"%s\", %s", tmp, sub_err);
-                    return;
+                    sprintf(err, "(70): operand \"%s\" has an addressing mode not allowed for opcode %d", tmp, opcode);
                 }
+                return;
+            }
+            if (!is_valid_operand(tmp, err, 23, 25, 26)) {
+                return;
             }
             /*check that we have a comma after 1st operand*/
             curr = curr->prev;
@@ -425,29 +432,18 @@ void validate_tokens(List *tokens, char *err) {
                 return;
             }
             tmp = (char *) curr->data;
-
-            if (tmp[0] == '#') {
-                if (opcode == 1) {/*if is cmp opcode we can have nay type of operand in the destination operand*/
-                    if (!is_valid_imm(tmp, sub_err,0)) {
-                        sprintf(err, "(28): invalid immediate value \"%s\", %s", tmp, sub_err);
-                        return;
-                    }
-                } else {
+            /*validate destination operand, only cmp accepts an immediate*/
+            mode = get_token_mode(tmp);
+            if (!(desc->dst_modes & MODE_BIT(mode))) {
+                if (mode == MODE_IMM) {
                     sprintf(err, "(29): cannot pass immediate as destination operand ");
-                    return;
-                }
-
-            } else if (tmp[0] == 'r') {
-                if (!is_valid_reg(tmp, sub_err)) {
-                    sprintf(err, "(30): invalid register name \"%s\", %s", tmp, sub_err);
-                    return;
-                }
-
-            } else {
-                if (!is_valid_label(tmp, sub_err)) {
-                    sprintf(err, "(31): invalid label \"%s\", %s", tmp, sub_err);
-                    return;
+                } else {
+                    sprintf(err, "(70): operand \"%s\" has an addressing mode not allowed for opcode %d", tmp, opcode);
                 }
+                return;
+            }
+            if (!is_valid_operand(tmp, err, 28, 30, 31)) {
+                return;
             }
             /*make sure we dont have more than 2 operands*/
             curr = curr->prev;
@@ -463,23 +459,12 @@ void validate_tokens(List *tokens, char *err) {
             }
             tmp = (char *) curr->data;
             /*validate destination operand*/
-            if (tmp[0] == '#') {
-                if (!is_valid_imm(tmp, sub_err,0)) {
-                    sprintf(err, "(34): invalid immediate value \"%s\", %s", tmp, sub_err);
-                    return;
-                }
-
-            } else if (tmp[0] == 'r') {
-                if (!is_valid_reg(tmp, sub_err)) {
-                    sprintf(err, "(35): invalid register name \"%s\", %s", tmp, sub_err);
-                    return;
-                }
-
-            } else {
-                if (!is_valid_label(tmp, sub_err)) {
-                    sprintf(err, "(36): invalid label \"%s\", %s", tmp, sub_err);
-                    return;
-                }
+            if (!(desc->dst_modes & MODE_BIT(get_token_mode(tmp)))) {
+                sprintf(err, "(70): operand \"%s\" has an addressing mode not allowed for opcode %d", tmp, opcode);
+                return;
+            }
+            if (!is_valid_operand(tmp, err, 34, 35, 36)) {
+                return;
             }
             /*check for jump parameters*/
             curr = curr->prev;
@@ -501,23 +486,12 @@ void validate_tokens(List *tokens, char *err) {
             }
             tmp = (char *) curr->data;
             /*validate 1st param*/
-            if (tmp[0] == '#') {
-                if (!is_valid_imm(tmp, sub_err,0)) {
-                    sprintf(err, "(39): invalid immediate value \"%s\", %s", tmp, sub_err);
-                    return;
-                }
-
-            } else if (tmp[0] == 'r') {
-                if (!is_valid_reg(tmp, sub_err)) {
-                    sprintf(err, "(40): invalid register name \"%s\", %s", tmp, sub_err);
-                    return;
-                }
-
-            } else {
-                if (!is_valid_label(tmp, sub_err)) {
-                    sprintf(err, "(41): invalid label \"%s\", %s", tmp, sub_err);
-                    return;
-                }
+            if (!(desc->param_modes & MODE_BIT(get_token_mode(tmp)))) {
+                sprintf(err, "(70): operand \"%s\" has an addressing mode not allowed for opcode %d", tmp, opcode);
+                return;
+            }
+            if (!is_valid_operand(tmp, err, 39, 40, 41)) {
+                return;
             }
 
             /*make sure we have comma token*/
@@ -540,24 +514,12 @@ void validate_tokens(List *tokens, char *err) {
                 return;
             }
             tmp = (char *) curr->data;
-
-            if (tmp[0] == '#') {
-                if (!is_valid_imm(tmp, sub_err,0)) {
-                    sprintf(err, "(45): invalid immediate value \"%s\", %s", tmp, sub_err);
-                    return;
-                }
-
-            } else if (tmp[0] == 'r') {
-                if (!is_valid_reg(tmp, sub_err)) {
-                    sprintf(err, "(46): invalid register name \"%s\", %s", tmp, sub_err);
-                    return;
-                }
-
-            } else {
-                if (!is_valid_label(tmp, sub_err)) {
-                    sprintf(err, "(47): invalid label \"%s\", %s", tmp, sub_err);
-                    return;
-                }
+            if (!(desc->param_modes & MODE_BIT(get_token_mode(tmp)))) {
+                sprintf(err, "(70): operand \"%s\" has an addressing mode not allowed for opcode %d", tmp, opcode);
+                return;
+            }
+            if (!is_valid_operand(tmp, err, 45, 46, 47)) {
+                return;
             }
             /*make sure we have ) token*/
             curr = curr->prev;
@@ -579,4 +541,3 @@ void validate_tokens(List *tokens, char *err) {
         }
     }
 }
-
@@ -16,8 +16,13 @@
 #include "hashtable.h"
 #include "list.h"
 #include "parse.h"
+#include "isa.h"
+#include "stream.h"
+#include "stats.h"
 
 #define ERR_SIZE 500 /*size of the string containing the error message*/
+#define TOKENS_ARENA_SIZE 4096 /*size of the scratch memory the tokens of a line are allocated from*/
+#define VALIDATE_LINE_SIZE (LINE_SIZE + 10) /*lines are read a little longer than allowed to catch long ones*/
 
 /**
  * Checks that all tokens in given list constitute a valid assembly line.
@@ -30,13 +35,24 @@
  */
 void validate_tokens(List *tokens, char *err);
 
+/**
+ * Checks that a line of *!marco expanded!* code has valid syntax.
+ * If there is a syntax error, print error description.
+ *
+ * @param line the line, read with a buffer of VALIDATE_LINE_SIZE
+ * @param line_num a reference to the number of the line in the errors, advanced if the line is counted
+ * @param scratch an arena for the tokens of the line, it's reset before returning
+ * @return 1 if the line is valid, 0 otherwise
+ */
+int validate_line(char *line, unsigned int *line_num, Arena *scratch);
+
 /**
  * Checks that *!marco expanded!* code file has valid syntax.
  * If there is a syntax error, print error description and set is_valid flag to 0.
  *
- * @param code_file_path path to the .am *!marco expanded!* code file
+ * @param lines the *!marco expanded!* code as a line stream, read from the start
  * @param is_valid a byte reference to put the is_valid flag in
  */
-void validate_code(const char *code_file_path, byte *is_valid);
+void validate_code(LineStream *lines, byte *is_valid);
 
 #endif /* VALIDATE_H_ */
@@ -0,0 +1,268 @@
+/*
+ * workload.c
+ *
+ *  Created on: Oct 19, 2026
+ */
+#include "workload.h"
+
+/**
+ * Generator struct
+ *
+ * Holds the state of writing one source
+ */
+typedef struct {
+    const GenConfig *cfg;
+    unsigned long state; /*xorshift state, never 0*/
+    FILE *out;
+} Generator;
+
+/**
+ * Draws the next random number, a 32 bit xorshift so the sources are the same on every platform
+ *
+ * @param g the generator
+ * @return a random number below 2^32
+ */
+unsigned long gen_rand(Generator *g) {
+    unsigned long x;
+    x = g->state;
+    x ^= (x << 13) & 0xFFFFFFFFUL;
+    x ^= x >> 17;
+    x ^= (x << 5) & 0xFFFFFFFFUL;
+    g->state = x;
+    return x;
+}
+
+/**
+ * Draws a random number in a range
+ *
+ * @param g the generator
+ * @param n the end of the range
+ * @return a random number below n, 0 if n is 0
+ */
+unsigned long gen_below(Generator *g, unsigned long n) {
+    return n == 0 ? 0 : gen_rand(g) % n;
+}
+
+/**
+ * Picks a random addressing mode out of a legal modes mask, label operands only if there are labels to use
+ *
+ * @param g the generator
+ * @param mask mask of MODE_BIT values
+ * @return the addressing mode, -1 if none of the modes can be used
+ */
+int gen_mode(Generator *g, byte mask) {
+    int modes[4], n, mode;
+    n = 0;
+    for (mode = MODE_IMM; mode <= MODE_REG; mode++) {
+        if (mode == MODE_JMP || !(mask & MODE_BIT(mode))) {/*jumps with parameters are picked on their own*/
+            continue;
+        }
+        if (mode == MODE_DIR && g->cfg->labels == 0 && g->cfg->externs == 0) {
+            continue;
+        }
+        modes[n++] = mode;
+    }
+    return n == 0 ? -1 : modes[gen_below(g, n)];
+}
+
+/**
+ * Writes the name of a random label, external at the configured rate
+ *
+ * @param g the generator
+ * @param buf the buffer to write to
+ */
+void gen_label(Generator *g, char *buf) {
+    if (g->cfg->externs > 0 && (g->cfg->labels == 0 || gen_below(g, 100) < g->cfg->extern_pct)) {
+        sprintf(buf, "X%lu", gen_below(g, g->cfg->externs));
+    } else {
+        sprintf(buf, "L%lu", gen_below(g, g->cfg->labels));
+    }
+}
+
+/**
+ * Writes a random operand
+ *
+ * @param g the generator
+ * @param buf the buffer to write to
+ * @param mode the addressing mode of the operand
+ */
+void gen_operand(Generator *g, char *buf, int mode) {
+    switch (mode) {
+        case MODE_IMM:
+            sprintf(buf, "#%ld", (long) gen_below(g, 2 * GEN_MAX_VALUE + 1) - GEN_MAX_VALUE);
+            break;
+        case MODE_REG:
+            sprintf(buf, "r%lu", gen_below(g, 8));
+            break;
+        default:
+            gen_label(g, buf);
+    }
+}
+
+/**
+ * Writes a random instruction with legal addressing modes, without a line end
+ *
+ * @param g the generator
+ */
+void gen_instruction(Generator *g) {
+    char operands[3][MAX_TOKEN_LEN];
+    const OpcodeDesc *desc;
+    int src, dst, param1, param2;
+
+    desc = &isa[gen_below(g, NUM_OPCODES)];
+    switch (desc->optype) {
+        case OPTYPE_BIN:
+            src = gen_mode(g, desc->src_modes);
+            dst = gen_mode(g, desc->dst_modes);
+            if (src < 0 || dst < 0) {/*lea without labels to load*/
+                break;
+            }
+            gen_operand(g, operands[0], src);
+            gen_operand(g, operands[1], dst);
+            fprintf(g->out, "%s %s, %s", desc->name, operands[0], operands[1]);
+            return;
+        case OPTYPE_JMP:
+            if (gen_mode(g, MODE_BIT(MODE_DIR)) == MODE_DIR && gen_below(g, 2)) {
+                param1 = gen_mode(g, desc->param_modes);
+                param2 = gen_mode(g, desc->param_modes);
+                gen_label(g, operands[0]);
+                gen_operand(g, operands[1], param1);
+                gen_operand(g, operands[2], param2);
+                fprintf(g->out, "%s %s(%s,%s)", desc->name, operands[0], operands[1], operands[2]);
+                return;
+            }
+            /*a jump without parameters is written like a unary opcode*/
+            /*fall through*/
+        case OPTYPE_UNI:
+            dst = gen_mode(g, desc->dst_modes);
+            gen_operand(g, operands[0], dst);
+            fprintf(g->out, "%s %s", desc->name, operands[0]);
+            return;
+        case OPTYPE_INS:
+            fputs(desc->name, g->out);
+            return;
+    }
+    fputs("stop", g->out);
+}
+
+/**
+ * Writes a random .data or .string line, without a line end
+ *
+ * @param g the generator
+ * @param str if to write a .string line
+ */
+void gen_data(Generator *g, byte str) {
+    unsigned long i, n;
+    if (str) {
+        fputs(".string \"", g->out);
+        n = 1 + gen_below(g, GEN_MAX_STRING);
+        for (i = 0; i < n; i++) {
+            fputc('a' + (int) gen_below(g, 26), g->out);
+        }
+        fputc('"', g->out);
+        return;
+    }
+    fputs(".data ", g->out);
+    n = 1 + gen_below(g, GEN_MAX_DATA);
+    for (i = 0; i < n; i++) {
+        fprintf(g->out, i == 0 ? "%ld" : ",%ld", (long) gen_below(g, 2 * GEN_MAX_VALUE + 1) - GEN_MAX_VALUE);
+    }
+}
+
+void default_gen_config(GenConfig *cfg) {
+    cfg->lines = 100000;
+    cfg->labels = 10000;
+    cfg->macros = 100;
+    cfg->macro_lines = 4;
+    cfg->externs = 50;
+    cfg->entries = 100;
+    cfg->data_pct = 10;
+    cfg->string_pct = 5;
+    cfg->extern_pct = 10;
+    cfg->seed = 1;
+}
+
+int apply_preset(GenConfig *cfg, const char *name) {
+    default_gen_config(cfg);
+    if (strcmp(name, "mixed") == 0) {
+        return 1;
+    }
+    if (strcmp(name, "labels") == 0) {/*a label on every line, the labels table gets huge*/
+        cfg->lines = cfg->labels = 1000000;
+        cfg->entries = 1000;
+    } else if (strcmp(name, "macros") == 0) {/*most lines are macro calls*/
+        cfg->macros = 100000;
+        cfg->lines = 200000;
+        cfg->macro_lines = 3;
+    } else if (strcmp(name, "externs") == 0) {/*almost every label operand is external, the .ext file gets huge*/
+        cfg->externs = 1000;
+        cfg->extern_pct = 90;
+    } else {
+        return 0;
+    }
+    return 1;
+}
+
+int generate_source(const char *path, const GenConfig *cfg) {
+    Generator g;
+    unsigned long i, j, n, lines, labels_left, calls_left, label, call;
+
+    g.cfg = cfg;
+    g.state = (cfg->seed ^ 0x9E3779B9UL) & 0xFFFFFFFFUL;
+    if (g.state == 0) {
+        g.state = 1;
+    }
+    g.out = fopen(path, "w");
+    if (g.out == NULL) {
+        fprintf(stderr, "Error creating source file %s\n", path);
+        return 0;
+    }
+
+    for (i = 0; i < cfg->externs; i++) {
+        fprintf(g.out, ".extern X%lu\n", i);
+    }
+    for (i = 0; i < cfg->macros; i++) {/*macros must be defined before they are called*/
+        fprintf(g.out, "mcr m%lu\n", i);
+        n = 1 + gen_below(&g, cfg->macro_lines);
+        for (j = 0; j < n; j++) {/*no labels in macro bodies, a label would be defined by every call*/
+            fputs("    ", g.out);
+            gen_instruction(&g);
+            fputc('\n', g.out);
+        }
+        fputs("endmcr\n", g.out);
+    }
+
+    /*every label and macro call needs a line of it's own, the labels and calls are spread over the lines
+     * so that exactly the configured number of each is written*/
+    lines = cfg->lines < cfg->labels + cfg->macros ? cfg->labels + cfg->macros : cfg->lines;
+    labels_left = cfg->labels;
+    calls_left = cfg->macros;
+    label = call = 0;
+    for (i = 0; i < lines; i++) {
+        if (gen_below(&g, lines - i) < calls_left) {
+            fprintf(g.out, "m%lu\n", call++);
+            calls_left--;
+            continue;
+        }
+        if (gen_below(&g, lines - i - calls_left) < labels_left) {
+            fprintf(g.out, "L%lu: ", label++);
+            labels_left--;
+        }
+        n = gen_below(&g, 100);
+        if (n < cfg->data_pct) {
+            gen_data(&g, 0);
+        } else if (n < cfg->data_pct + cfg->string_pct) {
+            gen_data(&g, 1);
+        } else {
+            gen_instruction(&g);
+        }
+        fputc('\n', g.out);
+    }
+
+    n = cfg->entries < cfg->labels ? cfg->entries : cfg->labels;
+    for (i = 0; i < n; i++) {/*spread the entries over the labels*/
+        fprintf(g.out, ".entry L%lu\n", i * (cfg->labels / n));
+    }
+    fclose(g.out);
+    return 1;
+}
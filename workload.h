@@ -0,0 +1,68 @@
+/*
+ * workload.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  generates valid assembly sources of any size and mix of lines, to measure the assembler on.
+ *  the output only depends on the config, the same seed always gives the same source
+ */
+
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "util.h"
+#include "isa.h"
+
+#define GEN_MAX_DATA 8 /*most values on a generated .data line*/
+#define GEN_MAX_STRING 20 /*longest generated .string*/
+#define GEN_MAX_VALUE 2047 /*largest immediate or data value the assembler accepts*/
+
+/**
+ * GenConfig struct
+ *
+ * Holds the size and mix of a generated source
+ */
+typedef struct {
+    unsigned long lines; /*instruction, data and macro call lines, not counting declarations and macro bodies*/
+    unsigned long labels; /*labels defined, at most one per line*/
+    unsigned long macros; /*macros defined, each is called once*/
+    unsigned long macro_lines; /*most lines in a macro body*/
+    unsigned long externs; /*.extern declarations*/
+    unsigned long entries; /*.entry declarations, at most one per label*/
+    unsigned int data_pct; /*percent of lines that are .data*/
+    unsigned int string_pct; /*percent of lines that are .string*/
+    unsigned int extern_pct; /*percent of label operands that use an external label*/
+    unsigned long seed; /*seed of the random generator*/
+} GenConfig;
+
+/**
+ * Sets a config to a mixed source of 100000 lines
+ *
+ * @param cfg the config to set
+ */
+void default_gen_config(GenConfig *cfg);
+
+/**
+ * Sets a config to one of the named workloads. mixed is the default config, labels defines a label on each of
+ * 10^6 lines, macros defines and calls 10^5 macros and externs uses external labels for most label operands
+ *
+ * @param cfg the config to set
+ * @param name the name of the workload
+ * @return 1 on success, 0 if there is no workload with that name
+ */
+int apply_preset(GenConfig *cfg, const char *name);
+
+/**
+ * Writes a generated source
+ *
+ * @param path path to create the .as file in. overrites existing file at path
+ * @param cfg the size and mix of the source
+ * @return 1 if the file was written, 0 if it couldn't be opened
+ */
+int generate_source(const char *path, const GenConfig *cfg);
+
+#endif /* WORKLOAD_H */